@@ -0,0 +1,77 @@
+﻿//
+//  LegacyNetwork.h
+//  Benchmark
+//
+
+#pragma once
+
+#include <vector>
+#include <cstdlib>
+
+#include "Random.h"
+
+//Reference copy of the original per neuron network (every neuron owns its output connections)
+//Only kept so the benchmark can measure the dense layer engine against it.
+class LegacyNeuron;
+typedef std::vector<LegacyNeuron> LegacyLayer;
+
+struct LegacyConnection
+{
+    double Weight;
+    double DeltaWeight;
+
+    LegacyConnection(double w) { Weight = w; DeltaWeight = 0.0; }
+};
+
+class LegacyNeuron
+{
+public:
+    LegacyNeuron(const unsigned numOutputs, const unsigned idx);
+    ~LegacyNeuron() {}
+
+    void FeedForward(const LegacyLayer &prevLayer);
+
+    inline void SetOutputValue(const double value) { mOutputVal = value; }
+    inline double GetOutputValue() const { return mOutputVal; }
+    inline unsigned GetNumOutputWeights() const { return (unsigned)mOutputWeights.size(); }
+    inline void SetOutputWeight(unsigned idx, double weight) { mOutputWeights[idx] = LegacyConnection(weight); }
+
+    void CalculateOutputGradients(const double targetValue);
+    void CalculateHiddenGradients(const LegacyLayer &nextLayer);
+    void UpdateInputWeights(LegacyLayer &prevLayer);
+
+private:
+    static double TransferFunction(const double x);
+    static double TransferFunctionDerivative(const double x);
+    //Same draws as NetworkT::RandomWeight, both build the same network after Random::SetRunSeed
+    static double RandomWeight() { return Random::GetThreadRandom().NextDouble(); }
+
+    double SumDOW(const LegacyLayer &nextLayer) const;
+
+    unsigned mIdx;
+    double mGradient;
+    double mOutputVal;
+    std::vector<LegacyConnection> mOutputWeights;
+
+    //Overall network learning rate [0.0...1.0]
+    double mLearningRate = 0.15;
+    //Multiplier of last weight change [0.0...n]
+    double mMomentum = 0.5;
+};
+
+class LegacyNetwork
+{
+public:
+    LegacyNetwork(const std::vector<unsigned> &topology);
+    ~LegacyNetwork() {}
+
+    void FeedForward(const std::vector<double> &inputVals);
+    void BackPropagate(const std::vector<double> &targetVals);
+    void GetResults(std::vector<double> &resultVals) const;
+    //Same connection order as NetworkT::SetConnectionWeights: layer, source neuron (bias included), target neuron
+    void SetConnectionWeights(const std::vector<double> &w);
+
+private:
+    //mLayers[layer index][neuron index]
+    std::vector<LegacyLayer> mLayers;
+};
@@ -0,0 +1,148 @@
+
+#include "LegacyNetwork.h"
+
+#include <cmath>
+
+LegacyNeuron::LegacyNeuron(unsigned numOutputs, unsigned idx)
+{
+    mIdx = idx;
+
+    for (unsigned connection = 0; connection < numOutputs; connection++)
+        mOutputWeights.push_back(LegacyConnection(RandomWeight()));
+}
+
+void LegacyNeuron::FeedForward(const LegacyLayer &prevLayer)
+{
+    double sum = 0.0;
+
+    for (unsigned neuronIdx = 0; neuronIdx < prevLayer.size(); neuronIdx++)
+    {
+        sum += prevLayer[neuronIdx].GetOutputValue() *
+               prevLayer[neuronIdx].mOutputWeights[mIdx].Weight;
+    }
+
+    mOutputVal = LegacyNeuron::TransferFunction(sum);
+}
+
+void LegacyNeuron::CalculateOutputGradients(const double targetValue)
+{
+    double delta = targetValue - mOutputVal;
+    mGradient = delta * LegacyNeuron::TransferFunctionDerivative(mOutputVal);
+}
+
+void LegacyNeuron::CalculateHiddenGradients(const LegacyLayer &nextLayer)
+{
+    double dow = SumDOW(nextLayer);
+    mGradient = dow * LegacyNeuron::TransferFunctionDerivative(mOutputVal);
+}
+
+void LegacyNeuron::UpdateInputWeights(LegacyLayer &prevLayer)
+{
+    for (unsigned neuronIdx = 0; neuronIdx < prevLayer.size(); neuronIdx++)
+    {
+        LegacyNeuron &neuron = prevLayer[neuronIdx];
+        double oldDeltaWeight = neuron.mOutputWeights[mIdx].DeltaWeight;
+
+        double newDeltaWeight = mLearningRate * neuron.GetOutputValue() * mGradient +
+                                mMomentum * oldDeltaWeight;
+
+        neuron.mOutputWeights[mIdx].DeltaWeight = newDeltaWeight;
+        neuron.mOutputWeights[mIdx].Weight += newDeltaWeight;
+    }
+}
+
+double LegacyNeuron::TransferFunction(double x)
+{
+    return tanh(x);
+}
+
+double LegacyNeuron::TransferFunctionDerivative(double x)
+{
+    return 1.0 - x * x;
+}
+
+double LegacyNeuron::SumDOW(const LegacyLayer &nextLayer) const
+{
+    double sum = 0.0;
+
+    for (unsigned neuronIdx = 0; neuronIdx < nextLayer.size() - 1; neuronIdx++)
+        sum += mOutputWeights[neuronIdx].Weight * nextLayer[neuronIdx].mGradient;
+
+    return sum;
+}
+
+LegacyNetwork::LegacyNetwork(const std::vector<unsigned> &topology)
+{
+    unsigned numLayers = (unsigned)topology.size();
+    for (unsigned layerIdx = 0; layerIdx < numLayers; layerIdx++)
+    {
+        mLayers.push_back(LegacyLayer());
+
+        unsigned numOutputs = layerIdx == numLayers - 1 ? 0 : topology[layerIdx + 1];
+        for (unsigned neuronIdx = 0; neuronIdx <= topology[layerIdx]; neuronIdx++)
+            mLayers.back().push_back(LegacyNeuron(numOutputs, neuronIdx));
+
+        mLayers.back().back().SetOutputValue(-1.0);
+    }
+}
+
+void LegacyNetwork::SetConnectionWeights(const std::vector<double> &w)
+{
+    unsigned connectionIdx = 0;
+    for (unsigned layerIdx = 0; layerIdx + 1 < mLayers.size(); layerIdx++)
+    {
+        for (unsigned neuronIdx = 0; neuronIdx < mLayers[layerIdx].size(); neuronIdx++)
+        {
+            LegacyNeuron &neuron = mLayers[layerIdx][neuronIdx];
+            for (unsigned outputIdx = 0; outputIdx < neuron.GetNumOutputWeights(); outputIdx++)
+                neuron.SetOutputWeight(outputIdx, w[connectionIdx++]);
+        }
+    }
+}
+
+void LegacyNetwork::FeedForward(const std::vector<double>& inputVals)
+{
+    for (unsigned i = 0; i < inputVals.size(); i++)
+        mLayers[0][i].SetOutputValue(inputVals[i]);
+
+    for (unsigned layerIdx = 1; layerIdx < mLayers.size(); layerIdx++)
+    {
+        LegacyLayer &prevLayer = mLayers[layerIdx - 1];
+        for (unsigned neuronIdx = 0; neuronIdx < mLayers[layerIdx].size() - 1; neuronIdx++)
+            mLayers[layerIdx][neuronIdx].FeedForward(prevLayer);
+    }
+}
+
+void LegacyNetwork::BackPropagate(const std::vector<double>& targetVals)
+{
+    LegacyLayer &outputLayer = mLayers.back();
+
+    for (unsigned neuronIdx = 0; neuronIdx < outputLayer.size() - 1; neuronIdx++)
+        outputLayer[neuronIdx].CalculateOutputGradients(targetVals[neuronIdx]);
+
+    for (unsigned layerIdx = (unsigned)mLayers.size() - 2; layerIdx > 0; layerIdx--)
+    {
+        LegacyLayer &hiddenLayer = mLayers[layerIdx];
+        LegacyLayer &nextLayer = mLayers[layerIdx + 1];
+
+        for (unsigned neuronIdx = 0; neuronIdx < hiddenLayer.size(); neuronIdx++)
+            hiddenLayer[neuronIdx].CalculateHiddenGradients(nextLayer);
+    }
+
+    for (unsigned layerIdx = (unsigned)mLayers.size() - 1; layerIdx > 0; layerIdx--)
+    {
+        LegacyLayer &layer = mLayers[layerIdx];
+        LegacyLayer &prevLayer = mLayers[layerIdx - 1];
+
+        for (unsigned neuronIdx = 0; neuronIdx < layer.size() - 1; neuronIdx++)
+            layer[neuronIdx].UpdateInputWeights(prevLayer);
+    }
+}
+
+void LegacyNetwork::GetResults(std::vector<double>& resultVals) const
+{
+    resultVals.clear();
+
+    for (unsigned neuronIdx = 0; neuronIdx < mLayers.back().size() - 1; neuronIdx++)
+        resultVals.push_back(mLayers.back()[neuronIdx].GetOutputValue());
+}
@@ -0,0 +1,650 @@
+
+#include "Network.h"
+#include "FixedNetwork.h"
+#include "PopulationNetwork.h"
+#include "QuantizedNetwork.h"
+#include "Kernels.h"
+#include "Activation.h"
+#include "ParallelTrainer.h"
+#include "LegacyNetwork.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+template <typename T>
+struct SampleT
+{
+    typedef T Value;
+    std::vector<T> Inputs;
+    std::vector<T> Targets;
+};
+typedef SampleT<double> Sample;
+
+template <typename T>
+void ConvertSamples(const std::vector<Sample> &samples, std::vector<SampleT<T> > &converted)
+{
+    converted.resize(samples.size());
+    for (unsigned i = 0; i < samples.size(); i++)
+    {
+        converted[i].Inputs.assign(samples[i].Inputs.begin(), samples[i].Inputs.end());
+        converted[i].Targets.assign(samples[i].Targets.begin(), samples[i].Targets.end());
+    }
+}
+
+//Reads the "topology:/In:/Out:" training file used by the NN project
+bool LoadTrainingData(const std::string &filename, std::vector<unsigned> &topology, std::vector<Sample> &samples)
+{
+    std::ifstream file(filename.c_str());
+    if (!file.is_open())
+        return false;
+
+    std::string line, label;
+    while (std::getline(file, line))
+    {
+        std::stringstream ss(line);
+        ss >> label;
+
+        if (label.compare("topology:") == 0)
+        {
+            unsigned n;
+            while (ss >> n)
+                topology.push_back(n);
+        }
+        else if (label.compare("In:") == 0)
+        {
+            samples.push_back(Sample());
+            double value;
+            while (ss >> value)
+                samples.back().Inputs.push_back(value);
+        }
+        else if (label.compare("Out:") == 0 && !samples.empty())
+        {
+            double value;
+            while (ss >> value)
+                samples.back().Targets.push_back(value);
+        }
+    }
+
+    return !topology.empty() && !samples.empty();
+}
+
+void CreateRandomSamples(const std::vector<unsigned> &topology, unsigned amount, std::vector<Sample> &samples)
+{
+    Random &random = Random::GetThreadRandom();
+    for (unsigned i = 0; i < amount; i++)
+    {
+        samples.push_back(Sample());
+        for (unsigned j = 0; j < topology.front(); j++)
+            samples.back().Inputs.push_back((double)random.NextUnsigned(2));
+        for (unsigned j = 0; j < topology.back(); j++)
+            samples.back().Targets.push_back((double)random.NextUnsigned(2));
+    }
+}
+
+//Zero centred weights in connection order, [-1...1) / sqrt(fan-in). With 0/1 inputs the sums stay around [-1...1]
+//whatever the width, the [0...1) weights of a new network push every tanh of a wide layer to +-1 and the
+//comparisons between engines would only see the saturated outputs
+void CreateScaledWeights(const std::vector<unsigned> &topology, std::vector<double> &weights)
+{
+    Random random(1);
+    weights.clear();
+    for (unsigned layerIdx = 1; layerIdx < topology.size(); layerIdx++)
+    {
+        unsigned fanIn = topology[layerIdx - 1] + 1;
+        double scale = 1.0 / std::sqrt((double)fanIn);
+        for (unsigned i = 0; i < fanIn * topology[layerIdx]; i++)
+            weights.push_back((random.NextDouble() * 2.0 - 1.0) * scale);
+    }
+}
+
+//Trains the network over every sample 'passes' times and returns the nanoseconds per sample
+template <typename NetworkType, typename SampleType>
+double TimeTraining(NetworkType &network, const std::vector<SampleType> &samples, unsigned passes)
+{
+    std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+    for (unsigned pass = 0; pass < passes; pass++)
+    {
+        for (unsigned i = 0; i < samples.size(); i++)
+        {
+            network.FeedForward(samples[i].Inputs);
+            network.BackPropagate(samples[i].Targets);
+        }
+    }
+
+    std::chrono::high_resolution_clock::time_point end = std::chrono::high_resolution_clock::now();
+    double ns = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    return ns / ((double)passes * samples.size());
+}
+
+template <typename NetworkType, typename SampleType>
+double TimeFeedForward(NetworkType &network, const std::vector<SampleType> &samples, unsigned passes)
+{
+    std::vector<typename SampleType::Value> resultVals;
+    std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+    for (unsigned pass = 0; pass < passes; pass++)
+    {
+        for (unsigned i = 0; i < samples.size(); i++)
+        {
+            network.FeedForward(samples[i].Inputs);
+            network.GetResults(resultVals);
+        }
+    }
+
+    std::chrono::high_resolution_clock::time_point end = std::chrono::high_resolution_clock::now();
+    double ns = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    return ns / ((double)passes * samples.size());
+}
+
+//Trains with TrainBatch in batches of 'batchSize' samples and returns the nanoseconds per sample
+template <typename T>
+double TimeBatchTraining(NetworkT<T> &network, const std::vector<SampleT<T> > &samples, unsigned batchSize, unsigned passes)
+{
+    std::vector<std::vector<T> > batchInputs, batchTargets;
+    for (unsigned i = 0; i + batchSize <= samples.size(); i += batchSize)
+    {
+        batchInputs.push_back(std::vector<T>());
+        batchTargets.push_back(std::vector<T>());
+        for (unsigned j = i; j < i + batchSize; j++)
+        {
+            batchInputs.back().insert(batchInputs.back().end(), samples[j].Inputs.begin(), samples[j].Inputs.end());
+            batchTargets.back().insert(batchTargets.back().end(), samples[j].Targets.begin(), samples[j].Targets.end());
+        }
+    }
+
+    std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+    for (unsigned pass = 0; pass < passes; pass++)
+    {
+        for (unsigned i = 0; i < batchInputs.size(); i++)
+            network.TrainBatch(batchInputs[i], batchTargets[i], batchSize);
+    }
+
+    std::chrono::high_resolution_clock::time_point end = std::chrono::high_resolution_clock::now();
+    double ns = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    return ns / ((double)passes * batchInputs.size() * batchSize);
+}
+
+//Largest difference between the outputs of two networks built with the same weights, before and after one
+//training step on the first sample (the network may run in another precision, its samples are the converted
+//reference samples). One step runs every backward kernel, more steps would saturate the wide layers again or
+//grow the rounding differences into two different training runs
+template <typename NetworkType, typename SampleType, typename ReferenceType>
+double CompareResults(NetworkType &network, const std::vector<SampleType> &samples, ReferenceType &reference, const std::vector<Sample> &referenceSamples)
+{
+    std::vector<typename SampleType::Value> resultVals;
+    std::vector<double> referenceVals;
+    double maxDifference = 0.0;
+
+    for (unsigned step = 0; step < 2; step++)
+    {
+        for (unsigned i = 0; i < samples.size(); i++)
+        {
+            network.FeedForward(samples[i].Inputs);
+            network.GetResults(resultVals);
+            reference.FeedForward(referenceSamples[i].Inputs);
+            reference.GetResults(referenceVals);
+
+            for (unsigned j = 0; j < resultVals.size(); j++)
+                maxDifference = std::fmax(maxDifference, std::fabs((double)resultVals[j] - referenceVals[j]));
+        }
+
+        if (step == 0)
+        {
+            network.FeedForward(samples[0].Inputs);
+            network.BackPropagate(samples[0].Targets);
+            reference.FeedForward(referenceSamples[0].Inputs);
+            reference.BackPropagate(referenceSamples[0].Targets);
+        }
+    }
+
+    return maxDifference;
+}
+
+void RunBenchmark(const std::string &name, const std::vector<unsigned> &topology, const std::vector<Sample> &samples)
+{
+    unsigned numWeights = 0;
+    for (unsigned i = 1; i < topology.size(); i++)
+        numWeights += (topology[i - 1] + 1) * topology[i];
+
+    //Aim for roughly the same amount of work on every topology
+    unsigned passes = (unsigned)(50000000.0 / ((double)numWeights * samples.size())) + 1;
+
+    //Every engine starts from the same non saturating weights
+    std::vector<double> weights;
+    CreateScaledWeights(topology, weights);
+
+    Random::SetRunSeed(1);
+    LegacyNetwork legacy(topology);
+    legacy.SetConnectionWeights(weights);
+    double legacyTrain = TimeTraining(legacy, samples, passes);
+    double legacyForward = TimeFeedForward(legacy, samples, passes);
+
+    printf("%-22s %9u %-8s %12.1f %8s %12.1f %8s %10s\n", name.c_str(), numWeights, "legacy",
+           legacyTrain, "", legacyForward, "", "");
+
+    //The dense engine with every instruction set the cpu supports
+    for (int set = Kernels::Scalar; set <= Kernels::GetSupportedInstructionSet(); set++)
+    {
+        Kernels::SetInstructionSet((Kernels::InstructionSet)set);
+
+        Random::SetRunSeed(1);
+        Network network(topology);
+        network.SetConnectionWeights(weights);
+        Random::SetRunSeed(1);
+        LegacyNetwork reference(topology);
+        reference.SetConnectionWeights(weights);
+
+        double difference = CompareResults(network, samples, reference, samples);
+
+        double denseTrain = TimeTraining(network, samples, passes);
+        double denseForward = TimeFeedForward(network, samples, passes);
+
+        printf("%-22s %9s %-8s %12.1f %7.2fx %12.1f %7.2fx %10.2e\n", "", "",
+               Kernels::GetInstructionSetName((Kernels::InstructionSet)set),
+               denseTrain, legacyTrain / denseTrain, denseForward, legacyForward / denseForward, difference);
+    }
+
+    Kernels::SetInstructionSet(Kernels::GetSupportedInstructionSet());
+
+    //Single precision with the best instruction set, the difference is against the double precision engine
+    std::vector<SampleT<float> > floatSamples;
+    ConvertSamples(samples, floatSamples);
+    {
+        Random::SetRunSeed(1);
+        FloatNetwork network(topology);
+        network.SetConnectionWeights(weights);
+        Random::SetRunSeed(1);
+        Network reference(topology);
+        reference.SetConnectionWeights(weights);
+
+        double difference = CompareResults(network, floatSamples, reference, samples);
+
+        double floatTrain = TimeTraining(network, floatSamples, passes);
+        double floatForward = TimeFeedForward(network, floatSamples, passes);
+
+        printf("%-22s %9s %-8s %12.1f %7.2fx %12.1f %7.2fx %10.2e\n", "", "", "float",
+               floatTrain, legacyTrain / floatTrain, floatForward, legacyForward / floatForward, difference);
+    }
+
+    //Mini-batch training (matrix-matrix products) with the best instruction set
+    const unsigned batchSizes[] = { 8, 32 };
+    for (unsigned i = 0; i < sizeof(batchSizes) / sizeof(batchSizes[0]); i++)
+    {
+        if (batchSizes[i] > samples.size())
+            continue;
+
+        Random::SetRunSeed(1);
+        Network network(topology);
+        double batchTrain = TimeBatchTraining(network, samples, batchSizes[i], passes);
+
+        std::string engine = "batch " + std::to_string(batchSizes[i]);
+        printf("%-22s %9s %-8s %12.1f %7.2fx\n", "", "", engine.c_str(), batchTrain, legacyTrain / batchTrain);
+
+        Random::SetRunSeed(1);
+        FloatNetwork floatNetwork(topology);
+        double floatBatchTrain = TimeBatchTraining(floatNetwork, floatSamples, batchSizes[i], passes);
+
+        engine = "f32 b" + std::to_string(batchSizes[i]);
+        printf("%-22s %9s %-8s %12.1f %7.2fx\n", "", "", engine.c_str(), floatBatchTrain, legacyTrain / floatBatchTrain);
+    }
+}
+
+//Written by the timing loops whose results are not used otherwise, so they are not optimized away
+volatile double gSink = 0.0;
+
+//Evaluations per second of a tiny network with a runtime topology against the same one fixed at compile time
+template <unsigned... Sizes>
+void RunFixedBenchmark()
+{
+    typedef FixedNetwork<Sizes...> FixedType;
+    std::vector<unsigned> topology = FixedType::GetTopology();
+
+    //Both draw the same random weights
+    Random::SetRunSeed(1);
+    Network network(topology);
+    Random::SetRunSeed(1);
+    FixedType fixed;
+
+    std::vector<Sample> samples;
+    CreateRandomSamples(topology, 64, samples);
+    const unsigned passes = 20000;
+
+    std::vector<double> resultVals;
+    std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+    for (unsigned pass = 0; pass < passes; pass++)
+    {
+        for (unsigned i = 0; i < samples.size(); i++)
+        {
+            network.FeedForward(samples[i].Inputs);
+            network.GetResults(resultVals);
+        }
+    }
+    std::chrono::high_resolution_clock::time_point end = std::chrono::high_resolution_clock::now();
+    double dynamicSeconds = std::chrono::duration<double>(end - start).count();
+
+    double checksum = 0.0;
+    double fixedResults[FixedType::NumOutputs];
+    start = std::chrono::high_resolution_clock::now();
+    for (unsigned pass = 0; pass < passes; pass++)
+    {
+        for (unsigned i = 0; i < samples.size(); i++)
+        {
+            fixed.FeedForward(samples[i].Inputs.data(), fixedResults);
+            checksum += fixedResults[0];
+        }
+    }
+    end = std::chrono::high_resolution_clock::now();
+    double fixedSeconds = std::chrono::duration<double>(end - start).count();
+    gSink = checksum;
+
+    double maxDifference = 0.0;
+    for (unsigned i = 0; i < samples.size(); i++)
+    {
+        network.FeedForward(samples[i].Inputs);
+        network.GetResults(resultVals);
+        fixed.FeedForward(samples[i].Inputs.data(), fixedResults);
+        for (unsigned j = 0; j < FixedType::NumOutputs; j++)
+            maxDifference = std::fmax(maxDifference, std::fabs(resultVals[j] - fixedResults[j]));
+    }
+
+    std::string name;
+    for (unsigned i = 0; i < topology.size(); i++)
+        name += (i > 0 ? " " : "") + std::to_string(topology[i]);
+
+    double evaluations = (double)passes * samples.size();
+    printf("%-22s %-8s %14.0f\n", name.c_str(), "dynamic", evaluations / dynamicSeconds);
+    printf("%-22s %-8s %14.0f %7.2fx %10.2e\n", "", "fixed", evaluations / fixedSeconds,
+           dynamicSeconds / fixedSeconds, maxDifference);
+}
+
+//Evaluations per second of a whole population: one fixed network per genome against the population network
+template <unsigned... Sizes>
+void RunPopulationBenchmark(Activation::Type activation)
+{
+    typedef FixedNetwork<Sizes...> FixedType;
+    std::vector<unsigned> topology = FixedType::GetTopology();
+
+    const unsigned numGenomes = 1024;
+    Random::SetRunSeed(1);
+    std::vector<FixedType> genomes;
+    PopulationNetwork population(topology, numGenomes, activation);
+
+    std::vector<double> w;
+    for (unsigned genome = 0; genome < numGenomes; genome++)
+    {
+        genomes.push_back(FixedType(activation));
+        genomes[genome].GetConnectionWeights(w);
+        population.SetGenomeWeights(genome, w);
+    }
+
+    std::vector<Sample> samples;
+    CreateRandomSamples(topology, 4, samples);
+    const unsigned passes = 500;
+
+    double checksum = 0.0;
+    double fixedResults[FixedType::NumOutputs];
+    std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+    for (unsigned pass = 0; pass < passes; pass++)
+    {
+        for (unsigned i = 0; i < samples.size(); i++)
+        {
+            for (unsigned genome = 0; genome < numGenomes; genome++)
+            {
+                genomes[genome].FeedForward(samples[i].Inputs.data(), fixedResults);
+                checksum += fixedResults[0];
+            }
+        }
+    }
+    std::chrono::high_resolution_clock::time_point end = std::chrono::high_resolution_clock::now();
+    double fixedSeconds = std::chrono::duration<double>(end - start).count();
+
+    start = std::chrono::high_resolution_clock::now();
+    for (unsigned pass = 0; pass < passes; pass++)
+    {
+        for (unsigned i = 0; i < samples.size(); i++)
+        {
+            population.SetInputs(samples[i].Inputs.data());
+            population.FeedForward();
+            checksum += population.GetResults(0)[0];
+        }
+    }
+    end = std::chrono::high_resolution_clock::now();
+    double populationSeconds = std::chrono::duration<double>(end - start).count();
+    gSink = checksum;
+
+    double maxDifference = 0.0;
+    double populationResults[FixedType::NumOutputs];
+    for (unsigned i = 0; i < samples.size(); i++)
+    {
+        population.SetInputs(samples[i].Inputs.data());
+        population.FeedForward();
+        for (unsigned genome = 0; genome < numGenomes; genome++)
+        {
+            genomes[genome].FeedForward(samples[i].Inputs.data(), fixedResults);
+            population.GetGenomeResults(genome, populationResults);
+            for (unsigned j = 0; j < FixedType::NumOutputs; j++)
+                maxDifference = std::fmax(maxDifference, std::fabs(populationResults[j] - fixedResults[j]));
+        }
+    }
+
+    std::string name;
+    for (unsigned i = 0; i < topology.size(); i++)
+        name += (i > 0 ? " " : "") + std::to_string(topology[i]);
+    name += std::string(" ") + Activation::GetName(activation);
+
+    double evaluations = (double)passes * samples.size() * numGenomes;
+    printf("%-22s %-10s %14.0f\n", name.c_str(), "fixed", evaluations / fixedSeconds);
+    printf("%-22s %-10s %14.0f %7.2fx %10.2e\n", "", "population", evaluations / populationSeconds,
+           fixedSeconds / populationSeconds, maxDifference);
+}
+
+//Nanoseconds per value of the array version of an activation and its largest error against the exact function
+template <typename T>
+void RunActivationBenchmark(Activation::Type type, const char *precision)
+{
+    const unsigned count = 4096;
+    const unsigned passes = 2000;
+
+    std::vector<T> inputs(count), values(count);
+    Random::GetThreadRandom().FillUniform(inputs.data(), count, (T)-6.0, (T)6.0);
+
+    double seconds = 0.0;
+    for (unsigned pass = 0; pass < passes; pass++)
+    {
+        values = inputs;
+        std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+        Activation::Apply(type, values.data(), count);
+        std::chrono::high_resolution_clock::time_point end = std::chrono::high_resolution_clock::now();
+        seconds += std::chrono::duration<double>(end - start).count();
+    }
+
+    //The approximations are measured against tanh, the others against their own definition
+    double maxError = 0.0;
+    for (unsigned i = 0; i < count; i++)
+    {
+        double x = (double)inputs[i];
+        double exact;
+        if (type == Activation::Sigmoid)
+            exact = 1.0 / (1.0 + std::exp(-x));
+        else if (type == Activation::ReLU)
+            exact = x > 0.0 ? x : 0.0;
+        else
+            exact = std::tanh(x);
+
+        maxError = std::fmax(maxError, std::fabs((double)values[i] - exact));
+    }
+
+    printf("%-22s %-8s %14.3f %10.2e\n", Activation::GetName(type), precision, seconds * 1e9 / ((double)passes * count), maxError);
+}
+
+//Samples per second of a data parallel epoch, from 1 thread up to every hardware thread
+void RunParallelBenchmark(ParallelTrainer::Mode mode)
+{
+    const unsigned sizes[] = { 16, 64, 64, 8 };
+    std::vector<unsigned> topology(sizes, sizes + 4);
+
+    std::vector<Sample> samples;
+    CreateRandomSamples(topology, 32768, samples);
+
+    std::vector<double> inputs, targets;
+    for (unsigned i = 0; i < samples.size(); i++)
+    {
+        inputs.insert(inputs.end(), samples[i].Inputs.begin(), samples[i].Inputs.end());
+        targets.insert(targets.end(), samples[i].Targets.begin(), samples[i].Targets.end());
+    }
+
+    const unsigned batchSize = 32;
+    unsigned maxThreads = ParallelTrainer::GetHardwareThreads();
+    std::vector<unsigned> threadCounts;
+    for (unsigned numThreads = 1; numThreads < maxThreads; numThreads *= 2)
+        threadCounts.push_back(numThreads);
+    threadCounts.push_back(maxThreads);
+
+    double baseRate = 0.0;
+    for (unsigned i = 0; i < threadCounts.size(); i++)
+    {
+        Random::SetRunSeed(1);
+        Network network(topology);
+        ParallelTrainer trainer(network, threadCounts[i], mode);
+
+        std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+        trainer.TrainEpoch(inputs, targets, batchSize);
+        std::chrono::high_resolution_clock::time_point end = std::chrono::high_resolution_clock::now();
+
+        double rate = samples.size() / std::chrono::duration<double>(end - start).count();
+        if (i == 0)
+            baseRate = rate;
+
+        printf("%-22s %-12s %8u %14.0f %7.2fx %10.4f\n", i == 0 ? "16 64 64 8" : "", ParallelTrainer::GetModeName(mode),
+               threadCounts[i], rate, rate / baseRate, trainer.GetEpochError());
+    }
+}
+
+//Nanoseconds per forward pass of the double, float and int8 versions of the same network
+template <typename NetworkType, typename T>
+double TimeForwardPasses(NetworkType &network, const std::vector<T> &inputs, unsigned numInputs, unsigned passes)
+{
+    unsigned numSamples = (unsigned)(inputs.size() / numInputs);
+    std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+    for (unsigned pass = 0; pass < passes; pass++)
+    {
+        for (unsigned i = 0; i < numSamples; i++)
+            network.FeedForward(&inputs[i * numInputs]);
+    }
+
+    std::chrono::high_resolution_clock::time_point end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / ((double)passes * numSamples);
+}
+
+void RunQuantizedBenchmark(const std::vector<unsigned> &topology, unsigned passes)
+{
+    //Non saturating weights, the int8 outputs are compared where tanh does not hide the error
+    std::vector<double> weights;
+    CreateScaledWeights(topology, weights);
+    Random::SetRunSeed(1);
+    Network network(topology);
+    network.SetConnectionWeights(weights);
+    FloatNetwork floatNetwork(network);
+    QuantizedNetwork quantizedNetwork(network);
+
+    std::vector<Sample> samples;
+    CreateRandomSamples(topology, 64, samples);
+    std::vector<double> inputs;
+    for (unsigned i = 0; i < samples.size(); i++)
+        inputs.insert(inputs.end(), samples[i].Inputs.begin(), samples[i].Inputs.end());
+    std::vector<float> floatInputs(inputs.begin(), inputs.end());
+
+    unsigned numInputs = topology.front();
+    double doubleTime = TimeForwardPasses(network, inputs, numInputs, passes);
+    double floatTime = TimeForwardPasses(floatNetwork, floatInputs, numInputs, passes);
+    double quantizedTime = TimeForwardPasses(quantizedNetwork, floatInputs, numInputs, passes);
+    QuantizationError error = quantizedNetwork.MeasureError(network, inputs.data(), (unsigned)samples.size());
+
+    size_t numWeights = 0;
+    for (unsigned i = 1; i < topology.size(); i++)
+        numWeights += topology[i] * (topology[i - 1] + 1);
+
+    std::string name;
+    for (unsigned i = 0; i < topology.size(); i++)
+        name += (i > 0 ? " " : "") + std::to_string(topology[i]);
+
+    printf("%-22s %-8s %12.1f %8.2fx %12u %10s %10s\n", name.c_str(), "double", doubleTime, 1.0, (unsigned)(numWeights * sizeof(double)), "", "");
+    printf("%-22s %-8s %12.1f %8.2fx %12u %10s %10s\n", "", "float", floatTime, doubleTime / floatTime, (unsigned)(numWeights * sizeof(float)), "", "");
+    printf("%-22s %-8s %12.1f %8.2fx %12u %10.2e %10.2e\n", "", "int8", quantizedTime, doubleTime / quantizedTime,
+           (unsigned)quantizedNetwork.GetWeightsSize(), error.MaxError, error.MeanError);
+}
+
+int main(int argc, char *argv[])
+{
+    std::string dataFile = argc > 1 ? argv[1] : "../../NN/data/trainingData.txt";
+
+    printf("%-22s %9s %-8s %12s %8s %12s %8s %10s\n", "topology", "weights", "engine",
+           "train ns", "speedup", "forward ns", "speedup", "max diff");
+
+    std::vector<unsigned> topology;
+    std::vector<Sample> samples;
+    if (LoadTrainingData(dataFile, topology, samples))
+    {
+        std::string name;
+        for (unsigned i = 0; i < topology.size(); i++)
+            name += (i > 0 ? " " : "") + std::to_string(topology[i]);
+        RunBenchmark(name + " (data)", topology, samples);
+    }
+    else
+        printf("Could not read %s, skipping the training data topology\n", dataFile.c_str());
+
+    const unsigned wideTopologies[][4] =
+    {
+        { 16, 64, 64, 8 },
+        { 64, 256, 256, 16 },
+        { 256, 1024, 1024, 64 },
+    };
+
+    for (unsigned i = 0; i < sizeof(wideTopologies) / sizeof(wideTopologies[0]); i++)
+    {
+        std::vector<unsigned> wideTopology(wideTopologies[i], wideTopologies[i] + 4);
+        std::vector<Sample> wideSamples;
+        CreateRandomSamples(wideTopology, 32, wideSamples);
+
+        std::string name;
+        for (unsigned j = 0; j < wideTopology.size(); j++)
+            name += (j > 0 ? " " : "") + std::to_string(wideTopology[j]);
+        RunBenchmark(name, wideTopology, wideSamples);
+    }
+
+    printf("\n%-22s %-8s %14s %8s %10s\n", "topology", "engine", "evals/s", "speedup", "max diff");
+    RunFixedBenchmark<2, 2, 1>();
+    RunFixedBenchmark<4, 4, 3>();
+    RunFixedBenchmark<16, 16, 4>();
+
+    printf("\n%-22s %-10s %14s %8s %10s\n", "population of 1024", "engine", "evals/s", "speedup", "max diff");
+    RunPopulationBenchmark<2, 2, 1>(Activation::Tanh);
+    RunPopulationBenchmark<2, 2, 1>(Activation::RationalTanh);
+    RunPopulationBenchmark<4, 4, 3>(Activation::Tanh);
+    RunPopulationBenchmark<4, 4, 3>(Activation::RationalTanh);
+
+    printf("\n%-22s %-8s %14s %10s\n", "activation", "type", "ns per value", "max error");
+    for (int type = Activation::Tanh; type < Activation::Count; type++)
+    {
+        RunActivationBenchmark<double>((Activation::Type)type, "double");
+        RunActivationBenchmark<float>((Activation::Type)type, "float");
+    }
+
+    printf("\n%-22s %-8s %12s %9s %12s %10s %10s\n", "topology", "weights", "forward ns", "speedup", "bytes", "max diff", "mean diff");
+    RunQuantizedBenchmark(std::vector<unsigned>(wideTopologies[0], wideTopologies[0] + 4), 2000);
+    RunQuantizedBenchmark(std::vector<unsigned>(wideTopologies[1], wideTopologies[1] + 4), 200);
+    RunQuantizedBenchmark(std::vector<unsigned>(wideTopologies[2], wideTopologies[2] + 4), 10);
+
+    printf("\n%-22s %-12s %8s %14s %8s %10s\n", "topology", "mode", "threads", "samples/s", "speedup", "error");
+    RunParallelBenchmark(ParallelTrainer::Synchronous);
+    RunParallelBenchmark(ParallelTrainer::Hogwild);
+
+    return 0;
+}
@@ -0,0 +1,47 @@
+﻿//
+//  BenchmarkResults.h
+//  BenchmarkSuite
+//
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+//Timing of one operation of the suite, e.g. "network/feedforward/double/2-2-1"
+struct BenchmarkResult
+{
+    std::string Name;
+    unsigned long long Iterations;
+    double NsPerOp;
+    double OpsPerSecond;
+    //Work done per second, in the unit of ItemName (connections, genes, genomes...)
+    double ItemsPerSecond;
+    std::string ItemName;
+    //Heap allocations per operation, -1 when the build does not count them (see AllocationCounter.h)
+    double AllocationsPerOp;
+};
+
+//One line per result comparing a run against a baseline
+struct BenchmarkComparison
+{
+    std::string Name;
+    double BaselineNsPerOp;
+    double NsPerOp;
+    //Relative change of the time, 0.1 is 10% slower
+    double Change;
+    bool Regression;
+};
+
+namespace BenchmarkResults
+{
+    //JSON file with the machine (instruction set) and one object per result, one result per line
+    bool Write(const std::string &filename, const std::string &instructionSet, const std::vector<BenchmarkResult> &results);
+    //Reads back the results of a file written by Write
+    bool Read(const std::string &filename, std::vector<BenchmarkResult> &results);
+
+    //A result is a regression when it takes more than threshold (0.1 = 10%) longer than the baseline or it allocates more.
+    //Results missing from the baseline are not compared. Returns the amount of regressions
+    unsigned Compare(const std::vector<BenchmarkResult> &baseline, const std::vector<BenchmarkResult> &results, double threshold,
+                     std::vector<BenchmarkComparison> &comparisons);
+}
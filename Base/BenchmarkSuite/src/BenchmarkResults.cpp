@@ -0,0 +1,122 @@
+
+#include "BenchmarkResults.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+//Value of "key": in the line, the text between quotes or the number
+static bool FindValue(const std::string &line, const char *key, std::string &value)
+{
+    std::string pattern = std::string("\"") + key + "\":";
+    size_t position = line.find(pattern);
+    if (position == std::string::npos)
+        return false;
+
+    position += pattern.size();
+    while (position < line.size() && line[position] == ' ')
+        position++;
+
+    if (position < line.size() && line[position] == '"')
+    {
+        size_t end = line.find('"', position + 1);
+        if (end == std::string::npos)
+            return false;
+
+        value = line.substr(position + 1, end - position - 1);
+        return true;
+    }
+
+    size_t end = line.find_first_of(",}", position);
+    value = line.substr(position, end == std::string::npos ? std::string::npos : end - position);
+    return !value.empty();
+}
+
+namespace BenchmarkResults
+{
+    bool Write(const std::string &filename, const std::string &instructionSet, const std::vector<BenchmarkResult> &results)
+    {
+        FILE *file = fopen(filename.c_str(), "w");
+        if (!file)
+            return false;
+
+        fprintf(file, "{\n  \"version\": 1,\n  \"instruction_set\": \"%s\",\n  \"results\": [\n", instructionSet.c_str());
+        for (size_t i = 0; i < results.size(); i++)
+        {
+            const BenchmarkResult &result = results[i];
+            fprintf(file, "    { \"name\": \"%s\", \"iterations\": %llu, \"ns_per_op\": %.3f, \"ops_per_sec\": %.3f, "
+                    "\"items_per_sec\": %.3f, \"item\": \"%s\", \"allocs_per_op\": %.3f }%s\n",
+                    result.Name.c_str(), result.Iterations, result.NsPerOp, result.OpsPerSecond,
+                    result.ItemsPerSecond, result.ItemName.c_str(), result.AllocationsPerOp, i + 1 < results.size() ? "," : "");
+        }
+        fprintf(file, "  ]\n}\n");
+
+        bool good = ferror(file) == 0;
+        return fclose(file) == 0 && good;
+    }
+
+    bool Read(const std::string &filename, std::vector<BenchmarkResult> &results)
+    {
+        std::ifstream file(filename.c_str());
+        if (!file.is_open())
+            return false;
+
+        results.clear();
+        std::string line, value;
+        while (std::getline(file, line))
+        {
+            //Write puts every result in its own line
+            BenchmarkResult result;
+            if (!FindValue(line, "name", result.Name))
+                continue;
+
+            result.Iterations = FindValue(line, "iterations", value) ? strtoull(value.c_str(), nullptr, 10) : 0;
+            result.NsPerOp = FindValue(line, "ns_per_op", value) ? atof(value.c_str()) : 0.0;
+            result.OpsPerSecond = FindValue(line, "ops_per_sec", value) ? atof(value.c_str()) : 0.0;
+            result.ItemsPerSecond = FindValue(line, "items_per_sec", value) ? atof(value.c_str()) : 0.0;
+            if (!FindValue(line, "item", result.ItemName))
+                result.ItemName.clear();
+            result.AllocationsPerOp = FindValue(line, "allocs_per_op", value) ? atof(value.c_str()) : -1.0;
+            results.push_back(result);
+        }
+
+        return !results.empty();
+    }
+
+    unsigned Compare(const std::vector<BenchmarkResult> &baseline, const std::vector<BenchmarkResult> &results, double threshold,
+                     std::vector<BenchmarkComparison> &comparisons)
+    {
+        unsigned regressions = 0;
+        comparisons.clear();
+
+        for (size_t i = 0; i < results.size(); i++)
+        {
+            const BenchmarkResult *reference = nullptr;
+            for (size_t j = 0; j < baseline.size() && !reference; j++)
+            {
+                if (baseline[j].Name == results[i].Name)
+                    reference = &baseline[j];
+            }
+
+            if (!reference || reference->NsPerOp <= 0.0)
+                continue;
+
+            BenchmarkComparison comparison;
+            comparison.Name = results[i].Name;
+            comparison.BaselineNsPerOp = reference->NsPerOp;
+            comparison.NsPerOp = results[i].NsPerOp;
+            comparison.Change = results[i].NsPerOp / reference->NsPerOp - 1.0;
+
+            //Allocations do not depend on the machine, any extra one is a regression
+            bool moreAllocations = reference->AllocationsPerOp >= 0.0 && results[i].AllocationsPerOp >= 0.0 &&
+                                   results[i].AllocationsPerOp > reference->AllocationsPerOp + 0.01;
+            comparison.Regression = comparison.Change > threshold || moreAllocations;
+            if (comparison.Regression)
+                regressions++;
+
+            comparisons.push_back(comparison);
+        }
+
+        return regressions;
+    }
+}
@@ -0,0 +1,217 @@
+#include "Network.h"
+#include "Kernels.h"
+#include "AllocationCounter.h"
+#include "GeneticAlgorithm.h"
+#include "BenchmarkResults.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+//Every measurement runs at least this long
+double gMinTime = 0.2;
+
+//Times operation in a loop, growing the iterations until the loop takes gMinTime.
+//itemsPerOp is the work done by one call, in itemName units (e.g. the connections of a forward pass)
+template <typename Operation>
+BenchmarkResult Measure(const std::string &name, double itemsPerOp, const char *itemName, Operation operation)
+{
+    //Warm up: the first call grows the buffers and loads the caches
+    operation();
+
+    unsigned long long iterations = 1;
+    double seconds = 0.0;
+    unsigned long long allocations = 0;
+    while (true)
+    {
+        unsigned long long allocationsStart = AllocationCounter::GetCount();
+        std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+        for (unsigned long long i = 0; i < iterations; i++)
+            operation();
+
+        std::chrono::high_resolution_clock::time_point end = std::chrono::high_resolution_clock::now();
+        allocations = AllocationCounter::GetCount() - allocationsStart;
+        seconds = std::chrono::duration<double>(end - start).count();
+
+        if (seconds >= gMinTime)
+            break;
+
+        //Aim a bit past the minimum time with the speed measured so far
+        double scale = seconds > 0.0 ? gMinTime * 1.2 / seconds : 100.0;
+        iterations = (unsigned long long)(iterations * (scale < 100.0 ? scale : 100.0)) + 1;
+    }
+
+    BenchmarkResult result;
+    result.Name = name;
+    result.Iterations = iterations;
+    result.NsPerOp = seconds * 1e9 / iterations;
+    result.OpsPerSecond = iterations / seconds;
+    result.ItemsPerSecond = result.OpsPerSecond * itemsPerOp;
+    result.ItemName = itemName;
+    result.AllocationsPerOp = AllocationCounter::IsEnabled() ? (double)allocations / iterations : -1.0;
+
+    printf("%-56s %12llu %14.1f %14.4g %-12s %10.2f\n", result.Name.c_str(), result.Iterations, result.NsPerOp,
+           result.ItemsPerSecond, result.ItemName.c_str(), result.AllocationsPerOp);
+    return result;
+}
+
+//FeedForward, BackPropagate and the connection weights copies of a network
+template <typename T>
+void RunNetworkBenchmarks(const std::vector<unsigned> &topology, const char *precision, std::vector<BenchmarkResult> &results)
+{
+    Random::SetRunSeed(1);
+    NetworkT<T> network(topology);
+
+    std::vector<T> inputs(topology.front()), targets(topology.back());
+    Random &random = Random::GetThreadRandom();
+    random.FillUniform(inputs.data(), inputs.size(), (T)-1.0, (T)1.0);
+    random.FillUniform(targets.data(), targets.size(), (T)0.0, (T)1.0);
+
+    double connections = 0.0;
+    std::string name = std::string(precision) + "/";
+    for (unsigned i = 0; i < topology.size(); i++)
+    {
+        name += (i > 0 ? "-" : "") + std::to_string(topology[i]);
+        if (i > 0)
+            connections += topology[i] * (topology[i - 1] + 1.0);
+    }
+
+    results.push_back(Measure("network/feedforward/" + name, connections, "connections", [&]() { network.FeedForward(inputs.data()); }));
+
+    //Every call back propagates the outputs of the same forward pass, the cost does not depend on the values
+    network.FeedForward(inputs.data());
+    results.push_back(Measure("network/backpropagate/" + name, connections, "connections", [&]() { network.BackPropagate(targets.data()); }));
+
+    std::vector<T> weights;
+    results.push_back(Measure("network/getconnectionweights/" + name, connections, "connections", [&]() { network.GetConnectionWeights(weights); }));
+    results.push_back(Measure("network/setconnectionweights/" + name, connections, "connections", [&]() { network.SetConnectionWeights(weights); }));
+}
+
+//A whole generation and every step of it, over a population of the given size
+void RunGABenchmarks(unsigned population, std::vector<BenchmarkResult> &results)
+{
+    Random::SetRunSeed(1);
+    GA ga(population);
+    ga.SetVerbose(false);
+
+    std::string name = "/population=" + std::to_string(population);
+    results.push_back(Measure("ga/evaluate" + name, population, "genomes", [&]() { ga.UpdateFitnessScore(); }));
+
+    //The parents of a whole generation, the tables of each method are built by UpdateFitnessScore
+    std::vector<unsigned> parents(population);
+    const Selector::Method methods[] = { Selector::Roulette, Selector::Alias, Selector::Tournament };
+    for (unsigned i = 0; i < sizeof(methods) / sizeof(methods[0]); i++)
+    {
+        ga.SetSelection(methods[i]);
+        ga.UpdateFitnessScore();
+        results.push_back(Measure(std::string("ga/selection/") + Selector::GetMethodName(methods[i]) + name, population, "parents",
+                                  [&]() { ga.SelectParents(parents.data(), population); }));
+    }
+    ga.SetSelection(Selector::Roulette);
+    ga.UpdateFitnessScore();
+
+    //A quarter of the population as the elite, over random fitness values with a few clones
+    std::vector<double> fitness(population);
+    Random::GetThreadRandom().FillUniform(fitness.data(), population, 0.0, 1.0);
+    for (unsigned i = 7; i < population; i += 8)
+        fitness[i] = fitness[i - 1];
+    std::vector<unsigned> elite(population / 4 + 1);
+    Arena arena;
+    results.push_back(Measure("ga/elitism" + name, population, "genomes",
+                              [&]() { arena.Reset(); Selector::SelectElite(fitness.data(), population, (unsigned)elite.size(), elite.data(), arena); }));
+
+    const Gene *mom = ga.GetChromosome(parents[0]);
+    const Gene *dad = ga.GetChromosome(parents[1]);
+    std::vector<Gene> child1(ga.GetChromosomeLength()), child2(ga.GetChromosomeLength());
+    double genes = (double)ga.GetChromosomeLength();
+    results.push_back(Measure("ga/crossover" + name, 2.0 * genes, "genes", [&]() { ga.Crossover(mom, dad, child1.data(), child2.data()); }));
+    results.push_back(Measure("ga/mutation" + name, genes, "genes", [&]() { ga.Mutate(child1.data()); }));
+
+    results.push_back(Measure("ga/epoch" + name, population, "genomes", [&]() { ga.Epoch(); }));
+}
+
+int main(int argc, char *argv[])
+{
+    //--json file writes the results as JSON (ns/op, ops/s, items/s and allocations/op of every operation)
+    //--baseline file compares the results with a JSON file written before, the exit code is 1 on regressions
+    //--threshold n percentage of extra time that counts as a regression (10 by default)
+    //--min-time s seconds every measurement runs for (0.2 by default)
+    //--quick stops the sweeps at the mid sizes, for a fast check
+    std::string jsonFile, baselineFile;
+    double threshold = 10.0;
+    bool quick = false;
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::string(argv[i]) == "--json" && i + 1 < argc)
+            jsonFile = argv[++i];
+        else if (std::string(argv[i]) == "--baseline" && i + 1 < argc)
+            baselineFile = argv[++i];
+        else if (std::string(argv[i]) == "--threshold" && i + 1 < argc)
+            threshold = atof(argv[++i]);
+        else if (std::string(argv[i]) == "--min-time" && i + 1 < argc)
+            gMinTime = atof(argv[++i]);
+        else if (std::string(argv[i]) == "--quick")
+            quick = true;
+    }
+
+    std::vector<BenchmarkResult> baseline;
+    if (!baselineFile.empty() && !BenchmarkResults::Read(baselineFile, baseline))
+    {
+        printf("Could not read the baseline %s\n", baselineFile.c_str());
+        return 1;
+    }
+
+    const char *instructionSet = Kernels::GetInstructionSetName(Kernels::GetInstructionSet());
+    printf("Instruction set: %s\n\n", instructionSet);
+    printf("%-56s %12s %14s %14s %-12s %10s\n", "benchmark", "iterations", "ns/op", "items/s", "item", "allocs/op");
+
+    //From the XOR network of the GA up to thousands of neurons
+    const std::vector<std::vector<unsigned> > topologies =
+    {
+        { 2, 2, 1 },
+        { 4, 16, 3 },
+        { 16, 64, 64, 8 },
+        { 64, 256, 256, 16 },
+        { 256, 1024, 1024, 64 },
+        { 1024, 2048, 2048, 256 },
+    };
+    const unsigned populations[] = { 10, 100, 1000, 10000, 100000 };
+
+    std::vector<BenchmarkResult> results;
+    for (unsigned i = 0; i < topologies.size() && (!quick || i < 4); i++)
+    {
+        RunNetworkBenchmarks<double>(topologies[i], "double", results);
+        RunNetworkBenchmarks<float>(topologies[i], "float", results);
+    }
+
+    for (unsigned i = 0; i < sizeof(populations) / sizeof(populations[0]) && (!quick || populations[i] <= 10000); i++)
+        RunGABenchmarks(populations[i], results);
+
+    if (!jsonFile.empty())
+    {
+        if (BenchmarkResults::Write(jsonFile, instructionSet, results))
+            printf("\nResults written to %s\n", jsonFile.c_str());
+        else
+            printf("\nCould not write %s\n", jsonFile.c_str());
+    }
+
+    if (baseline.empty())
+        return 0;
+
+    std::vector<BenchmarkComparison> comparisons;
+    unsigned regressions = BenchmarkResults::Compare(baseline, results, threshold / 100.0, comparisons);
+
+    printf("\n%-56s %14s %14s %9s\n", "benchmark", "baseline ns", "ns/op", "change");
+    for (unsigned i = 0; i < comparisons.size(); i++)
+    {
+        const BenchmarkComparison &comparison = comparisons[i];
+        printf("%-56s %14.1f %14.1f %+8.1f%% %s\n", comparison.Name.c_str(), comparison.BaselineNsPerOp, comparison.NsPerOp,
+               comparison.Change * 100.0, comparison.Regression ? "REGRESSION" : "");
+    }
+
+    printf("\n%u regressions over %.1f%% against %s\n", regressions, threshold, baselineFile.c_str());
+    return regressions > 0 ? 1 : 0;
+}
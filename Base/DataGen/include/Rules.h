@@ -0,0 +1,58 @@
+﻿//
+//  Rules.h
+//  NeuralNetwork
+//
+
+#pragma once
+
+#include "Random.h"
+
+#include <string>
+#include <vector>
+
+//Generates one sample of a dataset: random inputs and the outputs the network should learn for them.
+//Generate is const, a single rule is shared by every generator thread, each one with its own Random.
+class DatasetRule
+{
+public:
+    virtual ~DatasetRule() {}
+
+    virtual const char *GetName() const = 0;
+    virtual unsigned GetNumInputs() const = 0;
+    virtual unsigned GetNumOutputs() const = 0;
+
+    virtual void Generate(Random &random, double *inputs, double *targets) const = 0;
+};
+
+//The platformer character: obstacles down, back, up and forward, jump, move left and move right
+class PlatformerRule : public DatasetRule
+{
+public:
+    const char *GetName() const override { return "platformer"; }
+    unsigned GetNumInputs() const override { return 4; }
+    unsigned GetNumOutputs() const override { return 3; }
+
+    void Generate(Random &random, double *inputs, double *targets) const override;
+
+private:
+    static bool ShouldUp(const double *inputs);
+    static bool ShouldLeft(const double *inputs);
+    static bool ShouldRight(const double *inputs);
+};
+
+class XorRule : public DatasetRule
+{
+public:
+    const char *GetName() const override { return "xor"; }
+    unsigned GetNumInputs() const override { return 2; }
+    unsigned GetNumOutputs() const override { return 1; }
+
+    void Generate(Random &random, double *inputs, double *targets) const override;
+};
+
+//Every rule DataGen knows, new rules only have to be added to the list in Rules.cpp
+namespace Rules
+{
+    const DatasetRule *Find(const std::string &name);
+    void GetNames(std::vector<std::string> &names);
+}
@@ -0,0 +1,211 @@
+
+#include "Rules.h"
+#include "BinaryDataset.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <thread>
+
+struct GeneratorSettings
+{
+    const DatasetRule *Rule;
+    std::vector<unsigned> Topology;
+    unsigned long long NumSamples;
+    unsigned NumShards;
+    unsigned long long Seed;
+    bool Binary;
+    bool SinglePrecision;
+    std::string Output;
+};
+
+std::string GetShardFilename(const GeneratorSettings &settings, unsigned shardIdx)
+{
+    std::string extension = settings.Binary ? ".bin" : ".txt";
+    if (settings.NumShards == 1)
+        return settings.Output + extension;
+
+    char index[16];
+    std::snprintf(index, sizeof(index), ".%03u", shardIdx);
+    return settings.Output + index + extension;
+}
+
+//Same layout as trainingData.txt, which TrainingData and TextDatasetReader both read
+void WriteTextValues(std::FILE *file, const char *label, const double *values, unsigned count, bool trailingSpace)
+{
+    std::fputs(label, file);
+    for (unsigned i = 0; i < count; i++)
+    {
+        //Whole numbers keep the "1.0" look of the original file, the rest round trip exactly
+        if (values[i] == (double)(long long)values[i])
+            std::fprintf(file, "%.1f", values[i]);
+        else
+            std::fprintf(file, "%.17g", values[i]);
+
+        if (trailingSpace || i + 1 < count)
+            std::fputc(' ', file);
+    }
+    std::fputc('\n', file);
+}
+
+bool WriteTextShard(const GeneratorSettings &settings, const std::string &filename, Random &random, unsigned long long numSamples)
+{
+    std::FILE *file = std::fopen(filename.c_str(), "wb");
+    if (!file)
+        return false;
+
+    std::vector<char> buffer(1 << 20);
+    std::setvbuf(file, buffer.data(), _IOFBF, buffer.size());
+
+    std::fputs("topology:", file);
+    for (unsigned i = 0; i < settings.Topology.size(); i++)
+        std::fprintf(file, " %u", settings.Topology[i]);
+    std::fputc('\n', file);
+
+    std::vector<double> inputs(settings.Rule->GetNumInputs());
+    std::vector<double> targets(settings.Rule->GetNumOutputs());
+    for (unsigned long long sampleIdx = 0; sampleIdx < numSamples; sampleIdx++)
+    {
+        settings.Rule->Generate(random, inputs.data(), targets.data());
+        WriteTextValues(file, "In: ", inputs.data(), (unsigned)inputs.size(), true);
+        WriteTextValues(file, "Out: ", targets.data(), (unsigned)targets.size(), false);
+    }
+
+    bool good = std::ferror(file) == 0;
+    return std::fclose(file) == 0 && good;
+}
+
+bool WriteBinaryShard(const GeneratorSettings &settings, const std::string &filename, Random &random, unsigned long long numSamples)
+{
+    BinaryDatasetWriter writer;
+    if (!writer.Open(filename, settings.Topology, settings.SinglePrecision ? BinaryDatasetFormat::Float32 : BinaryDatasetFormat::Float64))
+        return false;
+
+    std::vector<double> inputs(settings.Rule->GetNumInputs());
+    std::vector<double> targets(settings.Rule->GetNumOutputs());
+    for (unsigned long long sampleIdx = 0; sampleIdx < numSamples; sampleIdx++)
+    {
+        settings.Rule->Generate(random, inputs.data(), targets.data());
+        writer.Write(inputs.data(), targets.data());
+    }
+
+    return writer.Close();
+}
+
+//Threads take whole shards, every shard has its own random stream: the files only depend on the seed
+void GenerateShards(const GeneratorSettings &settings, std::atomic<unsigned> *nextShard, std::atomic<bool> *failed)
+{
+    unsigned long long shardSize = settings.NumSamples / settings.NumShards;
+    unsigned long long remainder = settings.NumSamples % settings.NumShards;
+
+    for (unsigned shardIdx = (*nextShard)++; shardIdx < settings.NumShards && !*failed; shardIdx = (*nextShard)++)
+    {
+        std::string filename = GetShardFilename(settings, shardIdx);
+        Random random = Random::Stream(settings.Seed, shardIdx);
+        unsigned long long numSamples = shardSize + (shardIdx < remainder ? 1 : 0);
+
+        bool written = settings.Binary ? WriteBinaryShard(settings, filename, random, numSamples) :
+                                         WriteTextShard(settings, filename, random, numSamples);
+        if (!written)
+        {
+            std::cout << "Could not write " << filename << std::endl;
+            *failed = true;
+        }
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    //--rule name picks the rule the samples follow (platformer or xor)
+    //--samples n generates n samples in total
+    //--shards n splits them in n files, output.000.ext, output.001.ext...
+    //--threads n generates on n threads (0 for every core), at most one per shard: a shard is one random stream
+    //written in order by one thread, so use at least as many --shards as threads
+    //--seed n seeds the random streams, the same seed always gives the same files
+    //--format binary|text writes binary datasets or text files like trainingData.txt
+    //--float writes single precision binary datasets
+    //--hidden n sets the hidden layer size of the topology in the files
+    //--out prefix names the output files
+    GeneratorSettings settings;
+    std::string ruleName = "platformer";
+    settings.NumSamples = 2000;
+    settings.NumShards = 1;
+    settings.Seed = 0;
+    settings.Binary = true;
+    settings.SinglePrecision = false;
+    settings.Output = "../data/generatedData";
+    unsigned numThreads = 0;
+    unsigned hiddenNeurons = 4;
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::string(argv[i]) == "--rule" && i + 1 < argc)
+            ruleName = argv[++i];
+        else if (std::string(argv[i]) == "--samples" && i + 1 < argc)
+            settings.NumSamples = std::stoull(argv[++i]);
+        else if (std::string(argv[i]) == "--shards" && i + 1 < argc)
+            settings.NumShards = (unsigned)std::stoul(argv[++i]);
+        else if (std::string(argv[i]) == "--threads" && i + 1 < argc)
+            numThreads = (unsigned)std::stoul(argv[++i]);
+        else if (std::string(argv[i]) == "--seed" && i + 1 < argc)
+            settings.Seed = std::stoull(argv[++i]);
+        else if (std::string(argv[i]) == "--format" && i + 1 < argc)
+            settings.Binary = std::string(argv[++i]) != "text";
+        else if (std::string(argv[i]) == "--float")
+            settings.SinglePrecision = true;
+        else if (std::string(argv[i]) == "--hidden" && i + 1 < argc)
+            hiddenNeurons = (unsigned)std::stoul(argv[++i]);
+        else if (std::string(argv[i]) == "--out" && i + 1 < argc)
+            settings.Output = argv[++i];
+    }
+
+    settings.Rule = Rules::Find(ruleName);
+    if (!settings.Rule)
+    {
+        std::vector<std::string> names;
+        Rules::GetNames(names);
+
+        std::cout << "Unknown rule " << ruleName << ", the rules are:";
+        for (unsigned i = 0; i < names.size(); i++)
+            std::cout << " " << names[i];
+        std::cout << std::endl;
+        return 1;
+    }
+
+    if (settings.NumShards == 0)
+        settings.NumShards = 1;
+
+    settings.Topology.push_back(settings.Rule->GetNumInputs());
+    if (hiddenNeurons > 0)
+        settings.Topology.push_back(hiddenNeurons);
+    settings.Topology.push_back(settings.Rule->GetNumOutputs());
+
+    //Only an explicit --threads above the shards is worth a note, every core is just the default
+    if (numThreads > settings.NumShards)
+        std::cout << "Generating on " << settings.NumShards << " of " << numThreads << " threads, one per shard" << std::endl;
+    if (numThreads == 0)
+        numThreads = std::max(std::thread::hardware_concurrency(), 1u);
+    if (numThreads > settings.NumShards)
+        numThreads = settings.NumShards;
+
+    std::atomic<unsigned> nextShard(0);
+    std::atomic<bool> failed(false);
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (unsigned i = 1; i < numThreads; i++)
+        threads.push_back(std::thread(GenerateShards, std::cref(settings), &nextShard, &failed));
+    GenerateShards(settings, &nextShard, &failed);
+    for (unsigned i = 0; i < threads.size(); i++)
+        threads[i].join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if (failed)
+        return 1;
+
+    std::cout << "Generated " << settings.NumSamples << " " << settings.Rule->GetName() << " samples in " << settings.NumShards
+              << (settings.NumShards == 1 ? " file" : " files") << " on " << numThreads << (numThreads == 1 ? " thread" : " threads")
+              << " in " << seconds << "s (" << (seconds > 0.0 ? settings.NumSamples / seconds : 0.0) << " samples/s)" << std::endl;
+    return 0;
+}
@@ -0,0 +1,74 @@
+
+#include "Rules.h"
+
+void PlatformerRule::Generate(Random &random, double *inputs, double *targets) const
+{
+    //down, back, up, forward: 1.0 when there is an obstacle (or floor)
+    uint64_t bits = random.Next() >> 60;
+    for (unsigned i = 0; i < 4; i++)
+        inputs[i] = (double)((bits >> i) & 1);
+
+    targets[0] = ShouldUp(inputs) ? 1.0 : 0.0;
+    targets[1] = ShouldLeft(inputs) ? 1.0 : 0.0;
+    targets[2] = ShouldRight(inputs) ? 1.0 : 0.0;
+}
+
+bool PlatformerRule::ShouldUp(const double *inputs)
+{
+    //If there is a obstacle above
+    if (inputs[2] == 1.0) return false;
+    //If there is a pit on the floor
+    else if (inputs[0] == 0.0) return true;
+    //If there is an obstacle in front
+    else if (inputs[3] == 1.0) return true;
+
+    return false;
+}
+
+bool PlatformerRule::ShouldLeft(const double *inputs)
+{
+    //If there is an obstacle forward and above, but no obstacle behind
+    return inputs[3] == 1.0 && inputs[2] == 1.0 && inputs[1] == 0.0;
+}
+
+bool PlatformerRule::ShouldRight(const double *inputs)
+{
+    //If there is no obstacle in front
+    if (inputs[3] == 0.0) return true;
+    //If there is a obstacle in front, but you can jump it
+    else if (inputs[3] == 1.0 && inputs[2] == 0.0) return true;
+
+    return false;
+}
+
+void XorRule::Generate(Random &random, double *inputs, double *targets) const
+{
+    uint64_t bits = random.Next() >> 62;
+    inputs[0] = (double)(bits & 1);
+    inputs[1] = (double)(bits >> 1);
+    targets[0] = (double)((bits & 1) ^ (bits >> 1));
+}
+
+namespace Rules
+{
+    static const PlatformerRule platformer;
+    static const XorRule xorRule;
+    static const DatasetRule *const rules[] = { &platformer, &xorRule };
+
+    const DatasetRule *Find(const std::string &name)
+    {
+        for (const DatasetRule *rule : rules)
+        {
+            if (name == rule->GetName())
+                return rule;
+        }
+        return nullptr;
+    }
+
+    void GetNames(std::vector<std::string> &names)
+    {
+        names.clear();
+        for (const DatasetRule *rule : rules)
+            names.push_back(rule->GetName());
+    }
+}
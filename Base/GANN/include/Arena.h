@@ -0,0 +1,41 @@
+﻿//
+//  Arena.h
+//  GANN
+//
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+//Bump allocator for the scratch memory of one generation. Allocate hands out consecutive pieces of one block
+//and Reset releases all of them at once. A generation that needs more than the block gets extra blocks, and
+//the next Reset replaces them all with a single block of the combined size: after the first generations
+//the arena no longer touches the heap.
+class Arena
+{
+public:
+    explicit Arena(size_t capacity = 0);
+    ~Arena() {}
+
+    //Room for count values of T (constructed by the caller), valid until the next Reset
+    template <typename T>
+    inline T *Allocate(size_t count) { return (T *)AllocateBytes(count * sizeof(T), alignof(T)); }
+    void Reset();
+
+    inline size_t GetCapacity() const { return mCapacity; }
+    //Bytes handed out since the last Reset, extra blocks included
+    inline size_t GetUsed() const { return mUsed + mOverflowSize; }
+
+private:
+    void *AllocateBytes(size_t size, size_t alignment);
+
+    std::unique_ptr<char[]> mBlock;
+    size_t mCapacity;
+    size_t mUsed;
+
+    //Blocks of the allocations that did not fit, merged into mBlock by Reset
+    std::vector<std::unique_ptr<char[]> > mOverflow;
+    size_t mOverflowSize;
+};
@@ -0,0 +1,133 @@
+﻿//
+//  Checkpoint.h
+//  GANN
+//
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "BinaryDataset.h"
+
+//Snapshot of a GA run between two generations (prefix.ckpt), written as:
+//  Header, the chromosomes of every genome (NumGenomes x ChromosomeLength genes) and their fitness (NumGenomes x double).
+//Every generation replaces all the children, so there are no deltas: hardly a gene stays at the same place
+//between two checkpoints. Checksum is the CRC32 of everything after the header. Values are stored in the machine byte order.
+namespace CheckpointFormat
+{
+    const char Magic[4] = { 'G', 'A', 'C', 'P' };
+    const uint32_t Version = 3;
+
+    //Type of the genes, same values as the dataset files
+    typedef BinaryDatasetFormat::DataType DataType;
+
+    struct Header
+    {
+        char Magic[4];
+        uint32_t Version;
+        uint32_t DataType;
+        uint32_t Generation;
+        uint32_t NumGenomes;
+        uint32_t ChromosomeLength;
+        //GA parameters
+        uint32_t Population;
+        uint32_t ElitismSelection;
+        uint32_t FittestGenome;
+        //Parent selection, a Selector::Method and the genomes of a tournament
+        uint32_t SelectionMethod;
+        uint32_t TournamentSize;
+        uint32_t Checksum;
+        double CrossoverRate;
+        double MutationRate;
+        double MaxPerturbation;
+        double BestFitnessScore;
+        double TotalFitnessScore;
+        //State of the random generator of the genetic operators
+        uint64_t RandomState[4];
+        uint64_t FileSize;
+    };
+    static_assert(sizeof(Header) == 128, "The checkpoint header is 128 bytes");
+}
+
+//Everything a GA needs to continue a run exactly where it was
+template <typename T>
+struct GACheckpointT
+{
+    unsigned Generation;
+    unsigned Population;
+    unsigned ElitismSelection;
+    unsigned FittestGenome;
+    unsigned SelectionMethod;
+    unsigned TournamentSize;
+    double CrossoverRate;
+    double MutationRate;
+    double MaxPerturbation;
+    double BestFitnessScore;
+    double TotalFitnessScore;
+    uint64_t RandomState[4];
+
+    unsigned ChromosomeLength;
+    //Row-major [genomes x chromosome length]
+    std::vector<T> Bits;
+    std::vector<double> Fitness;
+
+    inline unsigned GetNumGenomes() const { return (unsigned)Fitness.size(); }
+};
+
+namespace Checkpoint
+{
+    template <typename T>
+    bool Write(const std::string &filename, const GACheckpointT<T> &checkpoint);
+    //Loads prefix.ckpt, false if there is no valid checkpoint
+    template <typename T>
+    bool Load(const std::string &prefix, GACheckpointT<T> &checkpoint);
+}
+
+//Writes the checkpoints of a run in a background thread, Submit only swaps the state in
+template <typename T>
+class CheckpointWriterT
+{
+public:
+    CheckpointWriterT();
+    ~CheckpointWriterT();
+
+    bool Open(const std::string &prefix);
+    //Writes the checkpoint still waiting and stops the thread
+    void Close();
+    inline bool IsOpen() const { return mThread.joinable(); }
+
+    //Hands a checkpoint to the thread by swapping it with the pending one: checkpoint is left with the buffers
+    //of an older checkpoint, ready to be refilled without allocating. If the previous one is still waiting
+    //it is replaced, only the newest is written
+    void Submit(GACheckpointT<T> &checkpoint);
+    //Waits until every submitted checkpoint has been written
+    void Flush();
+    //Checkpoints that could not be written
+    inline unsigned GetFailed() const { return mFailed; }
+
+private:
+    void WriteCheckpoints();
+
+    std::string mPrefix;
+    unsigned mFailed;
+
+    //mPending is swapped in by Submit, the thread swaps it with mWriting and writes it without the lock
+    GACheckpointT<T> mPending;
+    GACheckpointT<T> mWriting;
+    bool mHasPending;
+    bool mBusy;
+    bool mStop;
+
+    std::mutex mMutex;
+    std::condition_variable mCondition;
+    std::thread mThread;
+};
+
+//Implemented in Checkpoint.cpp for these two types only
+typedef CheckpointWriterT<double> CheckpointWriter;
+typedef CheckpointWriterT<float> FloatCheckpointWriter;
@@ -6,47 +6,123 @@
 //  Copyright 2017 David Parra. All rights reserved.
 //
 
-#include <vector>
+#pragma once
 
-#include "Network.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
 
-struct SGenome
-{
-    Network *NNetwork = nullptr;
-    std::vector <double> Bits;
-    double Fitness;
+#include "Arena.h"
+#include "Checkpoint.h"
+#include "FixedNetwork.h"
+#include "PopulationNetwork.h"
+#include "PopulationStore.h"
+#include "Random.h"
+#include "Selection.h"
+#include "ThreadPool.h"
 
-    SGenome();
-    //SGenome(const std::vector <double> &w, double f) : Bits(w), Fitness(f) {}
+//Scalar type of the chromosomes and of the networks built from them.
+//Define GANN_FLOAT_GENES to evolve single precision networks (half the memory per genome)
+#if defined(GANN_FLOAT_GENES)
+typedef float Gene;
+#else
+typedef double Gene;
+#endif
+//Every genome drives the same tiny XOR network, its topology is fixed at compile time
+typedef FixedNetworkT<Gene, 2, 2, 1> GeneNetwork;
+//The same network for every genome of a generation, evaluated all at once
+typedef PopulationNetworkT<Gene> GenePopulation;
+typedef GACheckpointT<Gene> GACheckpoint;
+//Chromosomes of a whole generation, one row per genome
+typedef PopulationStoreT<Gene> GenePopulationStore;
 
-    //friend bool operator < (const SGenome &lhs, const SGenome &rhs) { return (lhs.fitness < rhs.fitness); }
-};
+//[0...1] fitness performance of a network solving the XOR cases
+double GetNetworkPerformance(GeneNetwork &network, bool debug);
+//The same fitness for every genome of the population, fitness[genome]
+void GetPopulationPerformance(GenePopulation &population, std::vector<double> &fitness);
 
 class GA
 {
 public:
-    GA();
+    //seed drives the genetic operators from a stream of its own, the same seed and start population give the same run
+    explicit GA(unsigned population = 50, uint64_t seed = 0);
     ~GA();
 
     void Epoch();
     void TestFittestGenome();
+    //Writes the network of the fittest genome as a model file (see ModelFile.h)
+    bool SaveFittestGenome(const std::string &filename) const;
+    //Prints every new generation and fitness record (on by default)
+    inline void SetVerbose(bool verbose) { mVerbose = verbose; }
+    inline unsigned GetPopulationSize() const { return mPopulation; }
+    inline unsigned GetGeneration() const { return mGeneration; }
+    //Chromosome of a genome of the current generation, [GetChromosomeLength()] genes valid until the next Epoch
+    inline const Gene *GetChromosome(unsigned genome) const { return mGenomes.GetChromosome(genome); }
+    inline unsigned GetChromosomeLength() const { return mChromosomeLenght; }
+    //Parent selection of the next generations, the roulette wheel by default (see Selection.h).
+    //Part of the checkpoints, Resume restores the one of the original run
+    void SetSelection(Selector::Method method, unsigned tournamentSize = 2);
+    inline Selector::Method GetSelection() const { return mSelector.GetMethod(); }
+    inline unsigned GetTournamentSize() const { return mSelector.GetTournamentSize(); }
+    //Threads of the fitness evaluation, 0 for every hardware thread (the default)
+    void SetNumThreads(unsigned numThreads);
+    inline unsigned GetNumThreads() const { return mThreadPool->GetNumThreads(); }
 
-private:
-    SGenome& RouleteWheelSelection();
-    void ElitismSelection(unsigned amount, std::vector <SGenome> &genomes);
+    //Writes a checkpoint of the run every interval generations from a background thread (see Checkpoint.h)
+    bool EnableCheckpoints(const std::string &prefix, unsigned interval);
+    //Waits for the checkpoints still being written
+    void FlushCheckpoints();
+    //Continues the run of the last checkpoint of prefix, the next generations are the same as in the original run
+    bool Resume(const std::string &prefix);
 
-    void Mutate(std::vector<double> &chromosome);
-    void Crossover(const std::vector <double> &mom, const std::vector <double> &dad, std::vector <double> &child1, std::vector <double> &child2);
+    //The steps of an Epoch, one by one (the benchmark suite times them separately).
+    //Chromosomes are rows of [GetChromosomeLength()] genes, the children are written in place
 
+    //Starts a new generation: releases the scratch of the last one, evaluates every genome on the thread pool
+    //in blocks of FitnessBlockSize genomes and prepares the selection tables. The total, best and fittest
+    //genome are reduced in genome order: the same values whatever the number of threads.
     void UpdateFitnessScore();
-    void UpdateWeights(SGenome &genome);
+    //Draws count parents (genome indices) of the current generation at once
+    void SelectParents(unsigned *parents, unsigned count);
+    void Crossover(const Gene *mom, const Gene *dad, Gene *child1, Gene *child2);
+    void Mutate(Gene *chromosome);
+
+private:
+    //Genomes evaluated by one task, a multiple of the cache line values of the population network rows
+    static const unsigned FitnessBlockSize = 256;
+
+    //Population network of a block of genomes and their fitness, only touched by the task of the block
+    struct FitnessBlock
+    {
+        FitnessBlock(unsigned firstGenome, unsigned numGenomes) : FirstGenome(firstGenome), Network(GeneNetwork::GetTopology(), numGenomes) {}
+
+        unsigned FirstGenome;
+        GenePopulation Network;
+        std::vector<double> Fitness;
+    };
+
+    void EvaluateBlock(FitnessBlock &block);
+
+    //Copies the best genomes (without clones, see Selector::SelectElite) to the first rows of the next generation
+    void ElitismSelection(unsigned amount, GenePopulationStore &genomes);
 
     void CreateStartPopulation();
 
-    //The population of genomes
-    std::vector<SGenome> mGenomes;
+    void SaveCheckpoint(GACheckpoint &checkpoint) const;
+    void LoadCheckpoint(const GACheckpoint &checkpoint);
+
+    inline float RandFloat() { return (float)mRandom.NextDouble(); }
+    inline float RandFloatClamped() { return RandFloat() * 2.0f - 1.0f; }
+    inline int RandInt(int min, int max) { return (int)mRandom.NextUnsigned(max - min) + min; }
+
+    //The population of genomes, and the buffers of the next generation: Epoch fills them and swaps both
+    GenePopulationStore mGenomes;
+    GenePopulationStore mNextGenomes;
+    //Scratch memory of an Epoch, released at the start of the next one
+    Arena mArena;
     //Size of the population
-    unsigned mPopulation = 50;
+    unsigned mPopulation;
     //The rate that the chosen chromosomes can swap their bits (to generate a child)
     double mCrossoverRate = 0.5;
     //The chance that a child chromosome can be mutated (his bits are flipped)
@@ -62,4 +138,20 @@ private:
     double mBestFitnessScore = 0.0;
     double mTotalFitnessScore = 0.0;
     unsigned mGeneration = 0;
+    bool mVerbose = true;
+
+    //Random numbers of the genetic operators, its state is part of the checkpoints
+    Random mRandom;
+    //Uniform numbers of the mutation chances of one chromosome
+    std::vector<float> mMutationDraws;
+    Selector mSelector;
+
+    CheckpointWriterT<Gene> mCheckpointWriter;
+    //Filled by Epoch and swapped into the writer, in between it keeps the buffers of an older checkpoint
+    GACheckpoint mCheckpoint;
+    unsigned mCheckpointInterval = 0;
+
+    //Holds the weights of every genome to evaluate the whole generation, one block per task
+    std::vector<FitnessBlock> mFitnessBlocks;
+    std::unique_ptr<ThreadPool> mThreadPool;
 };
\ No newline at end of file
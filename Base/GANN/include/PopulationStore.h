@@ -0,0 +1,58 @@
+﻿//
+//  PopulationStore.h
+//  GANN
+//
+
+#pragma once
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+//Chromosomes and fitness of one generation. Every chromosome is a row of a single row-major
+//matrix [genomes x chromosome length], the layout of the checkpoints. A GA keeps two of them,
+//the current generation and the next one it is building, and swaps them at the end of every epoch.
+template <typename T>
+class PopulationStoreT
+{
+public:
+    PopulationStoreT() : mNumGenomes(0), mChromosomeLength(0) {}
+
+    //Never gives memory back: once the store has held the largest generation of a run it does not allocate again
+    inline void Resize(unsigned numGenomes, unsigned chromosomeLength)
+    {
+        mNumGenomes = numGenomes;
+        mChromosomeLength = chromosomeLength;
+        mBits.resize((size_t)numGenomes * chromosomeLength);
+        mFitness.resize(numGenomes);
+    }
+
+    inline unsigned GetNumGenomes() const { return mNumGenomes; }
+    inline unsigned GetChromosomeLength() const { return mChromosomeLength; }
+
+    inline T *GetChromosome(unsigned genome) { return &mBits[(size_t)genome * mChromosomeLength]; }
+    inline const T *GetChromosome(unsigned genome) const { return &mBits[(size_t)genome * mChromosomeLength]; }
+    inline double GetFitness(unsigned genome) const { return mFitness[genome]; }
+    inline void SetFitness(unsigned genome, double fitness) { mFitness[genome] = fitness; }
+
+    //The whole matrix and every fitness value, [genomes x chromosome length] and [genomes]
+    inline const T *GetBits() const { return mBits.data(); }
+    inline T *GetBits() { return mBits.data(); }
+    inline const double *GetFitnessValues() const { return mFitness.data(); }
+    inline double *GetFitnessValues() { return mFitness.data(); }
+
+    //Exchanges the buffers, nothing is copied
+    inline void Swap(PopulationStoreT<T> &other)
+    {
+        std::swap(mNumGenomes, other.mNumGenomes);
+        std::swap(mChromosomeLength, other.mChromosomeLength);
+        mBits.swap(other.mBits);
+        mFitness.swap(other.mFitness);
+    }
+
+private:
+    unsigned mNumGenomes;
+    unsigned mChromosomeLength;
+    std::vector<T> mBits;
+    std::vector<double> mFitness;
+};
@@ -0,0 +1,63 @@
+﻿//
+//  Selection.h
+//  GANN
+//
+
+#pragma once
+
+#include <string>
+
+#include "Arena.h"
+#include "Random.h"
+
+//Parent selection over the fitness of one generation. Prepare builds the tables of the method once per
+//generation in the arena, then every draw is cheap whatever the population size:
+//  Roulette: fitness proportionate, binary search over the prefix sums of the fitness, O(log n)
+//  Alias: fitness proportionate, Walker alias table (Vose construction), O(1)
+//  Tournament: the fittest of k genomes drawn uniformly, O(k), no table
+//Roulette draws the same genomes as a linear scan of the wheel for the same random numbers.
+class Selector
+{
+public:
+    enum Method
+    {
+        Roulette = 0,
+        Alias,
+        Tournament
+    };
+
+    Selector();
+    ~Selector() {}
+
+    //tournamentSize is only used by Tournament, at least 1
+    void SetMethod(Method method, unsigned tournamentSize = 2);
+    inline Method GetMethod() const { return mMethod; }
+    inline unsigned GetTournamentSize() const { return mTournamentSize; }
+
+    //fitness [numGenomes] (>= 0) must stay unchanged until the last draw, the tables live until the arena Reset
+    void Prepare(const double *fitness, unsigned numGenomes, Arena &arena);
+
+    unsigned Select(Random &random);
+    //count draws at once into genomes[count], the same genomes as count calls to Select
+    void SelectBatch(Random &random, unsigned *genomes, unsigned count);
+
+    //The amount fittest genomes into elite[amount], fittest first. Genomes with the same fitness as one already
+    //in the elite are clones of it and only fill the places left once every other fitness is in. O(n + k log k)
+    static void SelectElite(const double *fitness, unsigned numGenomes, unsigned amount, unsigned *elite, Arena &arena);
+
+    static const char *GetMethodName(Method method);
+    //False if name is not roulette, alias or tournament
+    static bool ParseMethod(const std::string &name, Method &method);
+
+private:
+    Method mMethod;
+    unsigned mTournamentSize;
+
+    const double *mFitness;
+    unsigned mNumGenomes;
+    //Roulette: [numGenomes] running sums of the fitness
+    double *mPrefixSums;
+    //Alias: acceptance probability of every column and the genome that takes the rest
+    double *mProbabilities;
+    unsigned *mAliases;
+};
@@ -0,0 +1,39 @@
+
+#include "Arena.h"
+
+Arena::Arena(size_t capacity)
+{
+    mBlock.reset(capacity > 0 ? new char[capacity] : nullptr);
+    mCapacity = capacity;
+    mUsed = 0;
+    mOverflowSize = 0;
+}
+
+void Arena::Reset()
+{
+    if (!mOverflow.empty())
+    {
+        mCapacity += mOverflowSize;
+        mBlock.reset(new char[mCapacity]);
+        mOverflow.clear();
+        mOverflowSize = 0;
+    }
+
+    mUsed = 0;
+}
+
+void *Arena::AllocateBytes(size_t size, size_t alignment)
+{
+    //new[] aligns the block for any fundamental type, so aligning the offset aligns the address
+    size_t offset = (mUsed + alignment - 1) / alignment * alignment;
+    if (mBlock && offset + size <= mCapacity)
+    {
+        mUsed = offset + size;
+        return mBlock.get() + offset;
+    }
+
+    //A block of its own (aligned by new[] too), Reset folds it into the main block with room for the alignment
+    mOverflow.push_back(std::unique_ptr<char[]>(new char[size > 0 ? size : 1]));
+    mOverflowSize += size + alignment;
+    return mOverflow.back().get();
+}
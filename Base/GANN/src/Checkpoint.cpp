@@ -0,0 +1,259 @@
+
+#include "Checkpoint.h"
+#include "ModelFile.h"
+#include "Selection.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+using namespace CheckpointFormat;
+
+namespace
+{
+    bool ReadFile(const std::string &filename, std::vector<char> &buffer)
+    {
+        std::ifstream file(filename.c_str(), std::ios::binary | std::ios::ate);
+        if (!file.is_open())
+            return false;
+
+        buffer.resize((size_t)file.tellg());
+        file.seekg(0);
+        return file.read(buffer.data(), buffer.size()).good();
+    }
+
+    //Header of a checkpoint file, false if the file is not valid
+    bool ReadHeader(const std::vector<char> &buffer, Header &header)
+    {
+        if (buffer.size() < sizeof(Header))
+            return false;
+
+        memcpy(&header, buffer.data(), sizeof(header));
+        if (memcmp(header.Magic, Magic, sizeof(Magic)) != 0 || header.Version != Version ||
+            header.DataType > BinaryDatasetFormat::Float32 || header.SelectionMethod > Selector::Tournament ||
+            header.TournamentSize == 0 || header.FileSize != buffer.size())
+        {
+            return false;
+        }
+
+        uint64_t genomeSize = (uint64_t)header.ChromosomeLength * BinaryDatasetFormat::GetDataTypeSize((DataType)header.DataType) + sizeof(double);
+        if (sizeof(Header) + header.NumGenomes * genomeSize != header.FileSize)
+            return false;
+
+        return ModelFileFormat::Crc32(buffer.data() + sizeof(Header), buffer.size() - sizeof(Header)) == header.Checksum;
+    }
+
+    //Copies the genomes of the file into the checkpoint, converting the genes to T
+    template <typename T>
+    void ReadGenomes(const std::vector<char> &buffer, const Header &header, GACheckpointT<T> &checkpoint)
+    {
+        const char *bits = buffer.data() + sizeof(Header);
+        size_t numGenes = (size_t)header.NumGenomes * header.ChromosomeLength;
+        const char *fitness = bits + numGenes * BinaryDatasetFormat::GetDataTypeSize((DataType)header.DataType);
+
+        checkpoint.ChromosomeLength = header.ChromosomeLength;
+        checkpoint.Bits.resize(numGenes);
+        if (header.DataType == BinaryDatasetFormat::DataTypeOf<T>::Value)
+            memcpy(checkpoint.Bits.data(), bits, numGenes * sizeof(T));
+        else if (header.DataType == BinaryDatasetFormat::Float32)
+        {
+            for (size_t i = 0; i < numGenes; i++)
+                checkpoint.Bits[i] = (T)((const float *)bits)[i];
+        }
+        else
+        {
+            for (size_t i = 0; i < numGenes; i++)
+                checkpoint.Bits[i] = (T)((const double *)bits)[i];
+        }
+
+        checkpoint.Fitness.resize(header.NumGenomes);
+        memcpy(checkpoint.Fitness.data(), fitness, header.NumGenomes * sizeof(double));
+    }
+
+    template <typename T>
+    void ReadState(const Header &header, GACheckpointT<T> &checkpoint)
+    {
+        checkpoint.Generation = header.Generation;
+        checkpoint.Population = header.Population;
+        checkpoint.ElitismSelection = header.ElitismSelection;
+        checkpoint.FittestGenome = header.FittestGenome;
+        checkpoint.SelectionMethod = header.SelectionMethod;
+        checkpoint.TournamentSize = header.TournamentSize;
+        checkpoint.CrossoverRate = header.CrossoverRate;
+        checkpoint.MutationRate = header.MutationRate;
+        checkpoint.MaxPerturbation = header.MaxPerturbation;
+        checkpoint.BestFitnessScore = header.BestFitnessScore;
+        checkpoint.TotalFitnessScore = header.TotalFitnessScore;
+        memcpy(checkpoint.RandomState, header.RandomState, sizeof(checkpoint.RandomState));
+    }
+
+    //The file is written next to the old one and then replaces it, a crash never leaves half a checkpoint behind
+    bool ReplaceFile(const std::string &filename, const std::vector<char> &buffer)
+    {
+        std::string temporary = filename + ".tmp";
+        {
+            std::ofstream file(temporary.c_str(), std::ios::binary | std::ios::trunc);
+            if (!file.write(buffer.data(), buffer.size()))
+                return false;
+        }
+
+        //rename does not overwrite on Windows
+        std::remove(filename.c_str());
+        return std::rename(temporary.c_str(), filename.c_str()) == 0;
+    }
+}
+
+namespace Checkpoint
+{
+    template <typename T>
+    bool Write(const std::string &filename, const GACheckpointT<T> &checkpoint)
+    {
+        unsigned numGenomes = checkpoint.GetNumGenomes();
+        unsigned length = checkpoint.ChromosomeLength;
+        size_t bitsSize = (size_t)numGenomes * length * sizeof(T);
+
+        std::vector<char> buffer(sizeof(Header) + bitsSize + numGenomes * sizeof(double));
+        char *data = buffer.data() + sizeof(Header);
+        memcpy(data, checkpoint.Bits.data(), bitsSize);
+        memcpy(data + bitsSize, checkpoint.Fitness.data(), numGenomes * sizeof(double));
+
+        Header header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.Magic, Magic, sizeof(Magic));
+        header.Version = Version;
+        header.DataType = BinaryDatasetFormat::DataTypeOf<T>::Value;
+        header.Generation = checkpoint.Generation;
+        header.NumGenomes = numGenomes;
+        header.ChromosomeLength = length;
+        header.Population = checkpoint.Population;
+        header.ElitismSelection = checkpoint.ElitismSelection;
+        header.FittestGenome = checkpoint.FittestGenome;
+        header.SelectionMethod = checkpoint.SelectionMethod;
+        header.TournamentSize = checkpoint.TournamentSize;
+        header.CrossoverRate = checkpoint.CrossoverRate;
+        header.MutationRate = checkpoint.MutationRate;
+        header.MaxPerturbation = checkpoint.MaxPerturbation;
+        header.BestFitnessScore = checkpoint.BestFitnessScore;
+        header.TotalFitnessScore = checkpoint.TotalFitnessScore;
+        memcpy(header.RandomState, checkpoint.RandomState, sizeof(header.RandomState));
+        header.FileSize = buffer.size();
+        header.Checksum = ModelFileFormat::Crc32(buffer.data() + sizeof(Header), buffer.size() - sizeof(Header));
+        memcpy(buffer.data(), &header, sizeof(header));
+
+        return ReplaceFile(filename, buffer);
+    }
+
+    template <typename T>
+    bool Load(const std::string &prefix, GACheckpointT<T> &checkpoint)
+    {
+        std::vector<char> buffer;
+        Header header;
+        if (!ReadFile(prefix + ".ckpt", buffer) || !ReadHeader(buffer, header))
+            return false;
+
+        ReadState(header, checkpoint);
+        ReadGenomes(buffer, header, checkpoint);
+        return true;
+    }
+}
+
+template <typename T>
+CheckpointWriterT<T>::CheckpointWriterT()
+{
+    mFailed = 0;
+    mHasPending = false;
+    mBusy = false;
+    mStop = false;
+}
+
+template <typename T>
+CheckpointWriterT<T>::~CheckpointWriterT()
+{
+    Close();
+}
+
+template <typename T>
+bool CheckpointWriterT<T>::Open(const std::string &prefix)
+{
+    Close();
+
+    mPrefix = prefix;
+    mFailed = 0;
+    mHasPending = false;
+    mBusy = false;
+    mStop = false;
+    mThread = std::thread(&CheckpointWriterT<T>::WriteCheckpoints, this);
+
+    return true;
+}
+
+template <typename T>
+void CheckpointWriterT<T>::Close()
+{
+    if (!mThread.joinable())
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStop = true;
+    }
+    mCondition.notify_all();
+    mThread.join();
+}
+
+template <typename T>
+void CheckpointWriterT<T>::Submit(GACheckpointT<T> &checkpoint)
+{
+    {
+        //Only the vectors' pointers change hands under the lock
+        std::lock_guard<std::mutex> lock(mMutex);
+        std::swap(mPending, checkpoint);
+        mHasPending = true;
+    }
+    mCondition.notify_all();
+}
+
+template <typename T>
+void CheckpointWriterT<T>::Flush()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    mCondition.wait(lock, [&]() { return !mHasPending && !mBusy; });
+}
+
+template <typename T>
+void CheckpointWriterT<T>::WriteCheckpoints()
+{
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mCondition.wait(lock, [&]() { return mStop || mHasPending; });
+
+            //Stopping still writes the last checkpoint submitted
+            if (!mHasPending)
+                break;
+
+            std::swap(mPending, mWriting);
+            mHasPending = false;
+            mBusy = true;
+        }
+
+        bool written = Checkpoint::Write(mPrefix + ".ckpt", mWriting);
+
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            if (!written)
+                mFailed++;
+            mBusy = false;
+        }
+        mCondition.notify_all();
+    }
+}
+
+template bool Checkpoint::Write(const std::string &filename, const GACheckpointT<double> &checkpoint);
+template bool Checkpoint::Write(const std::string &filename, const GACheckpointT<float> &checkpoint);
+
+template bool Checkpoint::Load(const std::string &prefix, GACheckpointT<double> &checkpoint);
+template bool Checkpoint::Load(const std::string &prefix, GACheckpointT<float> &checkpoint);
+
+template class CheckpointWriterT<double>;
+template class CheckpointWriterT<float>;
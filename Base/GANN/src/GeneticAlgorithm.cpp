@@ -1,107 +1,181 @@
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <string>
 
 #include "GeneticAlgorithm.h"
+#include "ModelFile.h"
 
-float RandFloat()
+void GetNextInputs(unsigned amount, std::vector<double> &inputs)
 {
-    return rand() / float(RAND_MAX);
+    inputs.clear();
+
+    Random &random = Random::GetThreadRandom();
+    for (unsigned i = 0; i < amount; i++)
+        inputs.push_back((double)random.NextUnsigned(2));
 }
 
-float RandFloatClamped()
+void ShowVectorVals(std::string label, const std::vector<Gene> &v)
 {
-    return (rand() / float(RAND_MAX)) * 2.0f - 1.0f;
+    std::cout << label << " ";
+    for (unsigned i = 0; i < v.size(); i++)
+        std::cout << v[i] << " ";
+
+    std::cout << std::endl;
 }
 
-int RandInt(int min, int max)
+double GetTargetOutputs(const Gene *input)
 {
-    return (rand() % (max - min)) + min;
+    double a = input[0];
+    double b = input[1];
+
+    if (a == b) return 0.0;
+    return 1.0;
 }
 
-void GetNextInputs(unsigned amount, std::vector<double> &inputs)
+void GetPopulationPerformance(GenePopulation &population, std::vector<double> &fitness)
 {
-    inputs.clear();
+    unsigned cases = 4;
+    fitness.assign(population.GetNumGenomes(), 0.0);
 
-    for (unsigned i = 0; i < amount; i++)
+    for (unsigned i = 0; i < cases; i++)
     {
-        unsigned random = rand() % 2;
-        inputs.push_back((double)random);
+        //Every genome gets the same combination of two binary inputs
+        Gene inputVals[2];
+        inputVals[0] = (i & 2) ? (Gene)1 : (Gene)0;
+        inputVals[1] = (i & 1) ? (Gene)1 : (Gene)0;
+        double targetVal = GetTargetOutputs(inputVals);
+
+        population.SetInputs(inputVals);
+        population.FeedForward();
+
+        const Gene *outputVals = population.GetResults(0);
+        for (unsigned genome = 0; genome < fitness.size(); genome++)
+            fitness[genome] += 1.0 - std::fabs(targetVal - outputVals[genome]);
     }
+
+    for (unsigned genome = 0; genome < fitness.size(); genome++)
+        fitness[genome] /= (double)cases;
 }
 
-GA::GA()
+double GetNetworkPerformance(GeneNetwork &network, bool debug)
 {
+    unsigned cases = 4;
+
+    std::vector<Gene> inputVals, resultVals;
+    double outputVal, targetVal, fitness = 0.0;
+
+    for (unsigned i = 0; i < cases; i++)
+    {
+        //Every combination of two binary inputs
+        inputVals.clear();
+        inputVals.push_back((i & 2) ? (Gene)1 : (Gene)0);
+        inputVals.push_back((i & 1) ? (Gene)1 : (Gene)0);
+
+        network.FeedForward(inputVals);
+        network.GetResults(resultVals);
+
+        outputVal = resultVals[0];
+        targetVal = GetTargetOutputs(inputVals.data());
+
+        fitness += 1.0 - std::fabs(targetVal - outputVal);
+
+        if (debug)
+        {
+            ShowVectorVals("Inputs: ", inputVals);
+            ShowVectorVals("Outputs: ", resultVals);
+            std::cout << "Target: " << targetVal << " Fitness: " << 1.0 - std::fabs(targetVal - outputVal) << std::endl;
+        }
+    }
+
+    fitness /= (double)cases;
+
+    return fitness;
+}
+
+//The arena starts big enough for the scratch of a usual generation, the first one does not have to grow it
+GA::GA(unsigned population, uint64_t seed) : mArena(4096), mPopulation(population), mRandom(seed), mThreadPool(new ThreadPool())
+{
+    //Past the thread streams of the same seed (Random::SetRunSeed), the networks never draw the numbers of the operators
+    mRandom.LongJump();
     CreateStartPopulation();
 }
 
-GA::~GA() {}
+GA::~GA()
+{
+    mCheckpointWriter.Close();
+}
 
 void GA::Epoch()
 {
     UpdateFitnessScore();
 
-    unsigned newChilds = 0;
-    std::vector<SGenome> childGenomes;
+    //The elite and pairs of children up to the population size (one extra child when the pairs do not fit)
+    unsigned numChildren = mPopulation > mElitismSelection ? (mPopulation - mElitismSelection + 1) / 2 * 2 : 0;
+    mNextGenomes.Resize(mElitismSelection + numChildren, mChromosomeLenght);
 
     //Elitism selection (select the best genomes for the next generation)
-    ElitismSelection(mElitismSelection, childGenomes);
+    ElitismSelection(mElitismSelection, mNextGenomes);
+
+    //Two parents per pair of children, all of them drawn at once
+    unsigned *parents = mArena.Allocate<unsigned>(numChildren);
+    SelectParents(parents, numChildren);
 
-    while (childGenomes.size() < mPopulation)
+    for (unsigned child = mElitismSelection; child < mNextGenomes.GetNumGenomes(); child += 2)
     {
-        //Select two parents
-        SGenome mom = RouleteWheelSelection();
-        SGenome dad = RouleteWheelSelection();
+        //The parents are read in place from the current generation
+        const Gene *mom = mGenomes.GetChromosome(parents[child - mElitismSelection]);
+        const Gene *dad = mGenomes.GetChromosome(parents[child - mElitismSelection + 1]);
 
-        //Crossover the parents chromosome data
-        SGenome child1, child2;
-        Crossover(mom.Bits, dad.Bits, child1.Bits, child2.Bits);
+        //Crossover the parents chromosome data straight into the rows of the children
+        Gene *child1 = mNextGenomes.GetChromosome(child);
+        Gene *child2 = mNextGenomes.GetChromosome(child + 1);
+        Crossover(mom, dad, child1, child2);
 
         //Operate a mutation chance
-        Mutate(child1.Bits);
-        Mutate(child2.Bits);
-
-        //Update the NN weights with the new ones obtained from crossover and mutation
-        UpdateWeights(child1);
-        UpdateWeights(child2);
-
-        //Add the new childs to the new population
-        childGenomes.push_back(child1);
-        childGenomes.push_back(child2);
+        Mutate(child1);
+        Mutate(child2);
 
-        newChilds += 2;
+        mNextGenomes.SetFitness(child, 0.0);
+        mNextGenomes.SetFitness(child + 1, 0.0);
     }
-    //Change the old population with the new one
-    mGenomes = childGenomes;
+    //Change the old population with the new one, the old buffers hold the next generation
+    mGenomes.Swap(mNextGenomes);
 
     //Increment the generation counter
     mGeneration++;
-    std::cout << "\nNew generation: " << mGeneration << std::endl;
+    if (mVerbose)
+        std::cout << "\nNew generation: " << mGeneration << std::endl;
+
+    //Epoch copies the population once into buffers that change hands with the checkpoint thread, which writes them
+    if (mCheckpointInterval > 0 && mGeneration % mCheckpointInterval == 0)
+    {
+        SaveCheckpoint(mCheckpoint);
+        mCheckpointWriter.Submit(mCheckpoint);
+    }
 }
 
-void GA::Mutate(std::vector<double> &chromosome)
+void GA::Mutate(Gene *chromosome)
 {
-    //Traverse the weight vector and mutate each weight dependent on the mutation rate
-    for (unsigned i = 0; i < chromosome.size(); i++)
+    //The mutation chance of every weight drawn at once, then only the mutated ones draw their perturbation
+    mRandom.FillUniform(mMutationDraws.data(), mChromosomeLenght, 0.0f, 1.0f);
+    for (unsigned i = 0; i < mChromosomeLenght; i++)
     {
         //do we perturb this chromosome?
-        if (RandFloat() < mMutationRate)
+        if (mMutationDraws[i] < mMutationRate)
         {
-            float a = RandFloatClamped();
             //add or subtract a small value to the weight
-            chromosome[i] += (RandFloatClamped() * mMaxPerturbation);
+            chromosome[i] += (Gene)(RandFloatClamped() * mMaxPerturbation);
         }
     }
 }
 
-void GA::Crossover(const std::vector<double> &mom, const std::vector<double> &dad, std::vector<double> &child1, std::vector<double> &child2)
+void GA::Crossover(const Gene *mom, const Gene *dad, Gene *child1, Gene *child2)
 {
-    child1.clear();
-    child2.clear();
-
-    if ((RandFloat() > mCrossoverRate) || (mom == dad))
+    if ((RandFloat() > mCrossoverRate) || std::equal(mom, mom + mChromosomeLenght, dad))
     {
-        child1 = mom;
-        child2 = dad;
+        std::copy(mom, mom + mChromosomeLenght, child1);
+        std::copy(dad, dad + mChromosomeLenght, child2);
         return;
     }
 
@@ -109,120 +183,194 @@ void GA::Crossover(const std::vector<double> &mom, const std::vector<double> &da
     unsigned crossoverPoint = RandInt(0, mChromosomeLenght - 1);
     for (unsigned i = 0; i < crossoverPoint; i++)
     {
-        child1.push_back(mom[i]);
-        child2.push_back(dad[i]);
+        child1[i] = mom[i];
+        child2[i] = dad[i];
     }
 
     //Get the second part of the genome
-    for (unsigned i = crossoverPoint; i < mom.size(); i++)
+    for (unsigned i = crossoverPoint; i < mChromosomeLenght; i++)
     {
-        child1.push_back(dad[i]);
-        child2.push_back(mom[i]);
+        child1[i] = dad[i];
+        child2[i] = mom[i];
     }
 }
 
-SGenome& GA::RouleteWheelSelection()
+void GA::SelectParents(unsigned *parents, unsigned count)
 {
-    double slice = RandFloat() * mTotalFitnessScore;
-    double total = 0;
-    unsigned selectedGenome = 0;
-
-    for (unsigned i = 0; i < mPopulation; i++)
-    {
-        total += mGenomes[i].Fitness;
-
-        if (total > slice)
-        {
-            selectedGenome = i;
-            break;
-        }
-    }
-
-    return mGenomes[selectedGenome];
+    mSelector.SelectBatch(mRandom, parents, count);
 }
 
-void GA::ElitismSelection(unsigned amount, std::vector <SGenome> &genomes)
+void GA::ElitismSelection(unsigned amount, GenePopulationStore &genomes)
 {
-    unsigned selectedGenome = 0;
+    unsigned *elite = mArena.Allocate<unsigned>(amount);
+    Selector::SelectElite(mGenomes.GetFitnessValues(), mGenomes.GetNumGenomes(), amount, elite, mArena);
 
     for (unsigned j = 0; j < amount; j++)
     {
-        double bestFit = 0.0;
-        bool valid = true;
-        for (unsigned i = 0; i < mGenomes.size(); i++)
-        {
-            if (mGenomes[i].Fitness > bestFit)
-            {
-                for (unsigned k = 0; k < genomes.size(); k++)
-                {
-                    if (genomes[k].Fitness == mGenomes[i].Fitness)
-                        valid = false; break;
-                }
-
-                if (valid)
-                {
-                    bestFit = mGenomes[i].Fitness;
-                    selectedGenome = i;
-                }
-            }
-        }
-        genomes.push_back(mGenomes[selectedGenome]);
+        const Gene *bits = mGenomes.GetChromosome(elite[j]);
+        std::copy(bits, bits + mChromosomeLenght, genomes.GetChromosome(j));
+        genomes.SetFitness(j, mGenomes.GetFitness(elite[j]));
     }
 }
 
 void GA::UpdateFitnessScore()
 {
+    //A new generation, the scratch of the last one is not needed anymore
+    mArena.Reset();
+
     //Update the total combined fitness of all the genomes (for the roulete wheel selection)
     mTotalFitnessScore = 0;
     mBestFitnessScore = 0;
 
-    //Check the NN performance and update the fitness of each genome
-    for (unsigned i = 0; i < mGenomes.size(); i++)
+    //One population network per block of genomes (an odd population can end with an extra child)
+    unsigned numGenomes = mGenomes.GetNumGenomes();
+    unsigned numBlocks = (numGenomes + FitnessBlockSize - 1) / FitnessBlockSize;
+    if (mFitnessBlocks.empty() || mFitnessBlocks.back().FirstGenome + mFitnessBlocks.back().Network.GetNumGenomes() != numGenomes)
     {
-        //Check the NN performance
-        mGenomes[i].Fitness = mGenomes[i].NNetwork->GetNetworkPerformance(false);
-        mTotalFitnessScore += mGenomes[i].Fitness;
+        mFitnessBlocks.clear();
+        for (unsigned blockIdx = 0; blockIdx < numBlocks; blockIdx++)
+        {
+            unsigned firstGenome = blockIdx * FitnessBlockSize;
+            mFitnessBlocks.push_back(FitnessBlock(firstGenome, std::min(FitnessBlockSize, numGenomes - firstGenome)));
+        }
+    }
 
-        //std::cout << " Fitness: " << mGenomes[i].Fitness << std::endl;
+    //Check the NN performance of every block at once, the blocks are spread over the threads
+    mThreadPool->Run(numBlocks, [this](unsigned blockIdx) { EvaluateBlock(mFitnessBlocks[blockIdx]); });
 
-        if (mGenomes[i].Fitness > mBestFitnessScore)
+    //Update the fitness of each genome, in genome order
+    for (unsigned i = 0; i < numGenomes; i++)
+    {
+        const FitnessBlock &block = mFitnessBlocks[i / FitnessBlockSize];
+        mGenomes.SetFitness(i, block.Fitness[i - block.FirstGenome]);
+        mTotalFitnessScore += mGenomes.GetFitness(i);
+
+        //std::cout << " Fitness: " << mGenomes.GetFitness(i) << std::endl;
+
+        if (mGenomes.GetFitness(i) > mBestFitnessScore)
         {
             mFittestGenome = i;
-            mBestFitnessScore = mGenomes[i].Fitness;
-            std::cout << "Fitness record: " << mBestFitnessScore << " from genome: " << mFittestGenome << std::endl;;
+            mBestFitnessScore = mGenomes.GetFitness(i);
+            if (mVerbose)
+                std::cout << "Fitness record: " << mBestFitnessScore << " from genome: " << mFittestGenome << std::endl;;
         }
     }
+
+    //Built once for every parent of the generation
+    mSelector.Prepare(mGenomes.GetFitnessValues(), numGenomes, mArena);
+}
+
+void GA::EvaluateBlock(FitnessBlock &block)
+{
+    //Only reads the genomes of the block, the other tasks do not write anything this one reads
+    for (unsigned i = 0; i < block.Network.GetNumGenomes(); i++)
+        block.Network.SetGenomeWeights(i, mGenomes.GetChromosome(block.FirstGenome + i));
+
+    GetPopulationPerformance(block.Network, block.Fitness);
+}
+
+void GA::SetSelection(Selector::Method method, unsigned tournamentSize)
+{
+    mSelector.SetMethod(method, tournamentSize);
 }
 
-void GA::UpdateWeights(SGenome &genome)
+void GA::SetNumThreads(unsigned numThreads)
 {
-    genome.NNetwork->SetConnectionWeights(genome.Bits);
+    mThreadPool.reset(new ThreadPool(numThreads));
 }
 
 void GA::CreateStartPopulation()
 {
-    for(unsigned i = 0; i < mPopulation; i++)
-        mGenomes.push_back(SGenome());
+    mChromosomeLenght = GeneNetwork::NumWeights;
+    mGenomes.Resize(mPopulation, mChromosomeLenght);
+    mMutationDraws.resize(mChromosomeLenght);
 
-    mChromosomeLenght = (unsigned)mGenomes[0].Bits.size();
+    //Random weights of a new network for every genome ([0...1) like the networks draw them), all at once from the seed of the GA
+    mRandom.FillUniform(mGenomes.GetBits(), (size_t)mPopulation * mChromosomeLenght, (Gene)0.0, (Gene)1.0);
+    for (unsigned i = 0; i < mPopulation; i++)
+        mGenomes.SetFitness(i, 0.0);
 }
 
 void GA::TestFittestGenome()
 {
-    double fitness = mGenomes[mFittestGenome].NNetwork->GetNetworkPerformance(true);
+    GeneNetwork network(mGenomes.GetChromosome(mFittestGenome));
+
+    double fitness = GetNetworkPerformance(network, true);
     std::cout << "Total Fitness: " << fitness << std::endl;
 }
 
-SGenome::SGenome()
+bool GA::SaveFittestGenome(const std::string &filename) const
 {
-    Fitness = 0.0;
+    GeneNetwork network(mGenomes.GetChromosome(mFittestGenome));
+
+    std::vector<Gene> weights;
+    network.GetConnectionWeights(weights);
+
+    //Same bias neuron output (-1) as Network, the model loads straight into one
+    return ModelFile::Save(filename, GeneNetwork::GetTopology(), network.GetActivation(), -1, weights);
+}
 
-    std::vector<unsigned> topology;
-    topology.push_back(2);
-    topology.push_back(2);
-    topology.push_back(1);
+bool GA::EnableCheckpoints(const std::string &prefix, unsigned interval)
+{
+    if (interval == 0 || !mCheckpointWriter.Open(prefix))
+        return false;
 
-    NNetwork = new Network(topology);
+    mCheckpointInterval = interval;
+    return true;
+}
 
-    NNetwork->GetConnectionWeights(Bits);
+void GA::FlushCheckpoints()
+{
+    mCheckpointWriter.Flush();
+}
+
+bool GA::Resume(const std::string &prefix)
+{
+    GACheckpoint checkpoint;
+    if (!Checkpoint::Load(prefix, checkpoint) || checkpoint.ChromosomeLength != mChromosomeLenght || checkpoint.GetNumGenomes() == 0)
+        return false;
+
+    LoadCheckpoint(checkpoint);
+    return true;
+}
+
+void GA::SaveCheckpoint(GACheckpoint &checkpoint) const
+{
+    checkpoint.Generation = mGeneration;
+    checkpoint.Population = mPopulation;
+    checkpoint.ElitismSelection = mElitismSelection;
+    checkpoint.FittestGenome = mFittestGenome;
+    checkpoint.SelectionMethod = mSelector.GetMethod();
+    checkpoint.TournamentSize = mSelector.GetTournamentSize();
+    checkpoint.CrossoverRate = mCrossoverRate;
+    checkpoint.MutationRate = mMutationRate;
+    checkpoint.MaxPerturbation = mMaxPerturbation;
+    checkpoint.BestFitnessScore = mBestFitnessScore;
+    checkpoint.TotalFitnessScore = mTotalFitnessScore;
+    mRandom.GetState(checkpoint.RandomState);
+
+    //Same layout as the store, one copy of each matrix
+    unsigned numGenomes = mGenomes.GetNumGenomes();
+    checkpoint.ChromosomeLength = mChromosomeLenght;
+    checkpoint.Bits.assign(mGenomes.GetBits(), mGenomes.GetBits() + (size_t)numGenomes * mChromosomeLenght);
+    checkpoint.Fitness.assign(mGenomes.GetFitnessValues(), mGenomes.GetFitnessValues() + numGenomes);
+}
+
+void GA::LoadCheckpoint(const GACheckpoint &checkpoint)
+{
+    mGeneration = checkpoint.Generation;
+    mPopulation = checkpoint.Population;
+    mElitismSelection = checkpoint.ElitismSelection;
+    mFittestGenome = checkpoint.FittestGenome;
+    mSelector.SetMethod((Selector::Method)checkpoint.SelectionMethod, checkpoint.TournamentSize);
+    mCrossoverRate = checkpoint.CrossoverRate;
+    mMutationRate = checkpoint.MutationRate;
+    mMaxPerturbation = checkpoint.MaxPerturbation;
+    mBestFitnessScore = checkpoint.BestFitnessScore;
+    mTotalFitnessScore = checkpoint.TotalFitnessScore;
+    mRandom.SetState(checkpoint.RandomState);
+
+    mGenomes.Resize(checkpoint.GetNumGenomes(), mChromosomeLenght);
+    std::copy(checkpoint.Bits.begin(), checkpoint.Bits.end(), mGenomes.GetBits());
+    std::copy(checkpoint.Fitness.begin(), checkpoint.Fitness.end(), mGenomes.GetFitnessValues());
 }
\ No newline at end of file
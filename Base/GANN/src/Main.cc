@@ -1,25 +1,108 @@
+#include <cstdlib>
 #include <vector>
 #include <iostream>
+#include <string>
 #include <time.h> 
 
 #include "GeneticAlgorithm.h"
 
-int main()
+int main(int argc, char *argv[])
 {
-    srand((unsigned)time(NULL));
+    //--save file writes the fittest network as a model file once the evolution ends
+    //--generations n evolves until generation n (200 by default)
+    //--seed n seed of the genetic operators (the current time by default)
+    //--checkpoint prefix writes a checkpoint of the run every --checkpoint-interval generations (10 by default)
+    //--resume prefix continues the run of the checkpoints of prefix
+    //--selection name draws the parents with the roulette wheel (the default), an alias table or tournaments
+    //--tournament k genomes of every tournament (2 by default)
+    //A resumed run keeps the selection of its checkpoint, --selection and --tournament must match it if given
+    //--threads n evaluates the fitness on n threads (0 for every core, the default), the run is the same for any n
+    std::string saveFile, checkpointPrefix, resumePrefix;
+    unsigned generations = 200;
+    unsigned checkpointInterval = 10;
+    unsigned numThreads = 0;
+    Selector::Method selection = Selector::Roulette;
+    unsigned tournamentSize = 2;
+    bool selectionGiven = false, tournamentGiven = false;
+    unsigned seed = (unsigned)time(NULL);
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::string(argv[i]) == "--save" && i + 1 < argc)
+            saveFile = argv[++i];
+        else if (std::string(argv[i]) == "--generations" && i + 1 < argc)
+            generations = (unsigned)atoi(argv[++i]);
+        else if (std::string(argv[i]) == "--seed" && i + 1 < argc)
+            seed = (unsigned)atoi(argv[++i]);
+        else if (std::string(argv[i]) == "--checkpoint" && i + 1 < argc)
+            checkpointPrefix = argv[++i];
+        else if (std::string(argv[i]) == "--checkpoint-interval" && i + 1 < argc)
+            checkpointInterval = (unsigned)atoi(argv[++i]);
+        else if (std::string(argv[i]) == "--resume" && i + 1 < argc)
+            resumePrefix = argv[++i];
+        else if (std::string(argv[i]) == "--selection" && i + 1 < argc)
+        {
+            if (!Selector::ParseMethod(argv[++i], selection))
+            {
+                std::cout << "Invalid selection " << argv[i] << std::endl;
+                return 1;
+            }
+            selectionGiven = true;
+        }
+        else if (std::string(argv[i]) == "--tournament" && i + 1 < argc)
+        {
+            tournamentSize = (unsigned)atoi(argv[++i]);
+            tournamentGiven = true;
+        }
+        else if (std::string(argv[i]) == "--threads" && i + 1 < argc)
+            numThreads = (unsigned)atoi(argv[++i]);
+    }
 
-    GA ga;
-    int trainingPass = 0;
+    //Networks built outside the GA draw from the thread streams of the same seed, the GA from a stream past them
+    Random::SetRunSeed(seed);
 
-    while (trainingPass < 200)
+    GA ga(50, seed);
+    if (numThreads > 0)
+        ga.SetNumThreads(numThreads);
+    ga.SetSelection(selection, tournamentSize);
+    if (!resumePrefix.empty())
     {
-        trainingPass++;
+        if (!ga.Resume(resumePrefix))
+        {
+            std::cout << "Could not resume from " << resumePrefix << std::endl;
+            return 1;
+        }
+        if ((selectionGiven && ga.GetSelection() != selection) ||
+            (tournamentGiven && ga.GetSelection() == Selector::Tournament && ga.GetTournamentSize() != tournamentSize))
+        {
+            std::cout << "Invalid selection for " << resumePrefix << ", the run uses " << Selector::GetMethodName(ga.GetSelection());
+            if (ga.GetSelection() == Selector::Tournament)
+                std::cout << " " << ga.GetTournamentSize();
+            std::cout << std::endl;
+            return 1;
+        }
+        std::cout << "Resumed from generation " << ga.GetGeneration() << " (" << Selector::GetMethodName(ga.GetSelection()) << " selection)" << std::endl;
+    }
 
-        ga.Epoch();
+    if (!checkpointPrefix.empty() && !ga.EnableCheckpoints(checkpointPrefix, checkpointInterval))
+    {
+        std::cout << "Invalid checkpoint interval " << checkpointInterval << std::endl;
+        return 1;
     }
 
+    while (ga.GetGeneration() < generations)
+        ga.Epoch();
+
+    ga.FlushCheckpoints();
     ga.TestFittestGenome();
 
+    if (!saveFile.empty())
+    {
+        if (ga.SaveFittestGenome(saveFile))
+            std::cout << "Fittest genome saved to " << saveFile << std::endl;
+        else
+            std::cout << "Could not write " << saveFile << std::endl;
+    }
+
     int a;
     std::cin >> a;
 
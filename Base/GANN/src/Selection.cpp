@@ -0,0 +1,197 @@
+
+#include "Selection.h"
+#include <algorithm>
+
+Selector::Selector()
+{
+    mMethod = Roulette;
+    mTournamentSize = 2;
+    mFitness = nullptr;
+    mNumGenomes = 0;
+    mPrefixSums = nullptr;
+    mProbabilities = nullptr;
+    mAliases = nullptr;
+}
+
+void Selector::SetMethod(Method method, unsigned tournamentSize)
+{
+    mMethod = method;
+    mTournamentSize = std::max(tournamentSize, 1u);
+}
+
+void Selector::Prepare(const double *fitness, unsigned numGenomes, Arena &arena)
+{
+    mFitness = fitness;
+    mNumGenomes = numGenomes;
+
+    if (mMethod == Roulette)
+    {
+        //Added in genome order, the same sums as the linear scan of the wheel
+        mPrefixSums = arena.Allocate<double>(numGenomes);
+        double total = 0.0;
+        for (unsigned i = 0; i < numGenomes; i++)
+        {
+            total += fitness[i];
+            mPrefixSums[i] = total;
+        }
+    }
+    else if (mMethod == Alias)
+    {
+        mProbabilities = arena.Allocate<double>(numGenomes);
+        mAliases = arena.Allocate<unsigned>(numGenomes);
+
+        double total = 0.0;
+        for (unsigned i = 0; i < numGenomes; i++)
+            total += fitness[i];
+
+        //Fitness scaled so the average column is 1, a population without fitness is drawn uniformly
+        unsigned *small = arena.Allocate<unsigned>(numGenomes);
+        unsigned *large = arena.Allocate<unsigned>(numGenomes);
+        unsigned numSmall = 0, numLarge = 0;
+        for (unsigned i = 0; i < numGenomes; i++)
+        {
+            mProbabilities[i] = total > 0.0 ? fitness[i] * numGenomes / total : 1.0;
+            mAliases[i] = i;
+            if (mProbabilities[i] < 1.0)
+                small[numSmall++] = i;
+            else
+                large[numLarge++] = i;
+        }
+
+        //Every short column is topped up by a tall one, which shrinks by the same amount
+        while (numSmall > 0 && numLarge > 0)
+        {
+            unsigned less = small[--numSmall];
+            unsigned more = large[numLarge - 1];
+            mAliases[less] = more;
+            mProbabilities[more] -= 1.0 - mProbabilities[less];
+            if (mProbabilities[more] < 1.0)
+            {
+                numLarge--;
+                small[numSmall++] = more;
+            }
+        }
+
+        //What is left is full up to rounding errors
+        while (numSmall > 0)
+            mProbabilities[small[--numSmall]] = 1.0;
+        while (numLarge > 0)
+            mProbabilities[large[--numLarge]] = 1.0;
+    }
+}
+
+unsigned Selector::Select(Random &random)
+{
+    unsigned genome;
+    SelectBatch(random, &genome, 1);
+    return genome;
+}
+
+void Selector::SelectBatch(Random &random, unsigned *genomes, unsigned count)
+{
+    //One loop per method, the method is not checked again for every draw
+    if (mMethod == Roulette)
+    {
+        //Rounded to float like the other draws of the GA. The first genome whose running sum passes the slice,
+        //the first genome if none does (no fitness at all)
+        double total = mNumGenomes > 0 ? mPrefixSums[mNumGenomes - 1] : 0.0;
+        for (unsigned i = 0; i < count; i++)
+        {
+            double slice = (float)random.NextDouble() * total;
+            const double *selected = std::upper_bound(mPrefixSums, mPrefixSums + mNumGenomes, slice);
+            genomes[i] = selected != mPrefixSums + mNumGenomes ? (unsigned)(selected - mPrefixSums) : 0;
+        }
+    }
+    else if (mMethod == Alias)
+    {
+        for (unsigned i = 0; i < count; i++)
+        {
+            unsigned column = random.NextUnsigned(mNumGenomes);
+            genomes[i] = random.NextDouble() < mProbabilities[column] ? column : mAliases[column];
+        }
+    }
+    else
+    {
+        //The first one drawn wins the ties
+        for (unsigned i = 0; i < count; i++)
+        {
+            unsigned best = random.NextUnsigned(mNumGenomes);
+            for (unsigned j = 1; j < mTournamentSize; j++)
+            {
+                unsigned genome = random.NextUnsigned(mNumGenomes);
+                if (mFitness[genome] > mFitness[best])
+                    best = genome;
+            }
+            genomes[i] = best;
+        }
+    }
+}
+
+void Selector::SelectElite(const double *fitness, unsigned numGenomes, unsigned amount, unsigned *elite, Arena &arena)
+{
+    if (amount == 0 || numGenomes == 0)
+        return;
+
+    //Fittest first, the lower index wins the ties: the elite does not depend on the sort implementation
+    auto fitter = [fitness](unsigned a, unsigned b) { return fitness[a] > fitness[b] || (fitness[a] == fitness[b] && a < b); };
+
+    unsigned *order = arena.Allocate<unsigned>(numGenomes);
+    for (unsigned i = 0; i < numGenomes; i++)
+        order[i] = i;
+
+    //order[0, sorted) is sorted and holds the fittest genomes. Sorted a window at a time, a window only grows
+    //(doubling) when the clones in it leave the elite short
+    unsigned count = 0;
+    unsigned sorted = 0;
+    while (count < amount && sorted < numGenomes)
+    {
+        unsigned window = std::min(numGenomes, std::max(amount, sorted * 2));
+        if (window < numGenomes)
+            std::nth_element(order + sorted, order + window, order + numGenomes, fitter);
+        std::sort(order + sorted, order + window, fitter);
+
+        //Clones are next to each other once sorted
+        for (unsigned i = sorted; i < window && count < amount; i++)
+        {
+            if (i == 0 || fitness[order[i]] != fitness[order[i - 1]])
+                elite[count++] = order[i];
+        }
+        sorted = window;
+    }
+
+    //Not enough different fitness values: the fittest clones, then the elite again if it is larger than the population
+    for (unsigned i = 1; i < numGenomes && count < amount; i++)
+    {
+        if (fitness[order[i]] == fitness[order[i - 1]])
+            elite[count++] = order[i];
+    }
+    for (unsigned i = count; i < amount; i++)
+        elite[i] = elite[i - count];
+}
+
+const char *Selector::GetMethodName(Method method)
+{
+    switch (method)
+    {
+    case Alias:
+        return "alias";
+    case Tournament:
+        return "tournament";
+    default:
+        return "roulette";
+    }
+}
+
+bool Selector::ParseMethod(const std::string &name, Method &method)
+{
+    for (int i = Roulette; i <= Tournament; i++)
+    {
+        if (name == GetMethodName((Method)i))
+        {
+            method = (Method)i;
+            return true;
+        }
+    }
+
+    return false;
+}
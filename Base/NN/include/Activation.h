@@ -0,0 +1,129 @@
+﻿//
+//  Activation.h
+//  NeuralNetwork
+//
+
+#pragma once
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+//Transfer functions a network can be built with.
+//Every function has a derivative written in terms of its output (what back propagation keeps around)
+//and an array version that runs over a whole layer at once. The array versions of everything but Tanh
+//are vector kernels (see Kernels.h); Tanh is the exact reference the approximations are measured against.
+namespace Activation
+{
+    enum Type
+    {
+        //std::tanh, output range [-1.0...1.0]
+        Tanh = 0,
+        //Rational (Pade 7/6) tanh approximation, max absolute error 1e-4
+        RationalTanh,
+        //Linear interpolation over a 4096 entries table of tanh in [-8...8], max absolute error 2e-6
+        TableTanh,
+        //1 / (1 + e^-x) as 0.5 + 0.5 * tanh(x / 2) over the tanh table, output range [0.0...1.0], max absolute error 1e-6
+        Sigmoid,
+        //max(0, x)
+        ReLU,
+        Count
+    };
+
+    //Beyond this value the rational approximation is clamped (it reaches 1.0 there)
+    const double RationalTanhLimit = 4.97;
+    const double RationalTanhNumerator[4] = { 135135.0, 17325.0, 378.0, 1.0 };
+    const double RationalTanhDenominator[4] = { 135135.0, 62370.0, 3150.0, 28.0 };
+
+    const unsigned TanhTableSize = 4096;
+    const double TanhTableLimit = 8.0;
+
+    //[TanhTableSize + 1] samples of tanh from -TanhTableLimit to TanhTableLimit, built on first use.
+    //The last sample is stored twice: the vector kernels read table[idx + 1] at the upper limit too
+    template <typename T = double>
+    inline const T *GetTanhTable()
+    {
+        static const std::vector<T> table = []()
+        {
+            std::vector<T> values(TanhTableSize + 2);
+            for (unsigned i = 0; i <= TanhTableSize; i++)
+                values[i] = (T)std::tanh(-TanhTableLimit + (2.0 * TanhTableLimit * i) / TanhTableSize);
+            values[TanhTableSize + 1] = values[TanhTableSize];
+            return values;
+        }();
+
+        return table.data();
+    }
+
+    template <typename T>
+    inline T RationalTanhValue(T x)
+    {
+        const T limit = (T)RationalTanhLimit;
+        x = x < -limit ? -limit : (x > limit ? limit : x);
+
+        T x2 = x * x;
+        T p = (T)RationalTanhNumerator[0] + x2 * ((T)RationalTanhNumerator[1] + x2 * ((T)RationalTanhNumerator[2] + x2 * (T)RationalTanhNumerator[3]));
+        T q = (T)RationalTanhDenominator[0] + x2 * ((T)RationalTanhDenominator[1] + x2 * ((T)RationalTanhDenominator[2] + x2 * (T)RationalTanhDenominator[3]));
+        T y = x * p / q;
+        return y < (T)-1 ? (T)-1 : (y > (T)1 ? (T)1 : y);
+    }
+
+    template <typename T>
+    inline T TableTanhValue(T x)
+    {
+        const double *table = GetTanhTable();
+        double position = ((double)x + TanhTableLimit) * (TanhTableSize / (2.0 * TanhTableLimit));
+        if (position <= 0.0)
+            return (T)table[0];
+        if (position >= (double)TanhTableSize)
+            return (T)table[TanhTableSize];
+
+        unsigned idx = (unsigned)position;
+        double fraction = position - idx;
+        return (T)(table[idx] + (table[idx + 1] - table[idx]) * fraction);
+    }
+
+    template <typename T>
+    inline T SigmoidValue(T x)
+    {
+        return (T)(0.5 + 0.5 * (double)TableTanhValue((T)(0.5 * (double)x)));
+    }
+
+    template <typename T>
+    inline T Apply(Type type, T x)
+    {
+        switch (type)
+        {
+        case RationalTanh: return RationalTanhValue(x);
+        case TableTanh: return TableTanhValue(x);
+        case Sigmoid: return SigmoidValue(x);
+        case ReLU: return x > (T)0 ? x : (T)0;
+        default: return std::tanh(x);
+        }
+    }
+
+    //Derivative at the point where the function returned 'y'
+    template <typename T>
+    inline T Derivative(Type type, T y)
+    {
+        switch (type)
+        {
+        case Sigmoid: return y * ((T)1 - y);
+        case ReLU: return y > (T)0 ? (T)1 : (T)0;
+        default: return (T)1 - y * y;
+        }
+    }
+
+    //values[i] = Apply(values[i]), everything but Tanh uses the vector kernels
+    void Apply(Type type, double *values, unsigned count);
+    void Apply(Type type, float *values, unsigned count);
+
+    //gradients[i] *= Derivative(outputs[i])
+    void MultiplyDerivative(Type type, const double *outputs, double *gradients, unsigned count);
+    void MultiplyDerivative(Type type, const float *outputs, float *gradients, unsigned count);
+
+    //Single word names: tanh, rational-tanh, table-tanh, sigmoid and relu
+    const char *GetName(Type type);
+    //False if name is not one of them
+    bool ParseName(const std::string &name, Type &type);
+}
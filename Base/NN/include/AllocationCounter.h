@@ -0,0 +1,17 @@
+﻿//
+//  AllocationCounter.h
+//  NeuralNetwork
+//
+
+#pragma once
+
+//Counter of heap allocations. When NN_COUNT_ALLOCATIONS is defined (the NN Debug configurations
+//and every BenchmarkSuite configuration, whose Release results report allocations per operation)
+//the global operator new counts every call with one atomic increment, so a test can check that
+//a warm network does not allocate on FeedForward plus GetResults. Without it the count stays at 0.
+namespace AllocationCounter
+{
+    bool IsEnabled();
+    //Allocations made since the program started
+    unsigned long long GetCount();
+}
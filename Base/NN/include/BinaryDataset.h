@@ -0,0 +1,140 @@
+﻿//
+//  BinaryDataset.h
+//  NeuralNetwork
+//
+
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "MappedFile.h"
+
+//Binary training set file:
+//  Header (64 bytes), topology (NumLayers x uint32),
+//  inputs [NumSamples x input neurons] and targets [NumSamples x output neurons],
+//  both matrices row-major and starting on a 64 bytes boundary.
+//Values are stored in the machine byte order (little endian on every platform we ship).
+namespace BinaryDatasetFormat
+{
+    const char Magic[4] = { 'N', 'N', 'D', 'S' };
+    const uint32_t Version = 1;
+    const unsigned Alignment = 64;
+
+    enum DataType
+    {
+        Float64 = 0,
+        Float32
+    };
+
+    struct Header
+    {
+        char Magic[4];
+        uint32_t Version;
+        uint32_t DataType;
+        uint32_t NumLayers;
+        uint64_t NumSamples;
+        //From the start of the file
+        uint64_t InputsOffset;
+        uint64_t TargetsOffset;
+        uint8_t Reserved[24];
+    };
+    static_assert(sizeof(Header) == 64, "The dataset header is 64 bytes");
+
+    template <typename T> struct DataTypeOf;
+    template <> struct DataTypeOf<double> { static const DataType Value = Float64; };
+    template <> struct DataTypeOf<float> { static const DataType Value = Float32; };
+
+    inline unsigned GetDataTypeSize(DataType dataType) { return dataType == Float32 ? 4 : 8; }
+    inline uint64_t Align(uint64_t offset) { return (offset + Alignment - 1) / Alignment * Alignment; }
+}
+
+//One sample pointing into the dataset memory
+template <typename T>
+struct SampleView
+{
+    const T *Inputs;
+    const T *Targets;
+};
+
+//Maps a binary dataset and hands out pointers into it, samples are never parsed nor copied
+class BinaryDataset
+{
+public:
+    BinaryDataset();
+    ~BinaryDataset() {}
+
+    //False if the file is missing, is not a binary dataset or is truncated
+    bool Open(const std::string &filename);
+    void Close();
+    //Checks the magic number only
+    static bool IsBinaryDataset(const std::string &filename);
+
+    inline bool IsOpen() const { return mFile.IsOpen(); }
+    inline const std::vector<unsigned> &GetTopology() const { return mTopology; }
+    inline unsigned GetNumSamples() const { return mNumSamples; }
+    inline unsigned GetNumInputs() const { return mTopology.front(); }
+    inline unsigned GetNumOutputs() const { return mTopology.back(); }
+    inline BinaryDatasetFormat::DataType GetDataType() const { return mDataType; }
+
+    //Whole matrices, nullptr unless T is the data type of the file
+    template <typename T>
+    inline const T *GetInputs() const { return IsType<T>() ? (const T *)mInputs : nullptr; }
+    template <typename T>
+    inline const T *GetTargets() const { return IsType<T>() ? (const T *)mTargets : nullptr; }
+
+    template <typename T>
+    inline SampleView<T> GetSample(unsigned index) const
+    {
+        SampleView<T> sample = { GetInputs<T>() + (size_t)index * GetNumInputs(), GetTargets<T>() + (size_t)index * GetNumOutputs() };
+        return sample;
+    }
+
+private:
+    template <typename T>
+    inline bool IsType() const { return IsOpen() && mDataType == BinaryDatasetFormat::DataTypeOf<T>::Value; }
+
+    MappedFile mFile;
+    std::vector<unsigned> mTopology;
+    unsigned mNumSamples;
+    BinaryDatasetFormat::DataType mDataType;
+    const void *mInputs;
+    const void *mTargets;
+};
+
+//Writes a binary dataset one sample at a time without knowing the amount up front.
+//Targets go to a temporary file next to the output and are appended by Close.
+class BinaryDatasetWriter
+{
+public:
+    BinaryDatasetWriter();
+    ~BinaryDatasetWriter();
+
+    bool Open(const std::string &filename, const std::vector<unsigned> &topology, BinaryDatasetFormat::DataType dataType);
+    //[input neurons] and [output neurons] values, converted to the file data type
+    void Write(const double *inputVals, const double *targetVals);
+    void Write(const float *inputVals, const float *targetVals);
+    //Completes the file, false if any write or the targets copy failed (the output is then removed)
+    bool Close();
+
+    inline unsigned GetNumSamples() const { return mNumSamples; }
+
+private:
+    void Abort();
+    template <typename T>
+    void WriteSample(const T *inputVals, const T *targetVals);
+    template <typename T>
+    void WriteValues(std::ofstream &file, const T *values, unsigned count);
+
+    std::string mFilename;
+    std::ofstream mFile;
+    std::ofstream mTargetsFile;
+    std::vector<unsigned> mTopology;
+    BinaryDatasetFormat::DataType mDataType;
+    unsigned mNumSamples;
+    uint64_t mInputsOffset;
+    std::vector<char> mBuffer;
+    bool mOpen;
+};
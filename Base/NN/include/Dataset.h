@@ -0,0 +1,73 @@
+﻿//
+//  Dataset.h
+//  NeuralNetwork
+//
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "Random.h"
+#include "TextDatasetReader.h"
+
+//Whole dataset in memory, loaded once to train over it as many epochs as needed.
+//Samples stay where they were loaded: an epoch visits them through a permutation of their indices,
+//and GatherBatch copies the rows of the next batch into a buffer reused batch after batch.
+template <typename T>
+class DatasetT
+{
+public:
+    DatasetT();
+    ~DatasetT() {}
+
+    //Binary datasets (either precision) or text files, converted to T. False if the file can not be read
+    bool Load(const std::string &filename);
+
+    inline const std::vector<unsigned> &GetTopology() const { return mTopology; }
+    inline unsigned GetNumSamples() const { return mNumSamples; }
+    inline unsigned GetNumInputs() const { return mTopology.front(); }
+    inline unsigned GetNumOutputs() const { return mTopology.back(); }
+
+    //In load order, [samples x input neurons] and [samples x output neurons]
+    inline const T *GetInputs() const { return mInputs.data(); }
+    inline const T *GetTargets() const { return mTargets.data(); }
+
+    //New visiting order for the next epoch (Fisher-Yates over the indices). With batchSize > 1 the indices
+    //of every batch are then sorted: same samples per batch, but gathered in ascending memory order
+    void Shuffle(Random &random, unsigned batchSize = 1);
+    //Back to load order
+    void ResetOrder();
+    //Moves a random 'fraction' of the samples into holdout (e.g. a validation set), this dataset keeps the rest.
+    //Both end up in load order
+    void Split(double fraction, Random &random, DatasetT<T> &holdout);
+    //Collapses the samples with the same inputs and targets into one weighted sample, kept where it first
+    //appeared. Returns the number of unique samples, GetWeights then tells how many samples each one stands for
+    unsigned Compact();
+    //[samples] weights, null if the dataset was never compacted (every sample counts once)
+    inline const T *GetWeights() const { return mWeights.empty() ? nullptr : mWeights.data(); }
+    //Sample visited at 'position' of the current order
+    inline unsigned GetSampleIndex(unsigned position) const { return mOrder[position]; }
+
+    //Copies the samples at positions [first, first + batchSize) of the current order into one contiguous batch.
+    //Valid until the next call, the buffer is only allocated by the first batch of each size
+    const SampleBatch<T> &GatherBatch(unsigned first, unsigned batchSize);
+
+private:
+    bool LoadBinary(const std::string &filename);
+    bool LoadText(const std::string &filename);
+
+    std::vector<unsigned> mTopology;
+    unsigned mNumSamples;
+    std::vector<T> mInputs;
+    std::vector<T> mTargets;
+    //Only filled by Compact
+    std::vector<T> mWeights;
+
+    std::vector<unsigned> mOrder;
+    SampleBatch<T> mBatch;
+};
+
+//Implemented in Dataset.cpp for these two types only
+typedef DatasetT<double> Dataset;
+typedef DatasetT<float> FloatDataset;
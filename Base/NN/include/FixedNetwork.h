@@ -0,0 +1,190 @@
+﻿//
+//  FixedNetwork.h
+//  NeuralNetwork
+//
+
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#include "Activation.h"
+#include "Random.h"
+
+//Inference only network with the topology fixed at compile time, e.g. FixedNetwork<4, 4, 3>.
+//Weights live in std::array members (no heap allocations) and every loop has a constant trip count,
+//so the dot products are unrolled by the templates below. It computes the same outputs as the
+//dynamic Network and shares its connection weight format: layer, source neuron (bias included), target neuron.
+namespace FixedNetworkDetail
+{
+    template <unsigned First, unsigned... Rest>
+    struct FirstSize { static const unsigned Value = First; };
+
+    //Sum(a[i] * b[i]) for i < N, added in the same order as the scalar kernel
+    template <unsigned N>
+    struct Dot
+    {
+        template <typename T>
+        static inline T Apply(const T *a, const T *b) { return Dot<N - 1>::Apply(a, b) + a[N - 1] * b[N - 1]; }
+    };
+
+    template <>
+    struct Dot<0>
+    {
+        template <typename T>
+        static inline T Apply(const T *, const T *) { return T(0); }
+    };
+
+    //Row j of Weights holds the weights from every input into neuron j, with the bias as the last column
+    template <typename T, unsigned Inputs, unsigned... Sizes>
+    struct Layers;
+
+    //Output layer, it owns no weights
+    template <typename T, unsigned Inputs>
+    struct Layers<T, Inputs>
+    {
+        static const unsigned NumWeights = 0;
+        static const unsigned NumOutputs = Inputs;
+
+        inline void FeedForward(Activation::Type, const T *inputs, T *outputs) const
+        {
+            for (unsigned i = 0; i < Inputs; i++)
+                outputs[i] = inputs[i];
+        }
+
+        template <typename U> inline const U *SetConnectionWeights(const U *w) { return w; }
+        template <typename U> inline void GetConnectionWeights(std::vector<U> &) const {}
+        inline void RandomizeWeights() {}
+        static void GetTopology(std::vector<unsigned> &topology) { topology.push_back(Inputs); }
+    };
+
+    template <typename T, unsigned Inputs, unsigned Neurons, unsigned... Sizes>
+    struct Layers<T, Inputs, Neurons, Sizes...>
+    {
+        typedef Layers<T, Neurons, Sizes...> NextLayers;
+
+        //Previous layer neurons plus its bias neuron
+        static const unsigned NumInputs = Inputs + 1;
+        static const unsigned NumWeights = Neurons * NumInputs + NextLayers::NumWeights;
+        static const unsigned NumOutputs = NextLayers::NumOutputs;
+
+        std::array<T, Neurons * NumInputs> Weights;
+        NextLayers Next;
+
+        inline void FeedForward(Activation::Type activation, const T *inputs, T *outputs) const
+        {
+            //Same constant output for the bias neuron as the dynamic network
+            std::array<T, NumInputs> values;
+            for (unsigned i = 0; i < Inputs; i++)
+                values[i] = inputs[i];
+            values[Inputs] = T(-1);
+
+            std::array<T, Neurons> layerOutputs;
+            for (unsigned j = 0; j < Neurons; j++)
+                layerOutputs[j] = Activation::Apply(activation, Dot<NumInputs>::Apply(values.data(), &Weights[j * NumInputs]));
+
+            Next.FeedForward(activation, layerOutputs.data(), outputs);
+        }
+
+        template <typename U>
+        inline const U *SetConnectionWeights(const U *w)
+        {
+            for (unsigned i = 0; i < NumInputs; i++)
+            {
+                for (unsigned j = 0; j < Neurons; j++)
+                    Weights[j * NumInputs + i] = (T)*w++;
+            }
+
+            return Next.SetConnectionWeights(w);
+        }
+
+        template <typename U>
+        inline void GetConnectionWeights(std::vector<U> &w) const
+        {
+            for (unsigned i = 0; i < NumInputs; i++)
+            {
+                for (unsigned j = 0; j < Neurons; j++)
+                    w.push_back((U)Weights[j * NumInputs + i]);
+            }
+
+            Next.GetConnectionWeights(w);
+        }
+
+        //Visits the connections in the same order (and draws the same random values) as the dynamic network
+        inline void RandomizeWeights()
+        {
+            Random &random = Random::GetThreadRandom();
+            for (unsigned i = 0; i < NumInputs; i++)
+            {
+                for (unsigned j = 0; j < Neurons; j++)
+                    Weights[j * NumInputs + i] = (T)random.NextDouble();
+            }
+
+            Next.RandomizeWeights();
+        }
+
+        static void GetTopology(std::vector<unsigned> &topology)
+        {
+            topology.push_back(Inputs);
+            NextLayers::GetTopology(topology);
+        }
+    };
+}
+
+template <typename T, unsigned... Sizes>
+class FixedNetworkT
+{
+public:
+    static_assert(sizeof...(Sizes) >= 2, "A network needs at least an input and an output layer");
+    typedef FixedNetworkDetail::Layers<T, Sizes...> LayersType;
+
+    static const unsigned NumInputs = FixedNetworkDetail::FirstSize<Sizes...>::Value;
+    static const unsigned NumOutputs = LayersType::NumOutputs;
+    static const unsigned NumWeights = LayersType::NumWeights;
+
+    //Random weights, a given seed builds the same network as Network(GetTopology(), activation)
+    FixedNetworkT(Activation::Type activation = Activation::Tanh) : mActivation(activation) { mLayers.RandomizeWeights(); mResults.fill(T(0)); }
+    //Given [NumWeights] weights in connection order (see SetConnectionWeights), draws no random numbers
+    template <typename U>
+    explicit FixedNetworkT(const U *weights, Activation::Type activation = Activation::Tanh) : mActivation(activation)
+    {
+        mLayers.SetConnectionWeights(weights);
+        mResults.fill(T(0));
+    }
+    ~FixedNetworkT() {}
+
+    //Allocation free evaluation
+    inline void FeedForward(const T *inputVals, T *resultVals) const { mLayers.FeedForward(mActivation, inputVals, resultVals); }
+    inline void FeedForward(const std::array<T, NumInputs> &inputVals) { mLayers.FeedForward(mActivation, inputVals.data(), mResults.data()); }
+    inline const std::array<T, NumOutputs> &GetResults() const { return mResults; }
+
+    //Same interface as the dynamic network
+    inline void FeedForward(const std::vector<T> &inputVals) { mLayers.FeedForward(mActivation, inputVals.data(), mResults.data()); }
+    inline void GetResults(std::vector<T> &resultVals) const { resultVals.assign(mResults.begin(), mResults.end()); }
+
+    //Weights in connection order: layer, source neuron (bias included), target neuron
+    template <typename U>
+    inline void SetConnectionWeights(const std::vector<U> &w) { mLayers.SetConnectionWeights(w.data()); }
+    //Same from [NumWeights] values
+    template <typename U>
+    inline void SetConnectionWeights(const U *w) { mLayers.SetConnectionWeights(w); }
+    template <typename U>
+    inline void GetConnectionWeights(std::vector<U> &w) const { w.clear(); w.reserve(NumWeights); mLayers.GetConnectionWeights(w); }
+
+    inline Activation::Type GetActivation() const { return mActivation; }
+
+    //Topology to build the equivalent dynamic network
+    static std::vector<unsigned> GetTopology() { std::vector<unsigned> topology; LayersType::GetTopology(topology); return topology; }
+
+private:
+    Activation::Type mActivation;
+    LayersType mLayers;
+    std::array<T, NumOutputs> mResults;
+};
+
+template <unsigned... Sizes>
+using FixedNetwork = FixedNetworkT<double, Sizes...>;
+template <unsigned... Sizes>
+using FloatFixedNetwork = FixedNetworkT<float, Sizes...>;
@@ -0,0 +1,77 @@
+﻿//
+//  Kernels.h
+//  NeuralNetwork
+//
+
+#pragma once
+
+#include <cstdint>
+
+//Vector kernels used by the network inner loops.
+//The implementation is picked at startup from CPUID (AVX-512, AVX2, SSE2 or plain scalar code),
+//every kernel comes in double and float versions
+namespace Kernels
+{
+    enum InstructionSet
+    {
+        Scalar = 0,
+        SSE2,
+        AVX2,
+        AVX512
+    };
+
+    //Sum(a[i] * b[i])
+    double Dot(const double *a, const double *b, unsigned count);
+    float Dot(const float *a, const float *b, unsigned count);
+
+    //y[i] += alpha * x[i]
+    void Axpy(double alpha, const double *x, double *y, unsigned count);
+    void Axpy(float alpha, const float *x, float *y, unsigned count);
+
+    //Momentum weight update of one neuron:
+    //deltas[i] = scale * inputs[i] + momentum * deltas[i]; weights[i] += deltas[i]
+    void UpdateWeights(double scale, const double *inputs, double momentum, double *deltas, double *weights, unsigned count);
+    void UpdateWeights(float scale, const float *inputs, float momentum, float *deltas, float *weights, unsigned count);
+
+    //Four dot products sharing the same b vector: result[r] = Sum(a[r][i] * b[i]), rows are 'stride' apart
+    void Dot4(const double *a, unsigned stride, const double *b, unsigned count, double result[4]);
+    void Dot4(const float *a, unsigned stride, const float *b, unsigned count, float result[4]);
+
+    //One dot product per column of two [rows x stride] matrices: result[i] = Sum(a[r][i] * b[r][i]) for i < count
+    void ColumnDot(const double *a, const double *b, unsigned stride, unsigned rows, double *result, unsigned count);
+    void ColumnDot(const float *a, const float *b, unsigned stride, unsigned rows, float *result, unsigned count);
+
+    //In place activations: values[i] = Activation::RationalTanhValue(values[i]) and values[i] = max(0, values[i])
+    void RationalTanh(double *values, unsigned count);
+    void RationalTanh(float *values, unsigned count);
+    void Relu(double *values, unsigned count);
+    void Relu(float *values, unsigned count);
+    //values[i] = Activation::TableTanhValue(values[i]) and Activation::SigmoidValue(values[i]) up to rounding,
+    //interpolated between two table values gathered per lane (AVX2 and AVX-512 gather instructions, SSE2 loads)
+    void TableTanh(double *values, unsigned count);
+    void TableTanh(float *values, unsigned count);
+    void Sigmoid(double *values, unsigned count);
+    void Sigmoid(float *values, unsigned count);
+
+    //Sum(a[i] * b[i]) of signed 8 bit values accumulated in 32 bits, for quantized inference
+    //(exact while count stays under 2^31 / 127^2 values)
+    int32_t DotInt8(const int8_t *a, const int8_t *b, unsigned count);
+
+    //Matrix products over row-major matrices (ld* is the distance between two rows)
+    //C[m x n] = A[m x k] * B[n x k]^T
+    void GemmNT(unsigned m, unsigned n, unsigned k, const double *a, unsigned lda, const double *b, unsigned ldb, double *c, unsigned ldc);
+    void GemmNT(unsigned m, unsigned n, unsigned k, const float *a, unsigned lda, const float *b, unsigned ldb, float *c, unsigned ldc);
+    //C[m x n] = A[m x k] * B[k x n]
+    void GemmNN(unsigned m, unsigned n, unsigned k, const double *a, unsigned lda, const double *b, unsigned ldb, double *c, unsigned ldc);
+    void GemmNN(unsigned m, unsigned n, unsigned k, const float *a, unsigned lda, const float *b, unsigned ldb, float *c, unsigned ldc);
+    //C[m x n] += A[k x m]^T * B[k x n]
+    void GemmTN(unsigned m, unsigned n, unsigned k, const double *a, unsigned lda, const double *b, unsigned ldb, double *c, unsigned ldc);
+    void GemmTN(unsigned m, unsigned n, unsigned k, const float *a, unsigned lda, const float *b, unsigned ldb, float *c, unsigned ldc);
+
+    //Best instruction set supported by the cpu and the operating system
+    InstructionSet GetSupportedInstructionSet();
+    InstructionSet GetInstructionSet();
+    //Force the kernels to a given instruction set (clamped to the supported one), returns the one in use
+    InstructionSet SetInstructionSet(InstructionSet instructionSet);
+    const char *GetInstructionSetName(InstructionSet instructionSet);
+}
@@ -0,0 +1,39 @@
+﻿//
+//  MappedFile.h
+//  NeuralNetwork
+//
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+//Read only view of a whole file mapped in memory (CreateFileMapping on Windows, mmap elsewhere).
+//Pages are loaded by the OS on first touch, so opening costs the same for any file size.
+class MappedFile
+{
+public:
+    MappedFile();
+    ~MappedFile();
+
+    bool Open(const std::string &filename);
+    void Close();
+
+    inline bool IsOpen() const { return mData != nullptr; }
+    inline const unsigned char *GetData() const { return mData; }
+    inline size_t GetSize() const { return mSize; }
+
+private:
+    MappedFile(const MappedFile &);
+    MappedFile &operator=(const MappedFile &);
+
+    const unsigned char *mData;
+    size_t mSize;
+
+#if defined(_WIN32)
+    void *mFile;
+    void *mMapping;
+#else
+    int mFile;
+#endif
+};
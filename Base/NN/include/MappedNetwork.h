@@ -0,0 +1,44 @@
+﻿//
+//  MappedNetwork.h
+//  NeuralNetwork
+//
+
+#pragma once
+
+#include <vector>
+
+#include "ModelFile.h"
+
+//Inference only network running on the weights of a mapped model file, nothing is copied or parsed:
+//loading costs the mapping plus the checksum. Gives the same outputs as the Network the model was saved from.
+//The model file has to stay open while the network is used.
+template <typename T>
+class MappedNetworkT
+{
+public:
+    MappedNetworkT();
+    ~MappedNetworkT() {}
+
+    //False if the model holds the other precision
+    bool Attach(const ModelFile &model);
+
+    //inputVals holds [input neurons] values, resultVals [output neurons] values
+    void FeedForward(const T *inputVals);
+    void GetResults(T *resultVals) const;
+    //View of the output layer values, valid until the next FeedForward
+    inline const T *GetOutputs() const { return mOutputs.back().data(); }
+    inline unsigned GetNumInputs() const { return mTopology.front(); }
+    inline unsigned GetNumOutputs() const { return mTopology.back(); }
+
+private:
+    std::vector<unsigned> mTopology;
+    Activation::Type mActivation;
+    //mWeights[layer index] points into the mapping, mWeights[0] is unused
+    std::vector<const T *> mWeights;
+    //[layer neurons + 1] per layer, the last value is the bias neuron output
+    std::vector<std::vector<T> > mOutputs;
+};
+
+//Implemented in MappedNetwork.cpp for these two types only
+typedef MappedNetworkT<double> MappedNetwork;
+typedef MappedNetworkT<float> FloatMappedNetwork;
@@ -0,0 +1,107 @@
+﻿//
+//  ModelFile.h
+//  NeuralNetwork
+//
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Activation.h"
+#include "BinaryDataset.h"
+#include "MappedFile.h"
+#include "Network.h"
+
+//Trained network file:
+//  Header (64 bytes), topology (NumLayers x uint32),
+//  then the weights of every layer but the input one, each block row-major [neurons x (previous neurons + 1)]
+//  like Layer::Weights and starting on a 64 bytes boundary, so a mapped file can be used in place.
+//Checksum is the CRC32 of everything after the header. Values are stored in the machine byte order.
+namespace ModelFileFormat
+{
+    const char Magic[4] = { 'N', 'N', 'M', 'D' };
+    const uint32_t Version = 1;
+    const unsigned Alignment = BinaryDatasetFormat::Alignment;
+
+    //Same values as the dataset files
+    typedef BinaryDatasetFormat::DataType DataType;
+
+    struct Header
+    {
+        char Magic[4];
+        uint32_t Version;
+        uint32_t DataType;
+        //Activation::Type of every layer but the input one
+        uint32_t Activation;
+        uint32_t NumLayers;
+        //Output of the bias neurons the weights were trained with (-1 in Network, +1 in the game component)
+        int32_t BiasOutput;
+        uint64_t FileSize;
+        uint32_t Checksum;
+        uint8_t Reserved[28];
+    };
+    static_assert(sizeof(Header) == 64, "The model header is 64 bytes");
+
+    //IEEE 802.3 polynomial (same result as zlib), 'crc' chains several calls
+    uint32_t Crc32(const void *data, size_t size, uint32_t crc = 0);
+    //Offset of the weights of every layer (offsets[0] is unused) and the size of the whole file
+    uint64_t GetLayerOffsets(const std::vector<unsigned> &topology, DataType dataType, std::vector<uint64_t> &offsets);
+}
+
+//Maps a model file, the weights are checked once and then read straight from the mapping
+class ModelFile
+{
+public:
+    ModelFile();
+    ~ModelFile() {}
+
+    //False if the file is missing, is not a model file, is truncated or fails the checksum
+    bool Open(const std::string &filename, bool verifyChecksum = true);
+    void Close();
+
+    inline bool IsOpen() const { return mFile.IsOpen(); }
+    inline const std::vector<unsigned> &GetTopology() const { return mTopology; }
+    inline Activation::Type GetActivation() const { return mActivation; }
+    inline ModelFileFormat::DataType GetDataType() const { return mDataType; }
+    inline int GetBiasOutput() const { return mBiasOutput; }
+
+    //Row-major weights of layer layerIdx (1...number of layers - 1) inside the mapping,
+    //nullptr if the file holds the other precision
+    template <typename T>
+    const T *GetWeights(unsigned layerIdx) const;
+
+    //Copies the weights into a network with the same topology, converting precision and bias sign if needed
+    template <typename T>
+    bool LoadWeights(NetworkT<T> &network) const;
+
+    //Writes the network weights in its own precision
+    template <typename T>
+    static bool Save(const std::string &filename, const NetworkT<T> &network);
+    //Same from weights in connection order (layer, source neuron, target neuron) like the genomes
+    template <typename T>
+    static bool Save(const std::string &filename, const std::vector<unsigned> &topology, Activation::Type activation,
+                     int biasOutput, const std::vector<T> &connectionWeights);
+
+private:
+    //layerWeights[layerIdx] points to row-major weights of the data type size
+    static bool Save(const std::string &filename, const std::vector<unsigned> &topology, Activation::Type activation,
+                     int biasOutput, ModelFileFormat::DataType dataType, const std::vector<const void *> &layerWeights);
+
+    MappedFile mFile;
+    std::vector<unsigned> mTopology;
+    std::vector<uint64_t> mLayerOffsets;
+    Activation::Type mActivation;
+    ModelFileFormat::DataType mDataType;
+    int mBiasOutput;
+};
+
+template <typename T>
+const T *ModelFile::GetWeights(unsigned layerIdx) const
+{
+    if (mDataType != BinaryDatasetFormat::DataTypeOf<T>::Value)
+        return nullptr;
+
+    return (const T *)(mFile.GetData() + mLayerOffsets[layerIdx]);
+}
@@ -7,28 +7,133 @@
 //
 
 
+#pragma once
+
 #include <vector>
+#include <cstdlib>
 
-#include "Neuron.h"
+#include "Activation.h"
+#include "Random.h"
 
-typedef std::vector<Neuron> Layer;
+template <typename T>
+class ParallelTrainerT;
 
-class Network
+//Fully connected layer stored as contiguous blocks (no per neuron allocations)
+//Weights are row-major: row j holds the weights from every neuron of the previous layer
+//into neuron j, with the previous layer's bias neuron as the last column.
+template <typename T>
+struct Layer
+{
+    unsigned NumNeurons = 0;
+    //Neurons of the previous layer including its bias neuron (row length)
+    unsigned NumInputs = 0;
+
+    //[NumNeurons x NumInputs]
+    std::vector<T> Weights;
+    std::vector<T> DeltaWeights;
+
+    //[NumNeurons + 1] the last value is the output of the bias neuron
+    std::vector<T> Outputs;
+    //[NumNeurons]
+    std::vector<T> Gradients;
+
+    //Mini-batch buffers, only allocated by TrainBatch
+    //[batch size x (NumNeurons + 1)] one row of outputs (bias included) per sample
+    std::vector<T> BatchOutputs;
+    //[batch size x NumNeurons]
+    std::vector<T> BatchGradients;
+    //[NumNeurons x NumInputs] gradients accumulated over the whole batch
+    std::vector<T> WeightGradients;
+};
+
+//T is the scalar type used for weights, activations and training (double or float).
+//The float version halves the memory traffic and doubles the values per vector register.
+template <typename T>
+class NetworkT
 {
 public:
-    Network(const std::vector<unsigned> &topology);
-    ~Network() {}
+    NetworkT(const std::vector<unsigned> &topology, Activation::Type activation = Activation::Tanh);
+    //Copies a network of the other precision (topology, activation, weights, momentum and error)
+    template <typename U>
+    explicit NetworkT(const NetworkT<U> &other);
+    ~NetworkT() {}
+
+    void FeedForward(const std::vector<T> &inputVals);
+    void BackPropagate(const std::vector<T> &targetVals);
+    //Reuses the vector capacity, no allocation once it has held the results
+    void GetResults(std::vector<T> &resultVals) const;
+
+    //Allocation free versions over caller owned buffers: inputVals holds [input neurons] values,
+    //targetVals and resultVals [output neurons] values
+    void FeedForward(const T *inputVals);
+    void BackPropagate(const T *targetVals);
+    void GetResults(T *resultVals) const;
+    //View of the output layer values, valid until the next FeedForward
+    inline const T *GetOutputs() const { return mLayers.back().Outputs.data(); }
+    inline unsigned GetNumInputs() const { return mLayers.front().NumNeurons; }
+    inline unsigned GetNumOutputs() const { return mLayers.back().NumNeurons; }
 
-    void FeedForward(const std::vector<double> &inputVals);
-    void BackPropagate(const std::vector<double> &targetVals);
-    void GetResults(std::vector<double> &resultVals) const;
+    //Trains over a whole batch at once. inputs [batchSize x input neurons] and targets [batchSize x output neurons]
+    //are row-major, both passes run as matrix-matrix products and the weights get a single update
+    //with the gradient averaged over the batch
+    void TrainBatch(const std::vector<T> &inputs, const std::vector<T> &targets, unsigned batchSize);
+    //Same over caller owned matrices, e.g. a slice of a mapped dataset
+    void TrainBatch(const T *inputs, const T *targets, unsigned batchSize);
+    //Same over weighted samples, sample i counts as weights[i] copies of itself: the gradient and the error
+    //are averaged over the sum of the weights. The unique samples of a dataset weighted by their counts
+    //(DatasetT::Compact) give the same update as a batch of the whole dataset. Does nothing if the weights sum to zero
+    void TrainBatch(const T *inputs, const T *targets, const T *weights, unsigned batchSize);
+    //RMS error of the last sample (or batch) back propagated
+    inline double GetError() const { return mError; }
     inline double GetRecentAverageError() const { return mRecentAverageError; }
+    inline Activation::Type GetActivation() const { return mActivation; }
+
+    //Weights in connection order: layer, source neuron (bias included), target neuron
+    //Both precisions can be loaded and stored, values are converted on the way
+    template <typename U>
+    void SetConnectionWeights(const std::vector<U> &w);
+    template <typename U>
+    void GetConnectionWeights(std::vector<U> &w) const;
+
+    //Row-major weights of layer layerIdx (1...number of layers - 1), the layout of Layer::Weights and of the model files
+    void GetTopology(std::vector<unsigned> &topology) const;
+    inline const T *GetLayerWeights(unsigned layerIdx) const { return mLayers[layerIdx].Weights.data(); }
+    void SetLayerWeights(unsigned layerIdx, const T *weights);
+    //Constant output of the bias neurons
+    inline T GetBiasOutput() const { return mLayers.front().Outputs.back(); }
 
 private:
-    //mLayers[layer index][neuron index]
-    std::vector<Layer> mLayers;
+    template <typename U> friend class NetworkT;
+    template <typename U> friend class ParallelTrainerT;
+    template <typename U> friend class ValidatorT;
+
+    //From the stream of the calling thread (see Random::SetRunSeed), [0...1)
+    static T RandomWeight() { return (T)Random::GetThreadRandom().NextDouble(); }
+
+    void ResizeBatch(unsigned batchSize);
+    //TrainBatch in two halves: the forward and backward passes leave the batch RMS error in mError
+    //and the gradients summed over the batch in every layer WeightGradients, the update applies them.
+    //With weights every sample gradient is scaled by its weight and the error is the weighted average
+    void ComputeBatchGradients(const T *inputs, const T *targets, unsigned batchSize, const T *weights = nullptr);
+    void ApplyWeightGradients(T scale);
+    void UpdateRecentAverageError();
+
+    //Transfer function of every neuron (the input layer excluded)
+    Activation::Type mActivation;
+
+    //mLayers[layer index], mLayers[0] is the input layer and has no weights
+    std::vector<Layer<T> > mLayers;
 
     double mError;
     double mRecentAverageError;
     double mRecentAverageSmoothingFactor;
+
+    //Overall network learning rate [0.0...1.0]
+    T mLearningRate = (T)0.15;
+    //Multiplier of last weight change [0.0...n]
+    T mMomentum = (T)0.5;
 };
+
+//Implemented in Network.cpp for these two types only
+typedef NetworkT<double> Network;
+typedef NetworkT<float> FloatNetwork;
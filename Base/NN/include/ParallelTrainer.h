@@ -0,0 +1,77 @@
+﻿//
+//  ParallelTrainer.h
+//  NeuralNetwork
+//
+
+#pragma once
+
+#include "Network.h"
+
+class StepBarrier;
+
+//Data parallel back propagation over a training set held in memory. Each thread owns a contiguous
+//shard of the samples and a private copy of the network for its activations and gradients.
+//Synchronous: on every step each thread computes the gradients of its next mini-batch, thread 0 sums
+//them in thread order and applies one update to the network (the same update TrainBatch would do with
+//all those mini-batches together), then every copy reloads the new weights.
+//Hogwild: threads never wait for each other. Each one reloads the shared weights before a mini-batch
+//and adds its update straight into them without locks, so concurrent updates may overwrite each other.
+template <typename T>
+class ParallelTrainerT
+{
+public:
+    enum Mode
+    {
+        Synchronous = 0,
+        Hogwild
+    };
+
+    //numThreads 0 uses every hardware thread
+    ParallelTrainerT(NetworkT<T> &network, unsigned numThreads = 0, Mode mode = Synchronous);
+    ~ParallelTrainerT() {}
+
+    //One pass over the samples in mini-batches of batchSize per thread,
+    //inputs [numSamples x input neurons] and targets [numSamples x output neurons] are row-major
+    void TrainEpoch(const T *inputs, const T *targets, unsigned numSamples, unsigned batchSize);
+    void TrainEpoch(const std::vector<T> &inputs, const std::vector<T> &targets, unsigned batchSize);
+
+    //Average RMS error over the samples of the last epoch
+    inline double GetEpochError() const { return mEpochError; }
+    //Weight updates of the last epoch: one per step when Synchronous, one per mini-batch of every thread when Hogwild
+    inline unsigned GetEpochSteps() const { return mEpochSteps; }
+    inline unsigned GetNumThreads() const { return (unsigned)mWorkers.size(); }
+    inline Mode GetMode() const { return mMode; }
+
+    static unsigned GetHardwareThreads();
+    static const char *GetModeName(Mode mode);
+
+private:
+    struct Worker
+    {
+        Worker(const NetworkT<T> &network) : Network(network), BatchSamples(0), ErrorSum(0.0) {}
+
+        NetworkT<T> Network;
+        //Samples of the current mini-batch (0 once the shard is done)
+        unsigned BatchSamples;
+        //Sum of the batch errors weighted by their samples
+        double ErrorSum;
+    };
+
+    //Runs on its own thread, the shard is [firstSample, firstSample + numSamples)
+    void TrainShard(unsigned workerIdx, const T *inputs, const T *targets, unsigned firstSample, unsigned numSamples,
+                    unsigned batchSize, unsigned numSteps, StepBarrier *barrier);
+    void ComputeGradients(Worker &worker, const T *inputs, const T *targets, unsigned firstSample, unsigned numSamples);
+    void ApplySynchronousStep();
+    void ApplyHogwildStep(Worker &worker);
+    void LoadWeights(Worker &worker);
+
+    NetworkT<T> &mNetwork;
+    std::vector<Worker> mWorkers;
+    Mode mMode;
+    double mEpochError;
+    unsigned mEpochSteps;
+};
+
+//Implemented in ParallelTrainer.cpp for these two types only
+typedef ParallelTrainerT<double> ParallelTrainer;
+typedef ParallelTrainerT<float> FloatParallelTrainer;
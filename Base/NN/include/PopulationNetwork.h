@@ -0,0 +1,72 @@
+﻿//
+//  PopulationNetwork.h
+//  NeuralNetwork
+//
+
+#pragma once
+
+#include <vector>
+
+#include "Activation.h"
+
+//Inference of a whole population of networks sharing one topology (a genetic algorithm generation).
+//Weights are stored structure of arrays with the genome index innermost: Weights[neuron][input][genome],
+//so a vector register holds the same connection of consecutive genomes and one feed forward
+//evaluates every genome at once. Outputs keep the same layout, Outputs[neuron][genome].
+//Genome weights use the Network connection order: layer, source neuron (bias included), target neuron.
+template <typename T>
+class PopulationNetworkT
+{
+public:
+    PopulationNetworkT(const std::vector<unsigned> &topology, unsigned numGenomes, Activation::Type activation = Activation::Tanh);
+    ~PopulationNetworkT() {}
+
+    template <typename U>
+    void SetGenomeWeights(unsigned genome, const std::vector<U> &w);
+    //Same from [GetNumWeights()] values, e.g. a chromosome row of a population store
+    template <typename U>
+    void SetGenomeWeights(unsigned genome, const U *w);
+    template <typename U>
+    void GetGenomeWeights(unsigned genome, std::vector<U> &w) const;
+
+    //Same [input neurons] values for every genome
+    void SetInputs(const T *inputVals);
+    //Inputs of a single genome
+    void SetGenomeInputs(unsigned genome, const T *inputVals);
+
+    void FeedForward();
+
+    //Output neuron 'output' of every genome, [genomes] values valid until the next FeedForward
+    inline const T *GetResults(unsigned output) const { return &mLayers.back().Outputs[output * mStride]; }
+    void GetGenomeResults(unsigned genome, T *resultVals) const;
+
+    inline unsigned GetNumGenomes() const { return mNumGenomes; }
+    inline unsigned GetNumInputs() const { return mLayers.front().NumNeurons; }
+    inline unsigned GetNumOutputs() const { return mLayers.back().NumNeurons; }
+    //Connection weights of every genome
+    inline unsigned GetNumWeights() const { return mNumWeights; }
+    inline Activation::Type GetActivation() const { return mActivation; }
+
+private:
+    struct PopulationLayer
+    {
+        unsigned NumNeurons;
+        //Previous layer neurons plus its bias neuron
+        unsigned NumInputs;
+        //[NumNeurons x NumInputs x stride]
+        std::vector<T> Weights;
+        //[(NumNeurons + 1) x stride], the last row is the bias neuron
+        std::vector<T> Outputs;
+    };
+
+    Activation::Type mActivation;
+    unsigned mNumGenomes;
+    //Distance between two rows, the genomes rounded up to a whole cache line
+    unsigned mStride;
+    unsigned mNumWeights;
+    std::vector<PopulationLayer> mLayers;
+};
+
+//Implemented in PopulationNetwork.cpp for these two types only
+typedef PopulationNetworkT<double> PopulationNetwork;
+typedef PopulationNetworkT<float> FloatPopulationNetwork;
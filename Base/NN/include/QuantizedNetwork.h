@@ -0,0 +1,71 @@
+﻿//
+//  QuantizedNetwork.h
+//  NeuralNetwork
+//
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Activation.h"
+#include "Network.h"
+
+//Output difference between a network and its quantized copy over a set of samples
+struct QuantizationError
+{
+    double MaxError;
+    double MeanError;
+    unsigned NumSamples;
+};
+
+//Inference only int8 copy of a trained network, an eighth of the double weights.
+//Weights are quantized once with a symmetric scale per layer (max |w| -> 127). Before every layer the
+//input vector (bias included) gets its own scale the same way, the products run in 8 bits with 32 bits
+//accumulators (Kernels::DotInt8) and the sums go back to float for the transfer function.
+class QuantizedNetwork
+{
+public:
+    QuantizedNetwork() {}
+    template <typename T>
+    explicit QuantizedNetwork(const NetworkT<T> &network);
+    ~QuantizedNetwork() {}
+
+    //inputVals holds [input neurons] values, resultVals [output neurons] values. No allocation
+    void FeedForward(const float *inputVals);
+    void GetResults(float *resultVals) const;
+    //View of the output layer values, valid until the next FeedForward
+    inline const float *GetOutputs() const { return mOutputs.back().data(); }
+    inline unsigned GetNumInputs() const { return mLayers.front().NumNeurons; }
+    inline unsigned GetNumOutputs() const { return mLayers.back().NumNeurons; }
+
+    //Bytes of weights read by every FeedForward
+    size_t GetWeightsSize() const;
+
+    //Runs both networks over inputs [numSamples x input neurons] and compares the outputs
+    template <typename T>
+    QuantizationError MeasureError(NetworkT<T> &network, const T *inputs, unsigned numSamples);
+
+private:
+    struct QuantizedLayer
+    {
+        unsigned NumNeurons;
+        //Neurons of the previous layer including its bias neuron
+        unsigned NumInputs;
+        //Row length padded to 16 values with zero weights, so the kernel never runs a scalar tail
+        unsigned Stride;
+        //w = Weights * WeightScale
+        float WeightScale;
+        //[NumNeurons x Stride]
+        std::vector<int8_t> Weights;
+    };
+
+    Activation::Type mActivation;
+    //mLayers[0] is the input layer and has no weights
+    std::vector<QuantizedLayer> mLayers;
+    //[layer neurons + 1] per layer, the last value is the bias neuron output
+    std::vector<std::vector<float> > mOutputs;
+    //Input vector of the layer being computed, [widest Stride]
+    std::vector<int8_t> mQuantizedInputs;
+    std::vector<float> mInputVals;
+};
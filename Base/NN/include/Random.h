@@ -0,0 +1,196 @@
+﻿//
+//  Random.h
+//  NeuralNetwork
+//
+
+#pragma once
+
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+//xoshiro256** pseudo random generator (Blackman and Vigna): 32 bytes of state, a few cycles per number.
+//Unlike rand() every instance is independent, so each thread owns one, and Jump() splits a single
+//seed into non overlapping streams of 2^128 numbers. LongJump() starts past 2^64 of those streams.
+//SetRunSeed and GetThreadRandom give every thread its own stream of a single run seed, for the code that
+//has no generator of its own to use (e.g. the initial weights of the networks).
+class Random
+{
+public:
+    explicit Random(uint64_t seed = 0) { Seed(seed); }
+
+    //The state is expanded from the seed with splitmix64, any seed (0 included) is valid
+    inline void Seed(uint64_t seed)
+    {
+        for (unsigned i = 0; i < 4; i++)
+        {
+            seed += 0x9e3779b97f4a7c15ull;
+            uint64_t z = seed;
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+            mState[i] = z ^ (z >> 31);
+        }
+    }
+
+    inline uint64_t Next()
+    {
+        uint64_t result = RotateLeft(mState[1] * 5, 7) * 9;
+        uint64_t t = mState[1] << 17;
+
+        mState[2] ^= mState[0];
+        mState[3] ^= mState[1];
+        mState[1] ^= mState[2];
+        mState[0] ^= mState[3];
+        mState[2] ^= t;
+        mState[3] = RotateLeft(mState[3], 45);
+
+        return result;
+    }
+
+    //[0.0...1.0)
+    inline double NextDouble() { return (Next() >> 11) * (1.0 / 9007199254740992.0); }
+    //[0...count)
+    inline unsigned NextUnsigned(unsigned count) { return (unsigned)(((Next() >> 32) * count) >> 32); }
+
+    //values[count] uniform in [min...max), the same numbers as count calls to NextDouble
+    template <typename T>
+    inline void FillUniform(T *values, size_t count, T min, T max)
+    {
+        double scale = (double)max - (double)min;
+        for (size_t i = 0; i < count; i++)
+            values[i] = (T)(min + NextDouble() * scale);
+    }
+
+    //values[count] normally distributed, Box-Muller: two values for every pair of uniform numbers
+    template <typename T>
+    inline void FillNormal(T *values, size_t count, T mean, T deviation)
+    {
+        const double twoPi = 6.283185307179586;
+        for (size_t i = 0; i < count; i += 2)
+        {
+            //(0.0...1.0], the logarithm is always finite
+            double radius = std::sqrt(-2.0 * std::log(1.0 - NextDouble())) * deviation;
+            double angle = twoPi * NextDouble();
+            values[i] = (T)(mean + radius * std::cos(angle));
+            if (i + 1 < count)
+                values[i + 1] = (T)(mean + radius * std::sin(angle));
+        }
+    }
+
+    //Same as calling Next() 2^128 times
+    inline void Jump()
+    {
+        static const uint64_t jump[4] = { 0x180ec6d33cfd0abaull, 0xd5a61266f0c9392cull, 0xa9582618e03fc9aaull, 0x39abdc4529b1661cull };
+        JumpAhead(jump);
+    }
+
+    //Same as calling Next() 2^192 times, far past every Stream() of the same seed
+    inline void LongJump()
+    {
+        static const uint64_t jump[4] = { 0x76e15d3efefdcbbfull, 0xc5004e441c522fb3ull, 0x77710069854ee241ull, 0x39109bb02acbe635ull };
+        JumpAhead(jump);
+    }
+
+    //The whole state, to continue the same sequence later (e.g. from a checkpoint)
+    inline void GetState(uint64_t state[4]) const
+    {
+        for (unsigned i = 0; i < 4; i++)
+            state[i] = mState[i];
+    }
+
+    inline void SetState(const uint64_t state[4])
+    {
+        for (unsigned i = 0; i < 4; i++)
+            mState[i] = state[i];
+    }
+
+    //Stream 'index' of a seed, it never overlaps with the other streams of the same seed
+    static Random Stream(uint64_t seed, unsigned index)
+    {
+        Random random(seed);
+        for (unsigned i = 0; i < index; i++)
+            random.Jump();
+
+        return random;
+    }
+
+    //Restarts the thread streams, every thread continues with its stream of the new seed (0 until the first call)
+    static void SetRunSeed(uint64_t seed)
+    {
+        RunSeed &run = GetRunSeed();
+        std::lock_guard<std::mutex> lock(run.Mutex);
+        run.Seed = seed;
+        run.NextStream = 0;
+        run.Generation++;
+    }
+
+    //Generator of the calling thread: stream n of the run seed, n being the order in which the threads asked for
+    //their first number since SetRunSeed. Code that only runs on one thread always draws the same numbers for a seed
+    static Random &GetThreadRandom()
+    {
+        struct ThreadRandom
+        {
+            ThreadRandom() : Generation(~0u) {}
+
+            unsigned Generation;
+            Random Stream;
+        };
+        static thread_local ThreadRandom thread;
+
+        RunSeed &run = GetRunSeed();
+        if (thread.Generation != run.Generation.load(std::memory_order_acquire))
+        {
+            std::lock_guard<std::mutex> lock(run.Mutex);
+            thread.Stream = Stream(run.Seed, run.NextStream++);
+            thread.Generation = run.Generation.load(std::memory_order_relaxed);
+        }
+
+        return thread.Stream;
+    }
+
+private:
+    //Advances the state by the jump polynomial
+    inline void JumpAhead(const uint64_t jump[4])
+    {
+        uint64_t state[4] = { 0, 0, 0, 0 };
+        for (unsigned i = 0; i < 4; i++)
+        {
+            for (unsigned bit = 0; bit < 64; bit++)
+            {
+                if (jump[i] & (1ull << bit))
+                {
+                    for (unsigned j = 0; j < 4; j++)
+                        state[j] ^= mState[j];
+                }
+                Next();
+            }
+        }
+
+        for (unsigned j = 0; j < 4; j++)
+            mState[j] = state[j];
+    }
+
+    struct RunSeed
+    {
+        RunSeed() : Seed(0), NextStream(0), Generation(0) {}
+
+        std::mutex Mutex;
+        uint64_t Seed;
+        unsigned NextStream;
+        //Changed by every SetRunSeed, the threads compare it with the one of their stream
+        std::atomic<unsigned> Generation;
+    };
+
+    //One for the whole program, whichever module includes this header
+    static RunSeed &GetRunSeed()
+    {
+        static RunSeed run;
+        return run;
+    }
+
+    static inline uint64_t RotateLeft(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+    uint64_t mState[4];
+};
@@ -0,0 +1,123 @@
+﻿//
+//  Telemetry.h
+//  NeuralNetwork
+//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+//One training step (a sample or a batch), 32 bytes
+struct TelemetryRecord
+{
+    enum Type
+    {
+        //Sampled step, written to the log file
+        Sampled = 0,
+        //Every summary interval, printed on the console (never dropped)
+        Summary,
+        //End of an epoch, printed on the console
+        Epoch
+    };
+
+    uint64_t Step;
+    double Error;
+    double AverageError;
+    uint32_t EpochIdx;
+    uint32_t RecordType;
+};
+static_assert(sizeof(TelemetryRecord) == 32, "Telemetry records are 32 bytes");
+
+//Bounded queue of records: any number of training threads push, the writer thread pops.
+//Every cell carries a sequence number (Vyukov's bounded queue), pushing is a single compare and swap.
+//When the writer falls behind a push either drops and counts the record or waits for a free cell.
+class TelemetryRing
+{
+public:
+    //capacity is rounded up to a power of two
+    explicit TelemetryRing(unsigned capacity);
+
+    bool Push(const TelemetryRecord &record, bool wait = false);
+    //Writer thread only
+    bool Pop(TelemetryRecord &record);
+
+    inline uint64_t GetDropped() const { return mDropped.load(std::memory_order_relaxed); }
+
+private:
+    struct Cell
+    {
+        std::atomic<size_t> Sequence;
+        TelemetryRecord Record;
+    };
+
+    std::vector<Cell> mCells;
+    size_t mMask;
+    //Producers and consumer write on their own cache lines
+    char mPadding0[64];
+    std::atomic<size_t> mPushPosition;
+    std::atomic<uint64_t> mDropped;
+    char mPadding1[64];
+    size_t mPopPosition;
+};
+
+//Training telemetry: the training loop calls Record after every step, which costs a compare and a
+//push into the ring for one step out of 'sampleRate'. A background thread writes those to a CSV
+//or binary log and prints a summary line every 'summaryInterval' steps and at the end of each epoch.
+//Sampled steps are dropped when the ring is full, summaries and epochs wait for room instead.
+//Nothing is recorded until Open succeeds.
+//Binary logs are a 16 bytes header ("NNTL", version, record size, reserved) followed by raw records.
+class Telemetry
+{
+public:
+    enum Format
+    {
+        Csv = 0,
+        Binary
+    };
+
+    Telemetry();
+    ~Telemetry();
+
+    //An empty filename only prints the summaries. False if the log can not be created
+    bool Open(const std::string &filename, Format format, unsigned sampleRate, unsigned summaryInterval, unsigned capacity = 8192);
+    //Writes everything still queued and stops the writer thread
+    void Close();
+    //Waits until the writer has written every record pushed so far
+    void Flush();
+
+    inline void Record(uint64_t step, double error, double averageError)
+    {
+        if (mLog && step % mSampleRate == 0)
+            Push(step, error, averageError, TelemetryRecord::Sampled);
+        if (step % mSummaryInterval == 0)
+            Push(step, error, averageError, TelemetryRecord::Summary);
+    }
+    //'step' is the amount of steps trained so far
+    void EndEpoch(uint64_t step, double error, double averageError);
+
+    inline uint64_t GetDropped() const { return mRing ? mRing->GetDropped() : 0; }
+
+private:
+    void Push(uint64_t step, double error, double averageError, TelemetryRecord::Type type);
+    //Background thread
+    void WriteRecords();
+    void WriteRecord(const TelemetryRecord &record);
+
+    std::unique_ptr<TelemetryRing> mRing;
+    std::FILE *mLog;
+    Format mFormat;
+    unsigned mSampleRate;
+    unsigned mSummaryInterval;
+    uint32_t mEpoch;
+
+    std::thread mThread;
+    std::atomic<bool> mStop;
+    std::atomic<uint64_t> mPushed;
+    std::atomic<uint64_t> mWritten;
+};
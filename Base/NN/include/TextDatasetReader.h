@@ -0,0 +1,84 @@
+﻿//
+//  TextDatasetReader.h
+//  NeuralNetwork
+//
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+//Parses a decimal number ("-1.5", "3", "2.5e-3") from [begin, end).
+//Returns the position after it, or begin when there is no number. Results are correctly rounded:
+//short mantissas take the exact fast path, the rest falls back to strtod.
+const char *ParseNumber(const char *begin, const char *end, double &value);
+
+//Consecutive samples of a dataset, inputs [NumSamples x input neurons] and targets [NumSamples x output neurons] row-major
+template <typename T>
+struct SampleBatch
+{
+    std::vector<T> Inputs;
+    std::vector<T> Targets;
+    unsigned NumSamples;
+};
+
+//Streams a "topology:/In:/Out:" text dataset of any size. A background thread reads the file in
+//large blocks, parses the samples and fills batches that wait in a bounded queue for the training loop,
+//so parsing overlaps with training and memory stays at (queueDepth + 1) batches plus one block.
+template <typename T>
+class TextDatasetReaderT
+{
+public:
+    TextDatasetReaderT();
+    ~TextDatasetReaderT();
+
+    //Reads the topology line and starts parsing the samples in the background
+    bool Open(const std::string &filename, unsigned batchSize, unsigned queueDepth = 2);
+    //Stops the background thread, any batch not consumed yet is dropped
+    void Close();
+
+    inline const std::vector<unsigned> &GetTopology() const { return mTopology; }
+
+    //Blocks until the next batch is ready, nullptr at the end of the file.
+    //The batch is valid until the next call (its memory is then reused)
+    const SampleBatch<T> *NextBatch();
+
+private:
+    //Background thread
+    void ReadSamples();
+    bool ParseSample(SampleBatch<T> &batch);
+    //Next line of the file without its end of line, false at the end of the file
+    bool ReadLine(const char *&begin, const char *&end);
+    //Parses "label v0 v1 ..." into values, returns how many values were read
+    unsigned ParseLine(const char *label, T *values, unsigned maxValues);
+
+    std::FILE *mFile;
+    std::vector<char> mBlock;
+    size_t mBlockStart;
+    size_t mBlockEnd;
+    bool mFileEnd;
+
+    std::vector<unsigned> mTopology;
+    unsigned mBatchSize;
+
+    //Every batch is allocated once, they move between the free list and the filled queue
+    std::vector<SampleBatch<T> > mBatches;
+    std::deque<SampleBatch<T> *> mFilled;
+    std::deque<SampleBatch<T> *> mFree;
+    SampleBatch<T> *mCurrent;
+
+    std::thread mThread;
+    std::mutex mMutex;
+    std::condition_variable mCondition;
+    bool mStop;
+    bool mDone;
+};
+
+//Implemented in TextDatasetReader.cpp for these two types only
+typedef TextDatasetReaderT<double> TextDatasetReader;
+typedef TextDatasetReaderT<float> FloatTextDatasetReader;
@@ -0,0 +1,59 @@
+﻿//
+//  ThreadPool.h
+//  NeuralNetwork
+//
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//Persistent worker threads that run a batch of independent tasks at a time. Every thread starts on its own
+//contiguous range of task indices and, once it runs out, steals the upper half of the range of another thread,
+//so slow tasks do not leave the other threads idle. Tasks run in no particular order and on any thread:
+//each one writes its results into its own slot and the caller reduces them afterwards, in task order.
+class ThreadPool
+{
+public:
+    //numThreads 0 uses every hardware thread, the thread calling Run counts as one of them
+    explicit ThreadPool(unsigned numThreads = 0);
+    ~ThreadPool();
+
+    //Runs task(taskIdx) for every taskIdx in [0, numTasks) and returns once all of them are done
+    void Run(unsigned numTasks, const std::function<void(unsigned)> &task);
+
+    inline unsigned GetNumThreads() const { return (unsigned)mRanges.size(); }
+
+private:
+    //Tasks [Next, End) still waiting in a thread, taken from the front by their owner and split from the back by thieves
+    struct TaskRange
+    {
+        std::mutex Mutex;
+        unsigned Next;
+        unsigned End;
+        //Keeps the ranges of two threads out of the same cache line
+        char Padding[64];
+    };
+
+    void WaitForJobs(unsigned threadIdx);
+    void RunTasks(unsigned threadIdx);
+    bool PopTask(unsigned threadIdx, unsigned &taskIdx);
+    bool StealTasks(unsigned threadIdx);
+
+    std::vector<std::unique_ptr<TaskRange> > mRanges;
+    std::vector<std::thread> mThreads;
+
+    std::mutex mMutex;
+    std::condition_variable mCondition;
+    const std::function<void(unsigned)> *mTask;
+    //Job counter, a worker joins once per new value
+    uint64_t mJob;
+    //Workers still running tasks of the current job
+    unsigned mRemaining;
+    bool mStop;
+};
@@ -0,0 +1,129 @@
+﻿//
+//  Validator.h
+//  NeuralNetwork
+//
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Network.h"
+
+//Error of one evaluation over the validation set
+struct ValidationResult
+{
+    //Training step of the evaluated weights
+    uint64_t Step;
+    //Average RMS error over the validation samples (the same measure as NetworkT::GetError)
+    double Error;
+    //Lower than every evaluation before
+    bool Improved;
+};
+
+//Evaluates a holdout set on worker threads while the training goes on. Evaluate copies the weights
+//into a snapshot and returns, each worker loads the snapshot into its own network and runs a contiguous
+//shard of the samples. The shard errors are added in worker order, so the result does not depend on timing.
+//The snapshot with the lowest error is kept as the best weights, and written as a model file if asked.
+template <typename T>
+class ValidatorT
+{
+public:
+    //inputs [numSamples x input neurons] and targets [numSamples x output neurons] must outlive the validator.
+    //numThreads 0 leaves one hardware thread to the training
+    ValidatorT(const NetworkT<T> &network, const T *inputs, const T *targets, unsigned numSamples, unsigned numThreads = 0);
+    ~ValidatorT();
+
+    //Starts an evaluation of the network weights. Never waits: false if the previous one is still running
+    bool Evaluate(const NetworkT<T> &network, uint64_t step);
+    //The result of the last finished evaluation, only once per evaluation
+    bool GetResult(ValidationResult &result);
+    //Waits for the running evaluation
+    void Wait();
+
+    //Written with the weights of every new best evaluation (see ModelFile.h), empty for none
+    inline void SetBestModelFile(const std::string &filename) { mBestModelFile = filename; }
+    //Waits for the running evaluation and loads the weights of the best one, false if there was none yet
+    bool GetBestWeights(NetworkT<T> &network);
+    //Valid after Wait, a running evaluation may change them
+    inline double GetBestError() const { return mBestError; }
+    inline uint64_t GetBestStep() const { return mBestStep; }
+    inline unsigned GetNumThreads() const { return (unsigned)mWorkers.size(); }
+
+private:
+    struct Worker
+    {
+        Worker(const NetworkT<T> &network) : Network(network), ErrorSum(0.0) {}
+
+        NetworkT<T> Network;
+        double ErrorSum;
+    };
+
+    void EvaluateShards(unsigned workerIdx);
+    //Run by the last worker of an evaluation
+    void FinishEvaluation();
+    static void CopyWeights(const NetworkT<T> &source, NetworkT<T> &target);
+
+    const T *mInputs;
+    const T *mTargets;
+    unsigned mNumSamples;
+
+    NetworkT<T> mSnapshot;
+    NetworkT<T> mBest;
+    std::string mBestModelFile;
+    double mBestError;
+    uint64_t mBestStep;
+    bool mHasBest;
+
+    std::vector<Worker> mWorkers;
+    std::vector<std::thread> mThreads;
+    std::mutex mMutex;
+    std::condition_variable mCondition;
+    //Evaluation counter, a worker runs once per new value
+    uint64_t mJob;
+    unsigned mRemaining;
+    uint64_t mStep;
+    bool mBusy;
+    bool mStop;
+
+    ValidationResult mResult;
+    bool mHasResult;
+};
+
+//Stops the training once the validation error has not improved on its best by more than minDelta
+//for 'patience' evaluations in a row
+class EarlyStopping
+{
+public:
+    EarlyStopping(unsigned patience, double minDelta) : mPatience(patience), mMinDelta(minDelta), mBestError(0.0), mHasBest(false), mWaiting(0) {}
+
+    //True when the training should stop. A patience of 0 never stops
+    inline bool Update(double error)
+    {
+        if (!mHasBest || error < mBestError - mMinDelta)
+        {
+            mBestError = error;
+            mHasBest = true;
+            mWaiting = 0;
+            return false;
+        }
+
+        mWaiting++;
+        return mPatience > 0 && mWaiting >= mPatience;
+    }
+
+private:
+    unsigned mPatience;
+    double mMinDelta;
+    double mBestError;
+    bool mHasBest;
+    unsigned mWaiting;
+};
+
+//Implemented in Validator.cpp for these two types only
+typedef ValidatorT<double> Validator;
+typedef ValidatorT<float> FloatValidator;
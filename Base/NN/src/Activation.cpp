@@ -0,0 +1,98 @@
+
+#include "Activation.h"
+#include "Kernels.h"
+
+namespace Activation
+{
+    template <typename T>
+    void ApplyValues(Type type, T *values, unsigned count)
+    {
+        switch (type)
+        {
+        case RationalTanh:
+            Kernels::RationalTanh(values, count);
+            break;
+        case ReLU:
+            Kernels::Relu(values, count);
+            break;
+        case TableTanh:
+            Kernels::TableTanh(values, count);
+            break;
+        case Sigmoid:
+            Kernels::Sigmoid(values, count);
+            break;
+        default:
+            //The exact reference, the standard library has no vector tanh
+            for (unsigned i = 0; i < count; i++)
+                values[i] = std::tanh(values[i]);
+            break;
+        }
+    }
+
+    //Branch free loops, the compiler vectorizes them
+    template <typename T>
+    void MultiplyDerivativeValues(Type type, const T *outputs, T *gradients, unsigned count)
+    {
+        switch (type)
+        {
+        case Sigmoid:
+            for (unsigned i = 0; i < count; i++)
+                gradients[i] *= outputs[i] * ((T)1 - outputs[i]);
+            break;
+        case ReLU:
+            for (unsigned i = 0; i < count; i++)
+                gradients[i] = outputs[i] > (T)0 ? gradients[i] : (T)0;
+            break;
+        default:
+            for (unsigned i = 0; i < count; i++)
+                gradients[i] *= (T)1 - outputs[i] * outputs[i];
+            break;
+        }
+    }
+
+    void Apply(Type type, double *values, unsigned count)
+    {
+        ApplyValues(type, values, count);
+    }
+
+    void Apply(Type type, float *values, unsigned count)
+    {
+        ApplyValues(type, values, count);
+    }
+
+    void MultiplyDerivative(Type type, const double *outputs, double *gradients, unsigned count)
+    {
+        MultiplyDerivativeValues(type, outputs, gradients, count);
+    }
+
+    void MultiplyDerivative(Type type, const float *outputs, float *gradients, unsigned count)
+    {
+        MultiplyDerivativeValues(type, outputs, gradients, count);
+    }
+
+    const char *GetName(Type type)
+    {
+        switch (type)
+        {
+        case RationalTanh: return "rational-tanh";
+        case TableTanh: return "table-tanh";
+        case Sigmoid: return "sigmoid";
+        case ReLU: return "relu";
+        default: return "tanh";
+        }
+    }
+
+    bool ParseName(const std::string &name, Type &type)
+    {
+        for (int i = Tanh; i < Count; i++)
+        {
+            if (name == GetName((Type)i))
+            {
+                type = (Type)i;
+                return true;
+            }
+        }
+
+        return false;
+    }
+}
@@ -0,0 +1,65 @@
+
+#include "AllocationCounter.h"
+
+#ifdef NN_COUNT_ALLOCATIONS
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+    std::atomic<unsigned long long> gAllocationCount(0);
+}
+
+void *operator new(std::size_t size)
+{
+    gAllocationCount++;
+
+    void *memory = std::malloc(size > 0 ? size : 1);
+    if (!memory)
+        throw std::bad_alloc();
+
+    return memory;
+}
+
+void *operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void *memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void *memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void *memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void *memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+
+namespace AllocationCounter
+{
+    bool IsEnabled() { return true; }
+    unsigned long long GetCount() { return gAllocationCount; }
+}
+
+#else
+
+namespace AllocationCounter
+{
+    bool IsEnabled() { return false; }
+    unsigned long long GetCount() { return 0; }
+}
+
+#endif
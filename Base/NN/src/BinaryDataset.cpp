@@ -0,0 +1,266 @@
+
+#include "BinaryDataset.h"
+#include <climits>
+#include <cstdio>
+#include <cstring>
+
+using namespace BinaryDatasetFormat;
+
+//rows x columns values, false when the matrix could not even be addressed
+static bool GetMatrixSize(uint64_t rows, uint64_t columns, uint64_t valueSize, uint64_t &size)
+{
+    if (rows == 0 || columns == 0 || rows > SIZE_MAX / columns || rows * columns > SIZE_MAX / valueSize)
+        return false;
+
+    size = rows * columns * valueSize;
+    return true;
+}
+
+BinaryDataset::BinaryDataset()
+{
+    mNumSamples = 0;
+    mDataType = Float64;
+    mInputs = nullptr;
+    mTargets = nullptr;
+}
+
+bool BinaryDataset::Open(const std::string &filename)
+{
+    Close();
+
+    if (!mFile.Open(filename) || mFile.GetSize() < sizeof(Header))
+    {
+        Close();
+        return false;
+    }
+
+    const unsigned char *data = mFile.GetData();
+    const Header *header = (const Header *)data;
+    if (memcmp(header->Magic, Magic, sizeof(Magic)) != 0 || header->Version != Version ||
+        header->DataType > Float32 || header->NumLayers < 2)
+    {
+        Close();
+        return false;
+    }
+
+    //Everything the header points to has to be inside the file
+    uint64_t topologyEnd = sizeof(Header) + (uint64_t)header->NumLayers * sizeof(uint32_t);
+    if (topologyEnd > mFile.GetSize() || header->InputsOffset < topologyEnd)
+    {
+        Close();
+        return false;
+    }
+
+    const uint32_t *topology = (const uint32_t *)(data + sizeof(Header));
+    mTopology.assign(topology, topology + header->NumLayers);
+    mDataType = (DataType)header->DataType;
+    mNumSamples = (unsigned)header->NumSamples;
+
+    //Empty dimensions and sizes that wrap around are corrupt headers, not empty datasets
+    uint64_t valueSize = GetDataTypeSize(mDataType);
+    uint64_t inputsSize = 0;
+    uint64_t targetsSize = 0;
+    if (header->NumSamples > UINT_MAX ||
+        !GetMatrixSize(header->NumSamples, mTopology.front(), valueSize, inputsSize) ||
+        !GetMatrixSize(header->NumSamples, mTopology.back(), valueSize, targetsSize) ||
+        header->InputsOffset % Alignment != 0 || header->TargetsOffset % Alignment != 0 ||
+        header->InputsOffset > mFile.GetSize() || inputsSize > mFile.GetSize() - header->InputsOffset ||
+        header->TargetsOffset < header->InputsOffset + inputsSize ||
+        header->TargetsOffset > mFile.GetSize() || targetsSize > mFile.GetSize() - header->TargetsOffset)
+    {
+        Close();
+        return false;
+    }
+
+    mInputs = data + header->InputsOffset;
+    mTargets = data + header->TargetsOffset;
+    return true;
+}
+
+void BinaryDataset::Close()
+{
+    mFile.Close();
+    mTopology.clear();
+    mNumSamples = 0;
+    mInputs = nullptr;
+    mTargets = nullptr;
+}
+
+bool BinaryDataset::IsBinaryDataset(const std::string &filename)
+{
+    std::ifstream file(filename.c_str(), std::ios::binary);
+    char magic[sizeof(Magic)];
+    return file.read(magic, sizeof(magic)) && memcmp(magic, Magic, sizeof(Magic)) == 0;
+}
+
+BinaryDatasetWriter::BinaryDatasetWriter()
+{
+    mDataType = Float64;
+    mNumSamples = 0;
+    mInputsOffset = 0;
+    mOpen = false;
+}
+
+BinaryDatasetWriter::~BinaryDatasetWriter()
+{
+    if (mOpen)
+        Close();
+}
+
+bool BinaryDatasetWriter::Open(const std::string &filename, const std::vector<unsigned> &topology, DataType dataType)
+{
+    if (mOpen || topology.size() < 2)
+        return false;
+
+    mFilename = filename;
+    mTopology = topology;
+    mDataType = dataType;
+    mNumSamples = 0;
+
+    mFile.open(filename.c_str(), std::ios::binary | std::ios::trunc);
+    mTargetsFile.open((filename + ".targets").c_str(), std::ios::binary | std::ios::trunc);
+    if (!mFile.is_open() || !mTargetsFile.is_open())
+    {
+        Abort();
+        return false;
+    }
+
+    //The header is rewritten by Close once the amount of samples is known
+    Header header;
+    memset(&header, 0, sizeof(header));
+    mFile.write((const char *)&header, sizeof(header));
+
+    std::vector<uint32_t> sizes(topology.begin(), topology.end());
+    mFile.write((const char *)sizes.data(), sizes.size() * sizeof(uint32_t));
+
+    mInputsOffset = Align(sizeof(Header) + sizes.size() * sizeof(uint32_t));
+    std::vector<char> padding((size_t)(mInputsOffset - sizeof(Header) - sizes.size() * sizeof(uint32_t)), 0);
+    mFile.write(padding.data(), padding.size());
+    if (!mFile.good())
+    {
+        Abort();
+        return false;
+    }
+
+    mOpen = true;
+    return true;
+}
+
+void BinaryDatasetWriter::Write(const double *inputVals, const double *targetVals)
+{
+    WriteSample(inputVals, targetVals);
+}
+
+void BinaryDatasetWriter::Write(const float *inputVals, const float *targetVals)
+{
+    WriteSample(inputVals, targetVals);
+}
+
+template <typename T>
+void BinaryDatasetWriter::WriteSample(const T *inputVals, const T *targetVals)
+{
+    WriteValues(mFile, inputVals, mTopology.front());
+    WriteValues(mTargetsFile, targetVals, mTopology.back());
+    mNumSamples++;
+}
+
+template <typename T>
+void BinaryDatasetWriter::WriteValues(std::ofstream &file, const T *values, unsigned count)
+{
+    if (mDataType == DataTypeOf<T>::Value)
+    {
+        file.write((const char *)values, count * sizeof(T));
+        return;
+    }
+
+    //Convert to the file data type
+    mBuffer.resize(count * GetDataTypeSize(mDataType));
+    if (mDataType == Float32)
+    {
+        float *converted = (float *)mBuffer.data();
+        for (unsigned i = 0; i < count; i++)
+            converted[i] = (float)values[i];
+    }
+    else
+    {
+        double *converted = (double *)mBuffer.data();
+        for (unsigned i = 0; i < count; i++)
+            converted[i] = (double)values[i];
+    }
+    file.write(mBuffer.data(), mBuffer.size());
+}
+
+bool BinaryDatasetWriter::Close()
+{
+    if (!mOpen)
+        return false;
+    mOpen = false;
+
+    std::string targetsFilename = mFilename + ".targets";
+    mTargetsFile.close();
+    if (!mTargetsFile.good() || !mFile.good())
+    {
+        Abort();
+        return false;
+    }
+
+    //Pad the inputs up to the targets matrix and append them
+    uint64_t inputsEnd = mInputsOffset + (uint64_t)mNumSamples * mTopology.front() * GetDataTypeSize(mDataType);
+    uint64_t targetsOffset = Align(inputsEnd);
+    std::vector<char> buffer((size_t)(targetsOffset - inputsEnd), 0);
+    mFile.write(buffer.data(), buffer.size());
+
+    //Every target written has to make it back, a short copy leaves a truncated dataset
+    uint64_t targetsSize = (uint64_t)mNumSamples * mTopology.back() * GetDataTypeSize(mDataType);
+    uint64_t copied = 0;
+    std::ifstream targetsFile(targetsFilename.c_str(), std::ios::binary);
+    buffer.resize(1 << 20);
+    while (mFile.good() && (targetsFile.read(buffer.data(), buffer.size()) || targetsFile.gcount() > 0))
+    {
+        mFile.write(buffer.data(), targetsFile.gcount());
+        copied += targetsFile.gcount();
+    }
+    bool copyFailed = targetsFile.bad() || !targetsFile.eof() || copied != targetsSize || !mFile.good();
+    targetsFile.close();
+    if (copyFailed)
+    {
+        Abort();
+        return false;
+    }
+    std::remove(targetsFilename.c_str());
+
+    Header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.Magic, Magic, sizeof(Magic));
+    header.Version = Version;
+    header.DataType = mDataType;
+    header.NumLayers = (uint32_t)mTopology.size();
+    header.NumSamples = mNumSamples;
+    header.InputsOffset = mInputsOffset;
+    header.TargetsOffset = targetsOffset;
+
+    mFile.seekp(0);
+    mFile.write((const char *)&header, sizeof(header));
+
+    mFile.close();
+    if (!mFile.good())
+    {
+        std::remove(mFilename.c_str());
+        return false;
+    }
+    return true;
+}
+
+void BinaryDatasetWriter::Abort()
+{
+    //Leaves neither a half written dataset nor the temporary targets behind
+    mOpen = false;
+    if (mFile.is_open())
+        mFile.close();
+    if (mTargetsFile.is_open())
+        mTargetsFile.close();
+    mFile.clear();
+    mTargetsFile.clear();
+    std::remove(mFilename.c_str());
+    std::remove((mFilename + ".targets").c_str());
+}
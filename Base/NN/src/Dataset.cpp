@@ -0,0 +1,235 @@
+
+#include "Dataset.h"
+#include "BinaryDataset.h"
+#include <algorithm>
+#include <cstring>
+
+template <typename T>
+DatasetT<T>::DatasetT()
+{
+    mNumSamples = 0;
+    mBatch.NumSamples = 0;
+}
+
+template <typename T>
+bool DatasetT<T>::Load(const std::string &filename)
+{
+    mTopology.clear();
+    mInputs.clear();
+    mTargets.clear();
+    mWeights.clear();
+    mNumSamples = 0;
+
+    bool loaded = BinaryDataset::IsBinaryDataset(filename) ? LoadBinary(filename) : LoadText(filename);
+    if (!loaded)
+        return false;
+
+    mNumSamples = (unsigned)(mInputs.size() / GetNumInputs());
+    ResetOrder();
+    return true;
+}
+
+template <typename T>
+bool DatasetT<T>::LoadBinary(const std::string &filename)
+{
+    BinaryDataset dataset;
+    if (!dataset.Open(filename))
+        return false;
+
+    mTopology = dataset.GetTopology();
+    size_t numInputs = (size_t)dataset.GetNumSamples() * dataset.GetNumInputs();
+    size_t numTargets = (size_t)dataset.GetNumSamples() * dataset.GetNumOutputs();
+
+    //One pass over the mapping, converting if the file holds the other precision
+    if (dataset.GetDataType() == BinaryDatasetFormat::Float32)
+    {
+        mInputs.assign(dataset.GetInputs<float>(), dataset.GetInputs<float>() + numInputs);
+        mTargets.assign(dataset.GetTargets<float>(), dataset.GetTargets<float>() + numTargets);
+    }
+    else
+    {
+        mInputs.assign(dataset.GetInputs<double>(), dataset.GetInputs<double>() + numInputs);
+        mTargets.assign(dataset.GetTargets<double>(), dataset.GetTargets<double>() + numTargets);
+    }
+
+    return true;
+}
+
+template <typename T>
+bool DatasetT<T>::LoadText(const std::string &filename)
+{
+    TextDatasetReaderT<T> reader;
+    if (!reader.Open(filename, 4096))
+        return false;
+
+    mTopology = reader.GetTopology();
+    while (const SampleBatch<T> *batch = reader.NextBatch())
+    {
+        mInputs.insert(mInputs.end(), batch->Inputs.begin(), batch->Inputs.begin() + batch->NumSamples * GetNumInputs());
+        mTargets.insert(mTargets.end(), batch->Targets.begin(), batch->Targets.begin() + batch->NumSamples * GetNumOutputs());
+    }
+
+    return true;
+}
+
+template <typename T>
+void DatasetT<T>::Shuffle(Random &random, unsigned batchSize)
+{
+    for (unsigned i = mNumSamples; i > 1; i--)
+        std::swap(mOrder[i - 1], mOrder[random.NextUnsigned(i)]);
+
+    //The gradient of a batch does not depend on the order of its samples,
+    //reading them in ascending memory order lets the hardware prefetcher follow the gather
+    if (batchSize > 1)
+    {
+        for (unsigned first = 0; first < mNumSamples; first += batchSize)
+            std::sort(mOrder.begin() + first, mOrder.begin() + std::min(first + batchSize, mNumSamples));
+    }
+}
+
+template <typename T>
+void DatasetT<T>::ResetOrder()
+{
+    mOrder.resize(mNumSamples);
+    for (unsigned i = 0; i < mNumSamples; i++)
+        mOrder[i] = i;
+}
+
+template <typename T>
+void DatasetT<T>::Split(double fraction, Random &random, DatasetT<T> &holdout)
+{
+    unsigned numHoldout = (unsigned)(mNumSamples * std::min(std::max(fraction, 0.0), 1.0) + 0.5);
+    unsigned numKept = mNumSamples - numHoldout;
+
+    //The last samples of a shuffled order go to the holdout, both sides are then rebuilt contiguous
+    ResetOrder();
+    Shuffle(random);
+    std::sort(mOrder.begin(), mOrder.begin() + numKept);
+    std::sort(mOrder.begin() + numKept, mOrder.end());
+
+    unsigned numInputs = GetNumInputs();
+    unsigned numOutputs = GetNumOutputs();
+    std::vector<T> inputs((size_t)numKept * numInputs), targets((size_t)numKept * numOutputs);
+    holdout.mTopology = mTopology;
+    holdout.mNumSamples = numHoldout;
+    holdout.mInputs.resize((size_t)numHoldout * numInputs);
+    holdout.mTargets.resize((size_t)numHoldout * numOutputs);
+    //The weights of a compacted dataset go along with their samples
+    std::vector<T> weights(mWeights.empty() ? 0 : numKept);
+    holdout.mWeights.resize(mWeights.empty() ? 0 : numHoldout);
+
+    for (unsigned position = 0; position < mNumSamples; position++)
+    {
+        size_t sampleIdx = mOrder[position];
+        bool kept = position < numKept;
+        size_t row = kept ? position : position - numKept;
+        memcpy(kept ? &inputs[row * numInputs] : &holdout.mInputs[row * numInputs], &mInputs[sampleIdx * numInputs], numInputs * sizeof(T));
+        memcpy(kept ? &targets[row * numOutputs] : &holdout.mTargets[row * numOutputs], &mTargets[sampleIdx * numOutputs], numOutputs * sizeof(T));
+        if (!mWeights.empty())
+            (kept ? weights[row] : holdout.mWeights[row]) = mWeights[sampleIdx];
+    }
+
+    mInputs.swap(inputs);
+    mTargets.swap(targets);
+    mWeights.swap(weights);
+    mNumSamples = numKept;
+    ResetOrder();
+    holdout.ResetOrder();
+}
+
+template <typename T>
+unsigned DatasetT<T>::Compact()
+{
+    unsigned numInputs = GetNumInputs();
+    unsigned numOutputs = GetNumOutputs();
+    if (mWeights.empty())
+        mWeights.assign(mNumSamples, (T)1);
+
+    //Open addressing over the FNV-1a hash of the input and target bytes, at most half full.
+    //The slots hold unique sample index + 1, equal hashes are compared byte by byte
+    size_t numSlots = 16;
+    while (numSlots < (size_t)mNumSamples * 2)
+        numSlots *= 2;
+    std::vector<unsigned> slots(numSlots, 0);
+    std::vector<uint64_t> hashes;
+
+    unsigned numUnique = 0;
+    for (unsigned sampleIdx = 0; sampleIdx < mNumSamples; sampleIdx++)
+    {
+        const T *inputs = &mInputs[(size_t)sampleIdx * numInputs];
+        const T *targets = &mTargets[(size_t)sampleIdx * numOutputs];
+
+        uint64_t hash = 14695981039346656037ULL;
+        const unsigned char *bytes = (const unsigned char *)inputs;
+        for (size_t i = 0; i < numInputs * sizeof(T); i++)
+            hash = (hash ^ bytes[i]) * 1099511628211ULL;
+        bytes = (const unsigned char *)targets;
+        for (size_t i = 0; i < numOutputs * sizeof(T); i++)
+            hash = (hash ^ bytes[i]) * 1099511628211ULL;
+
+        size_t slot = (size_t)hash & (numSlots - 1);
+        while (slots[slot] != 0)
+        {
+            unsigned uniqueIdx = slots[slot] - 1;
+            if (hashes[uniqueIdx] == hash &&
+                memcmp(&mInputs[(size_t)uniqueIdx * numInputs], inputs, numInputs * sizeof(T)) == 0 &&
+                memcmp(&mTargets[(size_t)uniqueIdx * numOutputs], targets, numOutputs * sizeof(T)) == 0)
+            {
+                break;
+            }
+            slot = (slot + 1) & (numSlots - 1);
+        }
+
+        if (slots[slot] != 0)
+        {
+            mWeights[slots[slot] - 1] += mWeights[sampleIdx];
+            continue;
+        }
+
+        //New unique sample, moved down next to the previous one (never past sampleIdx, the rows are not overwritten before being read)
+        if (numUnique != sampleIdx)
+        {
+            memmove(&mInputs[(size_t)numUnique * numInputs], inputs, numInputs * sizeof(T));
+            memmove(&mTargets[(size_t)numUnique * numOutputs], targets, numOutputs * sizeof(T));
+            mWeights[numUnique] = mWeights[sampleIdx];
+        }
+        hashes.push_back(hash);
+        slots[slot] = ++numUnique;
+    }
+
+    mNumSamples = numUnique;
+    mInputs.resize((size_t)numUnique * numInputs);
+    mTargets.resize((size_t)numUnique * numOutputs);
+    mWeights.resize(numUnique);
+    mInputs.shrink_to_fit();
+    mTargets.shrink_to_fit();
+    ResetOrder();
+    return numUnique;
+}
+
+template <typename T>
+const SampleBatch<T> &DatasetT<T>::GatherBatch(unsigned first, unsigned batchSize)
+{
+    unsigned numInputs = GetNumInputs();
+    unsigned numOutputs = GetNumOutputs();
+    batchSize = std::min(batchSize, mNumSamples - first);
+
+    if (mBatch.Inputs.size() < (size_t)batchSize * numInputs)
+    {
+        mBatch.Inputs.resize((size_t)batchSize * numInputs);
+        mBatch.Targets.resize((size_t)batchSize * numOutputs);
+    }
+
+    for (unsigned i = 0; i < batchSize; i++)
+    {
+        size_t sampleIdx = mOrder[first + i];
+        memcpy(&mBatch.Inputs[i * numInputs], &mInputs[sampleIdx * numInputs], numInputs * sizeof(T));
+        memcpy(&mBatch.Targets[i * numOutputs], &mTargets[sampleIdx * numOutputs], numOutputs * sizeof(T));
+    }
+
+    mBatch.NumSamples = batchSize;
+    return mBatch;
+}
+
+template class DatasetT<double>;
+template class DatasetT<float>;
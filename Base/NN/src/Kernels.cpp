@@ -0,0 +1,1242 @@
+
+#include "Kernels.h"
+#include "Activation.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define KERNELS_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+//Gcc and clang only emit vector instructions for the functions tagged with the target,
+//msvc emits them anywhere so the tag is empty there (the dispatch keeps them from running on older cpus)
+#if defined(_MSC_VER)
+#define KERNELS_TARGET(x)
+#else
+#define KERNELS_TARGET(x) __attribute__((target(x)))
+#endif
+
+//AVX-512 intrinsics need at least Visual Studio 2017
+#if defined(KERNELS_X86) && (!defined(_MSC_VER) || _MSC_VER >= 1910)
+#define KERNELS_AVX512 1
+#endif
+
+//Every kernel is written once per instruction set as a template over the scalar type,
+//the <ISA>Register<T> structs map the double and float versions to the matching intrinsics
+namespace Kernels
+{
+    //Scalar fallback
+    template <typename T>
+    T DotScalar(const T *a, const T *b, unsigned count)
+    {
+        T sum = 0;
+        for (unsigned i = 0; i < count; i++)
+            sum += a[i] * b[i];
+
+        return sum;
+    }
+
+    template <typename T>
+    void AxpyScalar(T alpha, const T *x, T *y, unsigned count)
+    {
+        for (unsigned i = 0; i < count; i++)
+            y[i] += alpha * x[i];
+    }
+
+    template <typename T>
+    void UpdateWeightsScalar(T scale, const T *inputs, T momentum, T *deltas, T *weights, unsigned count)
+    {
+        for (unsigned i = 0; i < count; i++)
+        {
+            T delta = scale * inputs[i] + momentum * deltas[i];
+            deltas[i] = delta;
+            weights[i] += delta;
+        }
+    }
+
+    template <typename T>
+    void Dot4Scalar(const T *a, unsigned stride, const T *b, unsigned count, T result[4])
+    {
+        for (unsigned r = 0; r < 4; r++)
+            result[r] = DotScalar(a + r * stride, b, count);
+    }
+
+    template <typename T>
+    void ColumnDotScalar(const T *a, const T *b, unsigned stride, unsigned rows, T *result, unsigned count)
+    {
+        for (unsigned i = 0; i < count; i++)
+        {
+            T sum = 0;
+            for (unsigned r = 0; r < rows; r++)
+                sum += a[r * stride + i] * b[r * stride + i];
+
+            result[i] = sum;
+        }
+    }
+
+    template <typename T>
+    void RationalTanhScalar(T *values, unsigned count)
+    {
+        for (unsigned i = 0; i < count; i++)
+            values[i] = Activation::RationalTanhValue(values[i]);
+    }
+
+    template <typename T>
+    void TableTanhScalar(T *values, unsigned count, T inputScale, T outputScale, T outputOffset)
+    {
+        for (unsigned i = 0; i < count; i++)
+            values[i] = outputOffset + outputScale * Activation::TableTanhValue(inputScale * values[i]);
+    }
+
+    template <typename T>
+    void ReluScalar(T *values, unsigned count)
+    {
+        for (unsigned i = 0; i < count; i++)
+            values[i] = values[i] > 0 ? values[i] : 0;
+    }
+
+#if defined(KERNELS_X86)
+    //SSE2, 2 doubles or 4 floats per register (MulAdd is a separate multiply and add, there is no FMA)
+    template <typename T> struct SSE2Register;
+
+    template <> struct SSE2Register<double>
+    {
+        typedef __m128d Type;
+        static const unsigned Width = 2;
+        KERNELS_TARGET("sse2") static Type Zero() { return _mm_setzero_pd(); }
+        KERNELS_TARGET("sse2") static Type Set(double x) { return _mm_set1_pd(x); }
+        KERNELS_TARGET("sse2") static Type Load(const double *p) { return _mm_loadu_pd(p); }
+        KERNELS_TARGET("sse2") static void Store(double *p, Type x) { _mm_storeu_pd(p, x); }
+        KERNELS_TARGET("sse2") static Type Add(Type a, Type b) { return _mm_add_pd(a, b); }
+        KERNELS_TARGET("sse2") static Type Sub(Type a, Type b) { return _mm_sub_pd(a, b); }
+        KERNELS_TARGET("sse2") static Type Mul(Type a, Type b) { return _mm_mul_pd(a, b); }
+        KERNELS_TARGET("sse2") static Type Div(Type a, Type b) { return _mm_div_pd(a, b); }
+        KERNELS_TARGET("sse2") static Type Min(Type a, Type b) { return _mm_min_pd(a, b); }
+        KERNELS_TARGET("sse2") static Type Max(Type a, Type b) { return _mm_max_pd(a, b); }
+        KERNELS_TARGET("sse2") static Type MulAdd(Type a, Type b, Type c) { return _mm_add_pd(_mm_mul_pd(a, b), c); }
+        //Tables: truncation to 32 bit lanes and the table values at those indices (one load per lane, SSE2 has no gather)
+        typedef __m128i Index;
+        KERNELS_TARGET("sse2") static Index ToIndex(Type x) { return _mm_cvttpd_epi32(x); }
+        KERNELS_TARGET("sse2") static Type FromIndex(Index i) { return _mm_cvtepi32_pd(i); }
+        KERNELS_TARGET("sse2") static Type Gather(const double *table, Index i)
+        {
+            int32_t lanes[4];
+            _mm_storeu_si128((__m128i *)lanes, i);
+            return _mm_set_pd(table[lanes[1]], table[lanes[0]]);
+        }
+        KERNELS_TARGET("sse2") static double Sum(Type x) { return _mm_cvtsd_f64(_mm_add_sd(x, _mm_unpackhi_pd(x, x))); }
+    };
+
+    template <> struct SSE2Register<float>
+    {
+        typedef __m128 Type;
+        static const unsigned Width = 4;
+        KERNELS_TARGET("sse2") static Type Zero() { return _mm_setzero_ps(); }
+        KERNELS_TARGET("sse2") static Type Set(float x) { return _mm_set1_ps(x); }
+        KERNELS_TARGET("sse2") static Type Load(const float *p) { return _mm_loadu_ps(p); }
+        KERNELS_TARGET("sse2") static void Store(float *p, Type x) { _mm_storeu_ps(p, x); }
+        KERNELS_TARGET("sse2") static Type Add(Type a, Type b) { return _mm_add_ps(a, b); }
+        KERNELS_TARGET("sse2") static Type Sub(Type a, Type b) { return _mm_sub_ps(a, b); }
+        KERNELS_TARGET("sse2") static Type Mul(Type a, Type b) { return _mm_mul_ps(a, b); }
+        KERNELS_TARGET("sse2") static Type Div(Type a, Type b) { return _mm_div_ps(a, b); }
+        KERNELS_TARGET("sse2") static Type Min(Type a, Type b) { return _mm_min_ps(a, b); }
+        KERNELS_TARGET("sse2") static Type Max(Type a, Type b) { return _mm_max_ps(a, b); }
+        KERNELS_TARGET("sse2") static Type MulAdd(Type a, Type b, Type c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+        typedef __m128i Index;
+        KERNELS_TARGET("sse2") static Index ToIndex(Type x) { return _mm_cvttps_epi32(x); }
+        KERNELS_TARGET("sse2") static Type FromIndex(Index i) { return _mm_cvtepi32_ps(i); }
+        KERNELS_TARGET("sse2") static Type Gather(const float *table, Index i)
+        {
+            int32_t lanes[4];
+            _mm_storeu_si128((__m128i *)lanes, i);
+            return _mm_set_ps(table[lanes[3]], table[lanes[2]], table[lanes[1]], table[lanes[0]]);
+        }
+        KERNELS_TARGET("sse2") static float Sum(Type x)
+        {
+            x = _mm_add_ps(x, _mm_movehl_ps(x, x));
+            return _mm_cvtss_f32(_mm_add_ss(x, _mm_shuffle_ps(x, x, 1)));
+        }
+    };
+
+    template <typename T>
+    KERNELS_TARGET("sse2")
+    T DotSSE2(const T *a, const T *b, unsigned count)
+    {
+        typedef SSE2Register<T> R;
+        typename R::Type sum0 = R::Zero();
+        typename R::Type sum1 = R::Zero();
+
+        unsigned i = 0;
+        for (; i + 2 * R::Width <= count; i += 2 * R::Width)
+        {
+            sum0 = R::Add(sum0, R::Mul(R::Load(a + i), R::Load(b + i)));
+            sum1 = R::Add(sum1, R::Mul(R::Load(a + i + R::Width), R::Load(b + i + R::Width)));
+        }
+
+        T sum = R::Sum(R::Add(sum0, sum1));
+        for (; i < count; i++)
+            sum += a[i] * b[i];
+
+        return sum;
+    }
+
+    template <typename T>
+    KERNELS_TARGET("sse2")
+    void AxpySSE2(T alpha, const T *x, T *y, unsigned count)
+    {
+        typedef SSE2Register<T> R;
+        typename R::Type a = R::Set(alpha);
+
+        unsigned i = 0;
+        for (; i + R::Width <= count; i += R::Width)
+            R::Store(y + i, R::Add(R::Load(y + i), R::Mul(a, R::Load(x + i))));
+
+        for (; i < count; i++)
+            y[i] += alpha * x[i];
+    }
+
+    template <typename T>
+    KERNELS_TARGET("sse2")
+    void UpdateWeightsSSE2(T scale, const T *inputs, T momentum, T *deltas, T *weights, unsigned count)
+    {
+        typedef SSE2Register<T> R;
+        typename R::Type s = R::Set(scale);
+        typename R::Type m = R::Set(momentum);
+
+        unsigned i = 0;
+        for (; i + R::Width <= count; i += R::Width)
+        {
+            typename R::Type delta = R::Add(R::Mul(s, R::Load(inputs + i)), R::Mul(m, R::Load(deltas + i)));
+            R::Store(deltas + i, delta);
+            R::Store(weights + i, R::Add(R::Load(weights + i), delta));
+        }
+
+        UpdateWeightsScalar(scale, inputs + i, momentum, deltas + i, weights + i, count - i);
+    }
+
+    template <typename T>
+    KERNELS_TARGET("sse2")
+    void Dot4SSE2(const T *a, unsigned stride, const T *b, unsigned count, T result[4])
+    {
+        typedef SSE2Register<T> R;
+        const T *a0 = a, *a1 = a + stride, *a2 = a + 2 * stride, *a3 = a + 3 * stride;
+        typename R::Type sum0 = R::Zero(), sum1 = R::Zero(), sum2 = R::Zero(), sum3 = R::Zero();
+
+        unsigned i = 0;
+        for (; i + R::Width <= count; i += R::Width)
+        {
+            typename R::Type bv = R::Load(b + i);
+            sum0 = R::Add(sum0, R::Mul(R::Load(a0 + i), bv));
+            sum1 = R::Add(sum1, R::Mul(R::Load(a1 + i), bv));
+            sum2 = R::Add(sum2, R::Mul(R::Load(a2 + i), bv));
+            sum3 = R::Add(sum3, R::Mul(R::Load(a3 + i), bv));
+        }
+
+        result[0] = R::Sum(sum0);
+        result[1] = R::Sum(sum1);
+        result[2] = R::Sum(sum2);
+        result[3] = R::Sum(sum3);
+        for (; i < count; i++)
+        {
+            result[0] += a0[i] * b[i];
+            result[1] += a1[i] * b[i];
+            result[2] += a2[i] * b[i];
+            result[3] += a3[i] * b[i];
+        }
+    }
+
+    template <typename T>
+    KERNELS_TARGET("sse2")
+    void ColumnDotSSE2(const T *a, const T *b, unsigned stride, unsigned rows, T *result, unsigned count)
+    {
+        typedef SSE2Register<T> R;
+
+        unsigned i = 0;
+        for (; i + R::Width <= count; i += R::Width)
+        {
+            typename R::Type sum = R::Zero();
+            for (unsigned r = 0; r < rows; r++)
+                sum = R::Add(sum, R::Mul(R::Load(a + r * stride + i), R::Load(b + r * stride + i)));
+
+            R::Store(result + i, sum);
+        }
+
+        for (; i < count; i++)
+        {
+            T sum = 0;
+            for (unsigned r = 0; r < rows; r++)
+                sum += a[r * stride + i] * b[r * stride + i];
+
+            result[i] = sum;
+        }
+    }
+
+    template <typename T>
+    KERNELS_TARGET("sse2")
+    void RationalTanhSSE2(T *values, unsigned count)
+    {
+        typedef SSE2Register<T> R;
+        typename R::Type limit = R::Set((T)Activation::RationalTanhLimit), negativeLimit = R::Set((T)-Activation::RationalTanhLimit);
+        typename R::Type one = R::Set((T)1), negativeOne = R::Set((T)-1);
+        typename R::Type n0 = R::Set((T)Activation::RationalTanhNumerator[0]), n1 = R::Set((T)Activation::RationalTanhNumerator[1]);
+        typename R::Type n2 = R::Set((T)Activation::RationalTanhNumerator[2]), n3 = R::Set((T)Activation::RationalTanhNumerator[3]);
+        typename R::Type d0 = R::Set((T)Activation::RationalTanhDenominator[0]), d1 = R::Set((T)Activation::RationalTanhDenominator[1]);
+        typename R::Type d2 = R::Set((T)Activation::RationalTanhDenominator[2]), d3 = R::Set((T)Activation::RationalTanhDenominator[3]);
+
+        unsigned i = 0;
+        for (; i + R::Width <= count; i += R::Width)
+        {
+            typename R::Type x = R::Min(R::Max(R::Load(values + i), negativeLimit), limit);
+            typename R::Type x2 = R::Mul(x, x);
+            typename R::Type p = R::MulAdd(x2, R::MulAdd(x2, R::MulAdd(x2, n3, n2), n1), n0);
+            typename R::Type q = R::MulAdd(x2, R::MulAdd(x2, R::MulAdd(x2, d3, d2), d1), d0);
+            typename R::Type y = R::Div(R::Mul(x, p), q);
+            R::Store(values + i, R::Min(R::Max(y, negativeOne), one));
+        }
+
+        for (; i < count; i++)
+            values[i] = Activation::RationalTanhValue(values[i]);
+    }
+
+    //outputOffset + outputScale * tanh(inputScale * x), linear interpolation between two gathered table values.
+    //The position is clamped to [0...size], the repeated last sample makes the upper limit exact
+    template <typename T>
+    KERNELS_TARGET("sse2")
+    void TableTanhSSE2(T *values, unsigned count, T inputScale, T outputScale, T outputOffset)
+    {
+        typedef SSE2Register<T> R;
+        const T *table = Activation::GetTanhTable<T>();
+        typename R::Type scale = R::Set((T)(inputScale * Activation::TanhTableSize / (2.0 * Activation::TanhTableLimit)));
+        typename R::Type center = R::Set((T)(Activation::TanhTableSize / 2.0));
+        typename R::Type zero = R::Zero(), size = R::Set((T)Activation::TanhTableSize);
+        typename R::Type outScale = R::Set(outputScale), outOffset = R::Set(outputOffset);
+
+        unsigned i = 0;
+        for (; i + R::Width <= count; i += R::Width)
+        {
+            typename R::Type position = R::Min(R::Max(R::MulAdd(R::Load(values + i), scale, center), zero), size);
+            typename R::Index index = R::ToIndex(position);
+            typename R::Type fraction = R::Sub(position, R::FromIndex(index));
+            typename R::Type low = R::Gather(table, index);
+            typename R::Type y = R::MulAdd(R::Sub(R::Gather(table + 1, index), low), fraction, low);
+            R::Store(values + i, R::MulAdd(y, outScale, outOffset));
+        }
+
+        TableTanhScalar(values + i, count - i, inputScale, outputScale, outputOffset);
+    }
+
+    template <typename T>
+    KERNELS_TARGET("sse2")
+    void ReluSSE2(T *values, unsigned count)
+    {
+        typedef SSE2Register<T> R;
+        typename R::Type zero = R::Zero();
+
+        unsigned i = 0;
+        for (; i + R::Width <= count; i += R::Width)
+            R::Store(values + i, R::Max(R::Load(values + i), zero));
+
+        for (; i < count; i++)
+            values[i] = values[i] > 0 ? values[i] : 0;
+    }
+
+    //AVX2 + FMA, 4 doubles or 8 floats per register
+    template <typename T> struct AVX2Register;
+
+    template <> struct AVX2Register<double>
+    {
+        typedef __m256d Type;
+        static const unsigned Width = 4;
+        KERNELS_TARGET("avx2,fma") static Type Zero() { return _mm256_setzero_pd(); }
+        KERNELS_TARGET("avx2,fma") static Type Set(double x) { return _mm256_set1_pd(x); }
+        KERNELS_TARGET("avx2,fma") static Type Load(const double *p) { return _mm256_loadu_pd(p); }
+        KERNELS_TARGET("avx2,fma") static void Store(double *p, Type x) { _mm256_storeu_pd(p, x); }
+        KERNELS_TARGET("avx2,fma") static Type Add(Type a, Type b) { return _mm256_add_pd(a, b); }
+        KERNELS_TARGET("avx2,fma") static Type Sub(Type a, Type b) { return _mm256_sub_pd(a, b); }
+        KERNELS_TARGET("avx2,fma") static Type Mul(Type a, Type b) { return _mm256_mul_pd(a, b); }
+        KERNELS_TARGET("avx2,fma") static Type Div(Type a, Type b) { return _mm256_div_pd(a, b); }
+        KERNELS_TARGET("avx2,fma") static Type Min(Type a, Type b) { return _mm256_min_pd(a, b); }
+        KERNELS_TARGET("avx2,fma") static Type Max(Type a, Type b) { return _mm256_max_pd(a, b); }
+        KERNELS_TARGET("avx2,fma") static Type MulAdd(Type a, Type b, Type c) { return _mm256_fmadd_pd(a, b, c); }
+        //Masked gathers with every lane enabled, the plain ones start from an undefined register gcc warns about
+        typedef __m128i Index;
+        KERNELS_TARGET("avx2,fma") static Index ToIndex(Type x) { return _mm256_cvttpd_epi32(x); }
+        KERNELS_TARGET("avx2,fma") static Type FromIndex(Index i) { return _mm256_cvtepi32_pd(i); }
+        KERNELS_TARGET("avx2,fma") static Type Gather(const double *table, Index i) { return _mm256_mask_i32gather_pd(_mm256_setzero_pd(), table, i, _mm256_castsi256_pd(_mm256_set1_epi64x(-1)), 8); }
+        KERNELS_TARGET("avx2,fma") static double Sum(Type x)
+        {
+            __m128d half = _mm_add_pd(_mm256_castpd256_pd128(x), _mm256_extractf128_pd(x, 1));
+            return _mm_cvtsd_f64(_mm_add_sd(half, _mm_unpackhi_pd(half, half)));
+        }
+    };
+
+    template <> struct AVX2Register<float>
+    {
+        typedef __m256 Type;
+        static const unsigned Width = 8;
+        KERNELS_TARGET("avx2,fma") static Type Zero() { return _mm256_setzero_ps(); }
+        KERNELS_TARGET("avx2,fma") static Type Set(float x) { return _mm256_set1_ps(x); }
+        KERNELS_TARGET("avx2,fma") static Type Load(const float *p) { return _mm256_loadu_ps(p); }
+        KERNELS_TARGET("avx2,fma") static void Store(float *p, Type x) { _mm256_storeu_ps(p, x); }
+        KERNELS_TARGET("avx2,fma") static Type Add(Type a, Type b) { return _mm256_add_ps(a, b); }
+        KERNELS_TARGET("avx2,fma") static Type Sub(Type a, Type b) { return _mm256_sub_ps(a, b); }
+        KERNELS_TARGET("avx2,fma") static Type Mul(Type a, Type b) { return _mm256_mul_ps(a, b); }
+        KERNELS_TARGET("avx2,fma") static Type Div(Type a, Type b) { return _mm256_div_ps(a, b); }
+        KERNELS_TARGET("avx2,fma") static Type Min(Type a, Type b) { return _mm256_min_ps(a, b); }
+        KERNELS_TARGET("avx2,fma") static Type Max(Type a, Type b) { return _mm256_max_ps(a, b); }
+        KERNELS_TARGET("avx2,fma") static Type MulAdd(Type a, Type b, Type c) { return _mm256_fmadd_ps(a, b, c); }
+        typedef __m256i Index;
+        KERNELS_TARGET("avx2,fma") static Index ToIndex(Type x) { return _mm256_cvttps_epi32(x); }
+        KERNELS_TARGET("avx2,fma") static Type FromIndex(Index i) { return _mm256_cvtepi32_ps(i); }
+        KERNELS_TARGET("avx2,fma") static Type Gather(const float *table, Index i) { return _mm256_mask_i32gather_ps(_mm256_setzero_ps(), table, i, _mm256_castsi256_ps(_mm256_set1_epi32(-1)), 4); }
+        KERNELS_TARGET("avx2,fma") static float Sum(Type x)
+        {
+            __m128 half = _mm_add_ps(_mm256_castps256_ps128(x), _mm256_extractf128_ps(x, 1));
+            half = _mm_add_ps(half, _mm_movehl_ps(half, half));
+            return _mm_cvtss_f32(_mm_add_ss(half, _mm_shuffle_ps(half, half, 1)));
+        }
+    };
+
+    template <typename T>
+    KERNELS_TARGET("avx2,fma")
+    T DotAVX2(const T *a, const T *b, unsigned count)
+    {
+        typedef AVX2Register<T> R;
+        typename R::Type sum0 = R::Zero();
+        typename R::Type sum1 = R::Zero();
+
+        unsigned i = 0;
+        for (; i + 2 * R::Width <= count; i += 2 * R::Width)
+        {
+            sum0 = R::MulAdd(R::Load(a + i), R::Load(b + i), sum0);
+            sum1 = R::MulAdd(R::Load(a + i + R::Width), R::Load(b + i + R::Width), sum1);
+        }
+        if (i + R::Width <= count)
+        {
+            sum0 = R::MulAdd(R::Load(a + i), R::Load(b + i), sum0);
+            i += R::Width;
+        }
+
+        T sum = R::Sum(R::Add(sum0, sum1));
+        for (; i < count; i++)
+            sum += a[i] * b[i];
+
+        return sum;
+    }
+
+    template <typename T>
+    KERNELS_TARGET("avx2,fma")
+    void AxpyAVX2(T alpha, const T *x, T *y, unsigned count)
+    {
+        typedef AVX2Register<T> R;
+        typename R::Type a = R::Set(alpha);
+
+        unsigned i = 0;
+        for (; i + R::Width <= count; i += R::Width)
+            R::Store(y + i, R::MulAdd(a, R::Load(x + i), R::Load(y + i)));
+
+        for (; i < count; i++)
+            y[i] += alpha * x[i];
+    }
+
+    template <typename T>
+    KERNELS_TARGET("avx2,fma")
+    void UpdateWeightsAVX2(T scale, const T *inputs, T momentum, T *deltas, T *weights, unsigned count)
+    {
+        typedef AVX2Register<T> R;
+        typename R::Type s = R::Set(scale);
+        typename R::Type m = R::Set(momentum);
+
+        unsigned i = 0;
+        for (; i + R::Width <= count; i += R::Width)
+        {
+            typename R::Type delta = R::MulAdd(s, R::Load(inputs + i), R::Mul(m, R::Load(deltas + i)));
+            R::Store(deltas + i, delta);
+            R::Store(weights + i, R::Add(R::Load(weights + i), delta));
+        }
+
+        UpdateWeightsScalar(scale, inputs + i, momentum, deltas + i, weights + i, count - i);
+    }
+
+    template <typename T>
+    KERNELS_TARGET("avx2,fma")
+    void Dot4AVX2(const T *a, unsigned stride, const T *b, unsigned count, T result[4])
+    {
+        typedef AVX2Register<T> R;
+        const T *a0 = a, *a1 = a + stride, *a2 = a + 2 * stride, *a3 = a + 3 * stride;
+        typename R::Type sum0 = R::Zero(), sum1 = R::Zero(), sum2 = R::Zero(), sum3 = R::Zero();
+
+        unsigned i = 0;
+        for (; i + R::Width <= count; i += R::Width)
+        {
+            typename R::Type bv = R::Load(b + i);
+            sum0 = R::MulAdd(R::Load(a0 + i), bv, sum0);
+            sum1 = R::MulAdd(R::Load(a1 + i), bv, sum1);
+            sum2 = R::MulAdd(R::Load(a2 + i), bv, sum2);
+            sum3 = R::MulAdd(R::Load(a3 + i), bv, sum3);
+        }
+
+        result[0] = R::Sum(sum0);
+        result[1] = R::Sum(sum1);
+        result[2] = R::Sum(sum2);
+        result[3] = R::Sum(sum3);
+        for (; i < count; i++)
+        {
+            result[0] += a0[i] * b[i];
+            result[1] += a1[i] * b[i];
+            result[2] += a2[i] * b[i];
+            result[3] += a3[i] * b[i];
+        }
+    }
+
+    template <typename T>
+    KERNELS_TARGET("avx2,fma")
+    void ColumnDotAVX2(const T *a, const T *b, unsigned stride, unsigned rows, T *result, unsigned count)
+    {
+        typedef AVX2Register<T> R;
+
+        unsigned i = 0;
+        for (; i + R::Width <= count; i += R::Width)
+        {
+            typename R::Type sum = R::Zero();
+            for (unsigned r = 0; r < rows; r++)
+                sum = R::MulAdd(R::Load(a + r * stride + i), R::Load(b + r * stride + i), sum);
+
+            R::Store(result + i, sum);
+        }
+
+        for (; i < count; i++)
+        {
+            T sum = 0;
+            for (unsigned r = 0; r < rows; r++)
+                sum += a[r * stride + i] * b[r * stride + i];
+
+            result[i] = sum;
+        }
+    }
+
+    template <typename T>
+    KERNELS_TARGET("avx2,fma")
+    void RationalTanhAVX2(T *values, unsigned count)
+    {
+        typedef AVX2Register<T> R;
+        typename R::Type limit = R::Set((T)Activation::RationalTanhLimit), negativeLimit = R::Set((T)-Activation::RationalTanhLimit);
+        typename R::Type one = R::Set((T)1), negativeOne = R::Set((T)-1);
+        typename R::Type n0 = R::Set((T)Activation::RationalTanhNumerator[0]), n1 = R::Set((T)Activation::RationalTanhNumerator[1]);
+        typename R::Type n2 = R::Set((T)Activation::RationalTanhNumerator[2]), n3 = R::Set((T)Activation::RationalTanhNumerator[3]);
+        typename R::Type d0 = R::Set((T)Activation::RationalTanhDenominator[0]), d1 = R::Set((T)Activation::RationalTanhDenominator[1]);
+        typename R::Type d2 = R::Set((T)Activation::RationalTanhDenominator[2]), d3 = R::Set((T)Activation::RationalTanhDenominator[3]);
+
+        unsigned i = 0;
+        for (; i + R::Width <= count; i += R::Width)
+        {
+            typename R::Type x = R::Min(R::Max(R::Load(values + i), negativeLimit), limit);
+            typename R::Type x2 = R::Mul(x, x);
+            typename R::Type p = R::MulAdd(x2, R::MulAdd(x2, R::MulAdd(x2, n3, n2), n1), n0);
+            typename R::Type q = R::MulAdd(x2, R::MulAdd(x2, R::MulAdd(x2, d3, d2), d1), d0);
+            typename R::Type y = R::Div(R::Mul(x, p), q);
+            R::Store(values + i, R::Min(R::Max(y, negativeOne), one));
+        }
+
+        for (; i < count; i++)
+            values[i] = Activation::RationalTanhValue(values[i]);
+    }
+
+    //outputOffset + outputScale * tanh(inputScale * x), linear interpolation between two gathered table values.
+    //The position is clamped to [0...size], the repeated last sample makes the upper limit exact
+    template <typename T>
+    KERNELS_TARGET("avx2,fma")
+    void TableTanhAVX2(T *values, unsigned count, T inputScale, T outputScale, T outputOffset)
+    {
+        typedef AVX2Register<T> R;
+        const T *table = Activation::GetTanhTable<T>();
+        typename R::Type scale = R::Set((T)(inputScale * Activation::TanhTableSize / (2.0 * Activation::TanhTableLimit)));
+        typename R::Type center = R::Set((T)(Activation::TanhTableSize / 2.0));
+        typename R::Type zero = R::Zero(), size = R::Set((T)Activation::TanhTableSize);
+        typename R::Type outScale = R::Set(outputScale), outOffset = R::Set(outputOffset);
+
+        unsigned i = 0;
+        for (; i + R::Width <= count; i += R::Width)
+        {
+            typename R::Type position = R::Min(R::Max(R::MulAdd(R::Load(values + i), scale, center), zero), size);
+            typename R::Index index = R::ToIndex(position);
+            typename R::Type fraction = R::Sub(position, R::FromIndex(index));
+            typename R::Type low = R::Gather(table, index);
+            typename R::Type y = R::MulAdd(R::Sub(R::Gather(table + 1, index), low), fraction, low);
+            R::Store(values + i, R::MulAdd(y, outScale, outOffset));
+        }
+
+        TableTanhScalar(values + i, count - i, inputScale, outputScale, outputOffset);
+    }
+
+    template <typename T>
+    KERNELS_TARGET("avx2,fma")
+    void ReluAVX2(T *values, unsigned count)
+    {
+        typedef AVX2Register<T> R;
+        typename R::Type zero = R::Zero();
+
+        unsigned i = 0;
+        for (; i + R::Width <= count; i += R::Width)
+            R::Store(values + i, R::Max(R::Load(values + i), zero));
+
+        for (; i < count; i++)
+            values[i] = values[i] > 0 ? values[i] : 0;
+    }
+#endif
+
+#if defined(KERNELS_AVX512)
+    //AVX-512, 8 doubles or 16 floats per register, the tails use masked loads instead of scalar loops
+    template <typename T> struct AVX512Register;
+
+    template <> struct AVX512Register<double>
+    {
+        typedef __m512d Type;
+        typedef __mmask8 Mask;
+        static const unsigned Width = 8;
+        KERNELS_TARGET("avx512f") static Mask GetMask(unsigned left) { return left >= Width ? (Mask)0xFF : (Mask)((1u << left) - 1); }
+        KERNELS_TARGET("avx512f") static Type Zero() { return _mm512_setzero_pd(); }
+        KERNELS_TARGET("avx512f") static Type Set(double x) { return _mm512_set1_pd(x); }
+        KERNELS_TARGET("avx512f") static Type Load(Mask mask, const double *p) { return _mm512_maskz_loadu_pd(mask, p); }
+        KERNELS_TARGET("avx512f") static void Store(Mask mask, double *p, Type x) { _mm512_mask_storeu_pd(p, mask, x); }
+        KERNELS_TARGET("avx512f") static Type Add(Type a, Type b) { return _mm512_add_pd(a, b); }
+        KERNELS_TARGET("avx512f") static Type Sub(Type a, Type b) { return _mm512_sub_pd(a, b); }
+        KERNELS_TARGET("avx512f") static Type Mul(Type a, Type b) { return _mm512_mul_pd(a, b); }
+        KERNELS_TARGET("avx512f") static Type Div(Type a, Type b) { return _mm512_div_pd(a, b); }
+        //Merge masked min/max, the plain intrinsics start from an undefined register gcc warns about
+        KERNELS_TARGET("avx512f") static Type Min(Type a, Type b) { return _mm512_mask_min_pd(a, (Mask)0xFF, a, b); }
+        KERNELS_TARGET("avx512f") static Type Max(Type a, Type b) { return _mm512_mask_max_pd(a, (Mask)0xFF, a, b); }
+        KERNELS_TARGET("avx512f") static Type MulAdd(Type a, Type b, Type c) { return _mm512_fmadd_pd(a, b, c); }
+        //Masked conversions and gathers for the same reason
+        typedef __m256i Index;
+        KERNELS_TARGET("avx512f") static Index ToIndex(Type x) { return _mm512_maskz_cvttpd_epi32((Mask)0xFF, x); }
+        KERNELS_TARGET("avx512f") static Type FromIndex(Index i) { return _mm512_maskz_cvtepi32_pd((Mask)0xFF, i); }
+        KERNELS_TARGET("avx512f") static Type Gather(const double *table, Index i) { return _mm512_mask_i32gather_pd(_mm512_setzero_pd(), (Mask)0xFF, i, table, 8); }
+        KERNELS_TARGET("avx512f") static double Sum(Type x)
+        {
+            double lanes[8];
+            _mm512_storeu_pd(lanes, x);
+            return ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) + ((lanes[4] + lanes[5]) + (lanes[6] + lanes[7]));
+        }
+    };
+
+    template <> struct AVX512Register<float>
+    {
+        typedef __m512 Type;
+        typedef __mmask16 Mask;
+        static const unsigned Width = 16;
+        KERNELS_TARGET("avx512f") static Mask GetMask(unsigned left) { return left >= Width ? (Mask)0xFFFF : (Mask)((1u << left) - 1); }
+        KERNELS_TARGET("avx512f") static Type Zero() { return _mm512_setzero_ps(); }
+        KERNELS_TARGET("avx512f") static Type Set(float x) { return _mm512_set1_ps(x); }
+        KERNELS_TARGET("avx512f") static Type Load(Mask mask, const float *p) { return _mm512_maskz_loadu_ps(mask, p); }
+        KERNELS_TARGET("avx512f") static void Store(Mask mask, float *p, Type x) { _mm512_mask_storeu_ps(p, mask, x); }
+        KERNELS_TARGET("avx512f") static Type Add(Type a, Type b) { return _mm512_add_ps(a, b); }
+        KERNELS_TARGET("avx512f") static Type Sub(Type a, Type b) { return _mm512_sub_ps(a, b); }
+        KERNELS_TARGET("avx512f") static Type Mul(Type a, Type b) { return _mm512_mul_ps(a, b); }
+        KERNELS_TARGET("avx512f") static Type Div(Type a, Type b) { return _mm512_div_ps(a, b); }
+        KERNELS_TARGET("avx512f") static Type Min(Type a, Type b) { return _mm512_mask_min_ps(a, (Mask)0xFFFF, a, b); }
+        KERNELS_TARGET("avx512f") static Type Max(Type a, Type b) { return _mm512_mask_max_ps(a, (Mask)0xFFFF, a, b); }
+        KERNELS_TARGET("avx512f") static Type MulAdd(Type a, Type b, Type c) { return _mm512_fmadd_ps(a, b, c); }
+        typedef __m512i Index;
+        KERNELS_TARGET("avx512f") static Index ToIndex(Type x) { return _mm512_maskz_cvttps_epi32((Mask)0xFFFF, x); }
+        KERNELS_TARGET("avx512f") static Type FromIndex(Index i) { return _mm512_maskz_cvtepi32_ps((Mask)0xFFFF, i); }
+        KERNELS_TARGET("avx512f") static Type Gather(const float *table, Index i) { return _mm512_mask_i32gather_ps(_mm512_setzero_ps(), (Mask)0xFFFF, i, table, 4); }
+        KERNELS_TARGET("avx512f") static float Sum(Type x)
+        {
+            float lanes[16];
+            _mm512_storeu_ps(lanes, x);
+            float sum = 0.0f;
+            for (unsigned i = 0; i < 16; i += 4)
+                sum += (lanes[i] + lanes[i + 1]) + (lanes[i + 2] + lanes[i + 3]);
+            return sum;
+        }
+    };
+
+    template <typename T>
+    KERNELS_TARGET("avx512f")
+    T DotAVX512(const T *a, const T *b, unsigned count)
+    {
+        typedef AVX512Register<T> R;
+        typename R::Type sum0 = R::Zero();
+        typename R::Type sum1 = R::Zero();
+        typename R::Mask full = R::GetMask(R::Width);
+
+        unsigned i = 0;
+        for (; i + 2 * R::Width <= count; i += 2 * R::Width)
+        {
+            sum0 = R::MulAdd(R::Load(full, a + i), R::Load(full, b + i), sum0);
+            sum1 = R::MulAdd(R::Load(full, a + i + R::Width), R::Load(full, b + i + R::Width), sum1);
+        }
+        for (; i < count; i += R::Width)
+        {
+            typename R::Mask mask = R::GetMask(count - i);
+            sum0 = R::MulAdd(R::Load(mask, a + i), R::Load(mask, b + i), sum0);
+        }
+
+        return R::Sum(R::Add(sum0, sum1));
+    }
+
+    template <typename T>
+    KERNELS_TARGET("avx512f")
+    void AxpyAVX512(T alpha, const T *x, T *y, unsigned count)
+    {
+        typedef AVX512Register<T> R;
+        typename R::Type a = R::Set(alpha);
+
+        for (unsigned i = 0; i < count; i += R::Width)
+        {
+            typename R::Mask mask = R::GetMask(count - i);
+            R::Store(mask, y + i, R::MulAdd(a, R::Load(mask, x + i), R::Load(mask, y + i)));
+        }
+    }
+
+    template <typename T>
+    KERNELS_TARGET("avx512f")
+    void UpdateWeightsAVX512(T scale, const T *inputs, T momentum, T *deltas, T *weights, unsigned count)
+    {
+        typedef AVX512Register<T> R;
+        typename R::Type s = R::Set(scale);
+        typename R::Type m = R::Set(momentum);
+
+        for (unsigned i = 0; i < count; i += R::Width)
+        {
+            typename R::Mask mask = R::GetMask(count - i);
+            typename R::Type delta = R::MulAdd(s, R::Load(mask, inputs + i), R::Mul(m, R::Load(mask, deltas + i)));
+            R::Store(mask, deltas + i, delta);
+            R::Store(mask, weights + i, R::Add(R::Load(mask, weights + i), delta));
+        }
+    }
+
+    template <typename T>
+    KERNELS_TARGET("avx512f")
+    void Dot4AVX512(const T *a, unsigned stride, const T *b, unsigned count, T result[4])
+    {
+        typedef AVX512Register<T> R;
+        const T *a0 = a, *a1 = a + stride, *a2 = a + 2 * stride, *a3 = a + 3 * stride;
+        typename R::Type sum0 = R::Zero(), sum1 = R::Zero(), sum2 = R::Zero(), sum3 = R::Zero();
+
+        for (unsigned i = 0; i < count; i += R::Width)
+        {
+            typename R::Mask mask = R::GetMask(count - i);
+            typename R::Type bv = R::Load(mask, b + i);
+            sum0 = R::MulAdd(R::Load(mask, a0 + i), bv, sum0);
+            sum1 = R::MulAdd(R::Load(mask, a1 + i), bv, sum1);
+            sum2 = R::MulAdd(R::Load(mask, a2 + i), bv, sum2);
+            sum3 = R::MulAdd(R::Load(mask, a3 + i), bv, sum3);
+        }
+
+        result[0] = R::Sum(sum0);
+        result[1] = R::Sum(sum1);
+        result[2] = R::Sum(sum2);
+        result[3] = R::Sum(sum3);
+    }
+
+    template <typename T>
+    KERNELS_TARGET("avx512f")
+    void ColumnDotAVX512(const T *a, const T *b, unsigned stride, unsigned rows, T *result, unsigned count)
+    {
+        typedef AVX512Register<T> R;
+
+        for (unsigned i = 0; i < count; i += R::Width)
+        {
+            typename R::Mask mask = R::GetMask(count - i);
+            typename R::Type sum = R::Zero();
+            for (unsigned r = 0; r < rows; r++)
+                sum = R::MulAdd(R::Load(mask, a + r * stride + i), R::Load(mask, b + r * stride + i), sum);
+
+            R::Store(mask, result + i, sum);
+        }
+    }
+
+    template <typename T>
+    KERNELS_TARGET("avx512f")
+    void RationalTanhAVX512(T *values, unsigned count)
+    {
+        typedef AVX512Register<T> R;
+        typename R::Type limit = R::Set((T)Activation::RationalTanhLimit), negativeLimit = R::Set((T)-Activation::RationalTanhLimit);
+        typename R::Type one = R::Set((T)1), negativeOne = R::Set((T)-1);
+        typename R::Type n0 = R::Set((T)Activation::RationalTanhNumerator[0]), n1 = R::Set((T)Activation::RationalTanhNumerator[1]);
+        typename R::Type n2 = R::Set((T)Activation::RationalTanhNumerator[2]), n3 = R::Set((T)Activation::RationalTanhNumerator[3]);
+        typename R::Type d0 = R::Set((T)Activation::RationalTanhDenominator[0]), d1 = R::Set((T)Activation::RationalTanhDenominator[1]);
+        typename R::Type d2 = R::Set((T)Activation::RationalTanhDenominator[2]), d3 = R::Set((T)Activation::RationalTanhDenominator[3]);
+
+        for (unsigned i = 0; i < count; i += R::Width)
+        {
+            typename R::Mask mask = R::GetMask(count - i);
+            typename R::Type x = R::Min(R::Max(R::Load(mask, values + i), negativeLimit), limit);
+            typename R::Type x2 = R::Mul(x, x);
+            typename R::Type p = R::MulAdd(x2, R::MulAdd(x2, R::MulAdd(x2, n3, n2), n1), n0);
+            typename R::Type q = R::MulAdd(x2, R::MulAdd(x2, R::MulAdd(x2, d3, d2), d1), d0);
+            typename R::Type y = R::Div(R::Mul(x, p), q);
+            R::Store(mask, values + i, R::Min(R::Max(y, negativeOne), one));
+        }
+    }
+
+    //outputOffset + outputScale * tanh(inputScale * x), linear interpolation between two gathered table values.
+    //The position is clamped to [0...size], the repeated last sample makes the upper limit exact
+    template <typename T>
+    KERNELS_TARGET("avx512f")
+    void TableTanhAVX512(T *values, unsigned count, T inputScale, T outputScale, T outputOffset)
+    {
+        typedef AVX512Register<T> R;
+        const T *table = Activation::GetTanhTable<T>();
+        typename R::Type scale = R::Set((T)(inputScale * Activation::TanhTableSize / (2.0 * Activation::TanhTableLimit)));
+        typename R::Type center = R::Set((T)(Activation::TanhTableSize / 2.0));
+        typename R::Type zero = R::Zero(), size = R::Set((T)Activation::TanhTableSize);
+        typename R::Type outScale = R::Set(outputScale), outOffset = R::Set(outputOffset);
+
+        for (unsigned i = 0; i < count; i += R::Width)
+        {
+            typename R::Mask mask = R::GetMask(count - i);
+            typename R::Type position = R::Min(R::Max(R::MulAdd(R::Load(mask, values + i), scale, center), zero), size);
+            typename R::Index index = R::ToIndex(position);
+            typename R::Type fraction = R::Sub(position, R::FromIndex(index));
+            typename R::Type low = R::Gather(table, index);
+            typename R::Type y = R::MulAdd(R::Sub(R::Gather(table + 1, index), low), fraction, low);
+            R::Store(mask, values + i, R::MulAdd(y, outScale, outOffset));
+        }
+    }
+
+    template <typename T>
+    KERNELS_TARGET("avx512f")
+    void ReluAVX512(T *values, unsigned count)
+    {
+        typedef AVX512Register<T> R;
+        typename R::Type zero = R::Zero();
+
+        for (unsigned i = 0; i < count; i += R::Width)
+        {
+            typename R::Mask mask = R::GetMask(count - i);
+            R::Store(mask, values + i, R::Max(R::Load(mask, values + i), zero));
+        }
+    }
+#endif
+
+    //Signed 8 bit dot products: every lane is widened to 16 bits and madd multiplies and adds
+    //pairs into 32 bit lanes, which never overflow for 127 * 127 products
+    int32_t DotInt8Scalar(const int8_t *a, const int8_t *b, unsigned count)
+    {
+        int32_t sum = 0;
+        for (unsigned i = 0; i < count; i++)
+            sum += (int32_t)a[i] * b[i];
+
+        return sum;
+    }
+
+#if defined(KERNELS_X86)
+    KERNELS_TARGET("sse2")
+    int32_t DotInt8SSE2(const int8_t *a, const int8_t *b, unsigned count)
+    {
+        __m128i sum = _mm_setzero_si128();
+
+        unsigned i = 0;
+        for (; i + 16 <= count; i += 16)
+        {
+            __m128i x = _mm_loadu_si128((const __m128i *)(a + i));
+            __m128i y = _mm_loadu_si128((const __m128i *)(b + i));
+
+            //SSE2 has no sign extension, unpacking a register with itself and shifting right does it
+            __m128i xLow = _mm_srai_epi16(_mm_unpacklo_epi8(x, x), 8);
+            __m128i xHigh = _mm_srai_epi16(_mm_unpackhi_epi8(x, x), 8);
+            __m128i yLow = _mm_srai_epi16(_mm_unpacklo_epi8(y, y), 8);
+            __m128i yHigh = _mm_srai_epi16(_mm_unpackhi_epi8(y, y), 8);
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(xLow, yLow));
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(xHigh, yHigh));
+        }
+
+        sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+        sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+        int32_t result = _mm_cvtsi128_si32(sum);
+        for (; i < count; i++)
+            result += (int32_t)a[i] * b[i];
+
+        return result;
+    }
+
+    KERNELS_TARGET("avx2,fma")
+    int32_t DotInt8AVX2(const int8_t *a, const int8_t *b, unsigned count)
+    {
+        __m256i sum0 = _mm256_setzero_si256();
+        __m256i sum1 = _mm256_setzero_si256();
+
+        unsigned i = 0;
+        for (; i + 32 <= count; i += 32)
+        {
+            __m256i x0 = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i *)(a + i)));
+            __m256i y0 = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i *)(b + i)));
+            __m256i x1 = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i *)(a + i + 16)));
+            __m256i y1 = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i *)(b + i + 16)));
+            sum0 = _mm256_add_epi32(sum0, _mm256_madd_epi16(x0, y0));
+            sum1 = _mm256_add_epi32(sum1, _mm256_madd_epi16(x1, y1));
+        }
+        if (i + 16 <= count)
+        {
+            __m256i x = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i *)(a + i)));
+            __m256i y = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i *)(b + i)));
+            sum0 = _mm256_add_epi32(sum0, _mm256_madd_epi16(x, y));
+            i += 16;
+        }
+
+        __m256i sum256 = _mm256_add_epi32(sum0, sum1);
+        __m128i sum = _mm_add_epi32(_mm256_castsi256_si128(sum256), _mm256_extracti128_si256(sum256, 1));
+        sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+        sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+        int32_t result = _mm_cvtsi128_si32(sum);
+        for (; i < count; i++)
+            result += (int32_t)a[i] * b[i];
+
+        return result;
+    }
+#endif
+
+    //The 512 bits integer multiplies need AVX-512BW, which is not part of the AVX-512 level, so AVX-512 cpus run the AVX2 version
+    typedef int32_t (*DotInt8Kernel)(const int8_t *a, const int8_t *b, unsigned count);
+
+    DotInt8Kernel CreateDotInt8Kernel(InstructionSet instructionSet)
+    {
+#if defined(KERNELS_X86)
+        if (instructionSet >= AVX2)
+            return DotInt8AVX2;
+        if (instructionSet >= SSE2)
+            return DotInt8SSE2;
+#endif
+        return DotInt8Scalar;
+    }
+
+    template <typename T>
+    struct KernelTable
+    {
+        InstructionSet Set;
+        T (*Dot)(const T *a, const T *b, unsigned count);
+        void (*Axpy)(T alpha, const T *x, T *y, unsigned count);
+        void (*UpdateWeights)(T scale, const T *inputs, T momentum, T *deltas, T *weights, unsigned count);
+        void (*Dot4)(const T *a, unsigned stride, const T *b, unsigned count, T result[4]);
+        void (*ColumnDot)(const T *a, const T *b, unsigned stride, unsigned rows, T *result, unsigned count);
+        void (*RationalTanh)(T *values, unsigned count);
+        void (*Relu)(T *values, unsigned count);
+        void (*TableTanh)(T *values, unsigned count, T inputScale, T outputScale, T outputOffset);
+    };
+
+    template <typename T>
+    KernelTable<T> CreateKernelTable(InstructionSet instructionSet)
+    {
+        KernelTable<T> table = { Scalar, DotScalar<T>, AxpyScalar<T>, UpdateWeightsScalar<T>, Dot4Scalar<T>, ColumnDotScalar<T>, RationalTanhScalar<T>, ReluScalar<T>, TableTanhScalar<T> };
+
+#if defined(KERNELS_X86)
+        if (instructionSet >= SSE2)
+        {
+            KernelTable<T> sse2 = { SSE2, DotSSE2<T>, AxpySSE2<T>, UpdateWeightsSSE2<T>, Dot4SSE2<T>, ColumnDotSSE2<T>, RationalTanhSSE2<T>, ReluSSE2<T>, TableTanhSSE2<T> };
+            table = sse2;
+        }
+        if (instructionSet >= AVX2)
+        {
+            KernelTable<T> avx2 = { AVX2, DotAVX2<T>, AxpyAVX2<T>, UpdateWeightsAVX2<T>, Dot4AVX2<T>, ColumnDotAVX2<T>, RationalTanhAVX2<T>, ReluAVX2<T>, TableTanhAVX2<T> };
+            table = avx2;
+        }
+#endif
+#if defined(KERNELS_AVX512)
+        if (instructionSet >= AVX512)
+        {
+            KernelTable<T> avx512 = { AVX512, DotAVX512<T>, AxpyAVX512<T>, UpdateWeightsAVX512<T>, Dot4AVX512<T>, ColumnDotAVX512<T>, RationalTanhAVX512<T>, ReluAVX512<T>, TableTanhAVX512<T> };
+            table = avx512;
+        }
+#endif
+
+        return table;
+    }
+
+#if defined(KERNELS_X86)
+    void CpuId(int leaf, int subLeaf, unsigned regs[4])
+    {
+#if defined(_MSC_VER)
+        int info[4];
+        __cpuidex(info, leaf, subLeaf);
+        for (unsigned i = 0; i < 4; i++)
+            regs[i] = (unsigned)info[i];
+#else
+        __cpuid_count(leaf, subLeaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+    }
+
+    //Register state the operating system saves on context switches
+    unsigned long long GetEnabledStateMask()
+    {
+#if defined(_MSC_VER)
+        return _xgetbv(0);
+#else
+        unsigned eax, edx;
+        __asm__ __volatile__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+        return ((unsigned long long)edx << 32) | eax;
+#endif
+    }
+#endif
+
+    InstructionSet DetectInstructionSet()
+    {
+        InstructionSet instructionSet = Scalar;
+
+#if defined(KERNELS_X86)
+        unsigned regs[4];
+        CpuId(0, 0, regs);
+        unsigned maxLeaf = regs[0];
+
+        CpuId(1, 0, regs);
+        bool sse2 = (regs[3] & (1u << 26)) != 0;
+        bool fma = (regs[2] & (1u << 12)) != 0;
+        bool osxsave = (regs[2] & (1u << 27)) != 0;
+        if (!sse2)
+            return instructionSet;
+        instructionSet = SSE2;
+
+        if (!osxsave || maxLeaf < 7)
+            return instructionSet;
+
+        //XMM and YMM state for AVX, plus opmask and ZMM state for AVX-512
+        unsigned long long stateMask = GetEnabledStateMask();
+        bool ymmState = (stateMask & 0x6) == 0x6;
+        bool zmmState = (stateMask & 0xE6) == 0xE6;
+
+        CpuId(7, 0, regs);
+        bool avx2 = (regs[1] & (1u << 5)) != 0;
+        bool avx512f = (regs[1] & (1u << 16)) != 0;
+
+        if (avx2 && fma && ymmState)
+            instructionSet = AVX2;
+#if defined(KERNELS_AVX512)
+        if (instructionSet == AVX2 && avx512f && zmmState)
+            instructionSet = AVX512;
+#endif
+#endif
+
+        return instructionSet;
+    }
+
+    const InstructionSet gSupportedInstructionSet = DetectInstructionSet();
+    KernelTable<double> gKernelsDouble = CreateKernelTable<double>(gSupportedInstructionSet);
+    KernelTable<float> gKernelsFloat = CreateKernelTable<float>(gSupportedInstructionSet);
+    DotInt8Kernel gDotInt8 = CreateDotInt8Kernel(gSupportedInstructionSet);
+
+    inline const KernelTable<double> &GetKernels(const double *) { return gKernelsDouble; }
+    inline const KernelTable<float> &GetKernels(const float *) { return gKernelsFloat; }
+
+    double Dot(const double *a, const double *b, unsigned count)
+    {
+        return gKernelsDouble.Dot(a, b, count);
+    }
+
+    float Dot(const float *a, const float *b, unsigned count)
+    {
+        return gKernelsFloat.Dot(a, b, count);
+    }
+
+    void Axpy(double alpha, const double *x, double *y, unsigned count)
+    {
+        gKernelsDouble.Axpy(alpha, x, y, count);
+    }
+
+    void Axpy(float alpha, const float *x, float *y, unsigned count)
+    {
+        gKernelsFloat.Axpy(alpha, x, y, count);
+    }
+
+    void UpdateWeights(double scale, const double *inputs, double momentum, double *deltas, double *weights, unsigned count)
+    {
+        gKernelsDouble.UpdateWeights(scale, inputs, momentum, deltas, weights, count);
+    }
+
+    void UpdateWeights(float scale, const float *inputs, float momentum, float *deltas, float *weights, unsigned count)
+    {
+        gKernelsFloat.UpdateWeights(scale, inputs, momentum, deltas, weights, count);
+    }
+
+    void Dot4(const double *a, unsigned stride, const double *b, unsigned count, double result[4])
+    {
+        gKernelsDouble.Dot4(a, stride, b, count, result);
+    }
+
+    void Dot4(const float *a, unsigned stride, const float *b, unsigned count, float result[4])
+    {
+        gKernelsFloat.Dot4(a, stride, b, count, result);
+    }
+
+    void ColumnDot(const double *a, const double *b, unsigned stride, unsigned rows, double *result, unsigned count)
+    {
+        gKernelsDouble.ColumnDot(a, b, stride, rows, result, count);
+    }
+
+    void ColumnDot(const float *a, const float *b, unsigned stride, unsigned rows, float *result, unsigned count)
+    {
+        gKernelsFloat.ColumnDot(a, b, stride, rows, result, count);
+    }
+
+    void RationalTanh(double *values, unsigned count)
+    {
+        gKernelsDouble.RationalTanh(values, count);
+    }
+
+    void RationalTanh(float *values, unsigned count)
+    {
+        gKernelsFloat.RationalTanh(values, count);
+    }
+
+    void Relu(double *values, unsigned count)
+    {
+        gKernelsDouble.Relu(values, count);
+    }
+
+    void Relu(float *values, unsigned count)
+    {
+        gKernelsFloat.Relu(values, count);
+    }
+
+    void TableTanh(double *values, unsigned count)
+    {
+        gKernelsDouble.TableTanh(values, count, 1.0, 1.0, 0.0);
+    }
+
+    void TableTanh(float *values, unsigned count)
+    {
+        gKernelsFloat.TableTanh(values, count, 1.0f, 1.0f, 0.0f);
+    }
+
+    //sigmoid(x) = 0.5 + 0.5 * tanh(x / 2)
+    void Sigmoid(double *values, unsigned count)
+    {
+        gKernelsDouble.TableTanh(values, count, 0.5, 0.5, 0.5);
+    }
+
+    void Sigmoid(float *values, unsigned count)
+    {
+        gKernelsFloat.TableTanh(values, count, 0.5f, 0.5f, 0.5f);
+    }
+
+    int32_t DotInt8(const int8_t *a, const int8_t *b, unsigned count)
+    {
+        return gDotInt8(a, b, count);
+    }
+
+    //Blocks of 4 rows of A reuse every row of B loaded, the leftover rows use single dot products
+    template <typename T>
+    void GemmNTImpl(unsigned m, unsigned n, unsigned k, const T *a, unsigned lda, const T *b, unsigned ldb, T *c, unsigned ldc)
+    {
+        const KernelTable<T> &kernels = GetKernels(a);
+
+        //Keep a block of B rows in cache while all the rows of A go through it
+        const unsigned blockRows = 64;
+        for (unsigned blockStart = 0; blockStart < n; blockStart += blockRows)
+        {
+            unsigned blockEnd = blockStart + blockRows < n ? blockStart + blockRows : n;
+
+            unsigned i = 0;
+            for (; i + 4 <= m; i += 4)
+            {
+                for (unsigned j = blockStart; j < blockEnd; j++)
+                {
+                    T result[4];
+                    kernels.Dot4(a + i * lda, lda, b + j * ldb, k, result);
+                    for (unsigned r = 0; r < 4; r++)
+                        c[(i + r) * ldc + j] = result[r];
+                }
+            }
+            for (; i < m; i++)
+            {
+                for (unsigned j = blockStart; j < blockEnd; j++)
+                    c[i * ldc + j] = kernels.Dot(a + i * lda, b + j * ldb, k);
+            }
+        }
+    }
+
+    template <typename T>
+    void GemmNNImpl(unsigned m, unsigned n, unsigned k, const T *a, unsigned lda, const T *b, unsigned ldb, T *c, unsigned ldc)
+    {
+        const KernelTable<T> &kernels = GetKernels(a);
+
+        for (unsigned i = 0; i < m; i++)
+        {
+            T *row = c + i * ldc;
+            for (unsigned j = 0; j < n; j++)
+                row[j] = 0;
+
+            for (unsigned p = 0; p < k; p++)
+                kernels.Axpy(a[i * lda + p], b + p * ldb, row, n);
+        }
+    }
+
+    template <typename T>
+    void GemmTNImpl(unsigned m, unsigned n, unsigned k, const T *a, unsigned lda, const T *b, unsigned ldb, T *c, unsigned ldc)
+    {
+        const KernelTable<T> &kernels = GetKernels(a);
+
+        for (unsigned p = 0; p < k; p++)
+        {
+            for (unsigned i = 0; i < m; i++)
+                kernels.Axpy(a[p * lda + i], b + p * ldb, c + i * ldc, n);
+        }
+    }
+
+    void GemmNT(unsigned m, unsigned n, unsigned k, const double *a, unsigned lda, const double *b, unsigned ldb, double *c, unsigned ldc)
+    {
+        GemmNTImpl(m, n, k, a, lda, b, ldb, c, ldc);
+    }
+
+    void GemmNT(unsigned m, unsigned n, unsigned k, const float *a, unsigned lda, const float *b, unsigned ldb, float *c, unsigned ldc)
+    {
+        GemmNTImpl(m, n, k, a, lda, b, ldb, c, ldc);
+    }
+
+    void GemmNN(unsigned m, unsigned n, unsigned k, const double *a, unsigned lda, const double *b, unsigned ldb, double *c, unsigned ldc)
+    {
+        GemmNNImpl(m, n, k, a, lda, b, ldb, c, ldc);
+    }
+
+    void GemmNN(unsigned m, unsigned n, unsigned k, const float *a, unsigned lda, const float *b, unsigned ldb, float *c, unsigned ldc)
+    {
+        GemmNNImpl(m, n, k, a, lda, b, ldb, c, ldc);
+    }
+
+    void GemmTN(unsigned m, unsigned n, unsigned k, const double *a, unsigned lda, const double *b, unsigned ldb, double *c, unsigned ldc)
+    {
+        GemmTNImpl(m, n, k, a, lda, b, ldb, c, ldc);
+    }
+
+    void GemmTN(unsigned m, unsigned n, unsigned k, const float *a, unsigned lda, const float *b, unsigned ldb, float *c, unsigned ldc)
+    {
+        GemmTNImpl(m, n, k, a, lda, b, ldb, c, ldc);
+    }
+
+    InstructionSet GetSupportedInstructionSet()
+    {
+        return gSupportedInstructionSet;
+    }
+
+    InstructionSet GetInstructionSet()
+    {
+        return gKernelsDouble.Set;
+    }
+
+    InstructionSet SetInstructionSet(InstructionSet instructionSet)
+    {
+        if (instructionSet > gSupportedInstructionSet)
+            instructionSet = gSupportedInstructionSet;
+
+        gKernelsDouble = CreateKernelTable<double>(instructionSet);
+        gKernelsFloat = CreateKernelTable<float>(instructionSet);
+        gDotInt8 = CreateDotInt8Kernel(instructionSet);
+        return gKernelsDouble.Set;
+    }
+
+    const char *GetInstructionSetName(InstructionSet instructionSet)
+    {
+        switch (instructionSet)
+        {
+        case SSE2: return "SSE2";
+        case AVX2: return "AVX2";
+        case AVX512: return "AVX-512";
+        default: return "Scalar";
+        }
+    }
+}
@@ -1,8 +1,23 @@
 
 #include "Network.h"
-
+#include "AllocationCounter.h"
+#include "ParallelTrainer.h"
+#include "BinaryDataset.h"
+#include "TextDatasetReader.h"
+#include "Dataset.h"
+#include "ModelFile.h"
+#include "MappedNetwork.h"
+#include "QuantizedNetwork.h"
+#include "Telemetry.h"
+#include "Validator.h"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
 #include <string>
 #include <iostream>
+#include <memory>
 #include <fstream>
 #include <sstream>
 
@@ -13,8 +28,10 @@ public:
     inline bool IsEof() { return mTrainingDataFile.eof(); }
     void GetTopology(std::vector<unsigned> &topology);
 
-    unsigned GetNextInputs(std::vector<double> &inputVals);
-    unsigned GetTargetOutputs(std::vector<double> &targetOutputsVals);
+    template <typename T>
+    unsigned GetNextInputs(std::vector<T> &inputVals);
+    template <typename T>
+    unsigned GetTargetOutputs(std::vector<T> &targetOutputsVals);
 
 private:
     std::ifstream mTrainingDataFile;
@@ -46,7 +63,8 @@ void TrainingData::GetTopology(std::vector<unsigned>& topology)
 
 }
 
-unsigned TrainingData::GetNextInputs(std::vector<double> &inputVals)
+template <typename T>
+unsigned TrainingData::GetNextInputs(std::vector<T> &inputVals)
 {
     inputVals.clear();
 
@@ -60,13 +78,14 @@ unsigned TrainingData::GetNextInputs(std::vector<double> &inputVals)
     {
         double oneValue;
         while (ss >> oneValue)
-            inputVals.push_back(oneValue);
+            inputVals.push_back((T)oneValue);
     }
 
     return (unsigned)inputVals.size();
 }
 
-unsigned TrainingData::GetTargetOutputs(std::vector<double> &targetOutputsVals)
+template <typename T>
+unsigned TrainingData::GetTargetOutputs(std::vector<T> &targetOutputsVals)
 {
     targetOutputsVals.clear();
 
@@ -80,13 +99,14 @@ unsigned TrainingData::GetTargetOutputs(std::vector<double> &targetOutputsVals)
     {
         double oneValue;
         while (ss >> oneValue)
-            targetOutputsVals.push_back(oneValue);
+            targetOutputsVals.push_back((T)oneValue);
     }
 
     return (unsigned)targetOutputsVals.size();
 }
 
-void ShowVectorVals(std::string label, const std::vector<double> &v)
+template <typename T>
+void ShowVectorVals(std::string label, const std::vector<T> &v)
 {
     std::cout << label << " ";
     for (unsigned i = 0; i < v.size(); i++)
@@ -95,113 +115,717 @@ void ShowVectorVals(std::string label, const std::vector<double> &v)
     std::cout << std::endl;
 }
 
-int main()
+//Trains over the file in mini-batches of 'batchSize' samples (one weight update per batch)
+template <typename T>
+void TrainInBatches(TrainingData &trainData, NetworkT<T> &myNetwork, const std::vector<unsigned> &topology, unsigned batchSize,
+                    Telemetry &telemetry)
 {
-    TrainingData trainData("../data/trainingData.txt");
+    std::vector<T> inputVals, targetVals, batchInputs, batchTargets;
+    uint64_t trainingBatch = 0;
 
-    std::vector<unsigned> topology;
-    trainData.GetTopology(topology);
-    Network myNetwork(topology);
+    while (!trainData.IsEof())
+    {
+        batchInputs.clear();
+        batchTargets.clear();
+
+        unsigned samples = 0;
+        while (samples < batchSize && !trainData.IsEof())
+        {
+            if (trainData.GetNextInputs(inputVals) != topology[0])
+                break;
+            if (trainData.GetTargetOutputs(targetVals) != topology.back())
+                break;
+
+            batchInputs.insert(batchInputs.end(), inputVals.begin(), inputVals.end());
+            batchTargets.insert(batchTargets.end(), targetVals.begin(), targetVals.end());
+            samples++;
+        }
+
+        if (samples == 0)
+            break;
+
+        trainingBatch++;
+        myNetwork.TrainBatch(batchInputs, batchTargets, samples);
+
+        //Report how well the training is working
+        telemetry.Record(trainingBatch, myNetwork.GetError(), myNetwork.GetRecentAverageError());
+    }
+
+    telemetry.EndEpoch(trainingBatch, myNetwork.GetError(), myNetwork.GetRecentAverageError());
+    telemetry.Flush();
+}
 
-    std::vector<double> inputVals, targetVals, resultVals;
-    int trainingPass = 0;
+//Feeds every sample forward and back propagates it right away
+template <typename T>
+void TrainPerSample(TrainingData &trainData, NetworkT<T> &myNetwork, const std::vector<unsigned> &topology, Telemetry &telemetry)
+{
+    std::vector<T> inputVals, targetVals;
+    uint64_t trainingPass = 0;
 
     while (!trainData.IsEof())
     {
+        //Get new input data and feed it forward:
+        if (trainData.GetNextInputs(inputVals) != topology[0])
+            break;
+
+        myNetwork.FeedForward(inputVals);
+
+        trainData.GetTargetOutputs(targetVals);
+        myNetwork.BackPropagate(targetVals);
         trainingPass++;
 
-        std::cout << std::endl << "Pass " << trainingPass;
+        //Report how well the training is working
+        telemetry.Record(trainingPass, myNetwork.GetError(), myNetwork.GetRecentAverageError());
+    }
+
+    telemetry.EndEpoch(trainingPass, myNetwork.GetError(), myNetwork.GetRecentAverageError());
+    telemetry.Flush();
+}
 
-        //Get new input data and feed it forward:
+//Loads the whole file and trains over it once on several threads, each with its own shard
+template <typename T>
+void TrainInParallel(TrainingData &trainData, NetworkT<T> &myNetwork, const std::vector<unsigned> &topology, unsigned batchSize,
+                     unsigned numThreads, typename ParallelTrainerT<T>::Mode mode, Telemetry &telemetry)
+{
+    std::vector<T> inputVals, targetVals, inputs, targets;
+    unsigned numSamples = 0;
+    while (!trainData.IsEof())
+    {
         if (trainData.GetNextInputs(inputVals) != topology[0])
             break;
+        if (trainData.GetTargetOutputs(targetVals) != topology.back())
+            break;
 
-        ShowVectorVals(": Inputs:", inputVals);
-        myNetwork.FeedForward(inputVals);
+        inputs.insert(inputs.end(), inputVals.begin(), inputVals.end());
+        targets.insert(targets.end(), targetVals.begin(), targetVals.end());
+        numSamples++;
+    }
 
-        //Collect the network results
+    ParallelTrainerT<T> trainer(myNetwork, numThreads, mode);
+    std::cout << "Training " << numSamples << " samples on " << trainer.GetNumThreads() << " threads ("
+              << ParallelTrainerT<T>::GetModeName(mode) << ")" << std::endl;
+    trainer.TrainEpoch(inputs, targets, batchSize);
+
+    //The threads only report the epoch error
+    telemetry.EndEpoch(trainer.GetEpochSteps(), trainer.GetEpochError(), trainer.GetEpochError());
+    telemetry.Flush();
+}
+
+//Once the network is warm a decision (FeedForward plus fetching the results) must not touch the heap
+template <typename T>
+void CheckInferenceAllocations(NetworkT<T> &myNetwork)
+{
+    if (!AllocationCounter::IsEnabled())
+        return;
+
+    std::vector<T> inputVals(myNetwork.GetNumInputs(), (T)1);
+    std::vector<T> resultVals(myNetwork.GetNumOutputs());
+
+    const unsigned decisions = 1000;
+    unsigned long long allocations = AllocationCounter::GetCount();
+    for (unsigned i = 0; i < decisions; i++)
+    {
+        myNetwork.FeedForward(inputVals.data());
+        myNetwork.GetResults(resultVals.data());
+        myNetwork.FeedForward(inputVals);
         myNetwork.GetResults(resultVals);
-        ShowVectorVals("Outputs:", resultVals);
+    }
+    allocations = AllocationCounter::GetCount() - allocations;
 
-        trainData.GetTargetOutputs(targetVals);
-        ShowVectorVals("Targets:", targetVals);
+    std::cout << std::endl << "Heap allocations in " << decisions << " warm decisions: " << allocations << std::endl;
+    assert(allocations == 0);
+}
 
-        myNetwork.BackPropagate(targetVals);
+//Writes the trained network to a model file, nothing to do without --save
+template <typename T>
+void SaveModel(const NetworkT<T> &myNetwork, const std::string &modelFile)
+{
+    if (modelFile.empty())
+        return;
 
-        //Report how well the training is working
-        std::cout << "Network average error: " << myNetwork.GetRecentAverageError() << std::endl;
+    if (ModelFile::Save(modelFile, myNetwork))
+        std::cout << std::endl << "Model saved to " << modelFile << std::endl;
+    else
+        std::cout << std::endl << "Could not write " << modelFile << std::endl;
+}
+
+//Quantizes the model network to int8 and compares both over the samples of a data file
+template <typename T>
+void ReportQuantization(NetworkT<T> &myNetwork, const std::string &dataFile)
+{
+    DatasetT<T> dataset;
+    if (!dataset.Load(dataFile) || dataset.GetTopology().front() != myNetwork.GetNumInputs())
+    {
+        std::cout << "Could not read " << dataFile << " to measure the quantization error" << std::endl;
+        return;
     }
-    std::cout << std::endl << "Done!";
-    
-    int a;
-    std::cin >> a;
 
-    return 0;
+    QuantizedNetwork quantizedNetwork(myNetwork);
+    QuantizationError error = quantizedNetwork.MeasureError(myNetwork, dataset.GetInputs(), dataset.GetNumSamples());
+
+    std::vector<unsigned> topology;
+    myNetwork.GetTopology(topology);
+    size_t weightsSize = 0;
+    for (unsigned layerIdx = 1; layerIdx < topology.size(); layerIdx++)
+        weightsSize += topology[layerIdx] * (topology[layerIdx - 1] + 1) * sizeof(T);
+
+    std::cout << "Int8 weights: " << quantizedNetwork.GetWeightsSize() << " bytes (" << weightsSize << " bytes in the model)" << std::endl;
+    std::cout << "Quantization error over " << error.NumSamples << " samples: max " << error.MaxError
+              << ", mean " << error.MeanError << std::endl;
 }
 
-/*
-unsigned ShouldUp(std::vector<unsigned> inputs)
+//Maps a model file and runs it in place, checking it against a trainable network loaded from the same file
+template <typename T>
+void RunModel(const ModelFile &model, std::chrono::steady_clock::time_point loadStart, bool quantize, const std::string &dataFile)
 {
-    //If there is a obstacle above
-    if (inputs[2] == 1) return 0;
-    //If there is a pit on the floor
-    else if(inputs[0] == 0) return 1;
-    //If there is an obstacle in front
-    else if (inputs[3] == 1) return 1;
+    MappedNetworkT<T> mappedNetwork;
+    mappedNetwork.Attach(model);
+    double loadTime = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - loadStart).count();
+
+    std::vector<T> inputVals(mappedNetwork.GetNumInputs(), (T)1);
+    std::vector<T> resultVals(mappedNetwork.GetNumOutputs());
+    mappedNetwork.FeedForward(inputVals.data());
+    mappedNetwork.GetResults(resultVals.data());
+
+    NetworkT<T> myNetwork(model.GetTopology(), model.GetActivation());
+    model.LoadWeights(myNetwork);
+    myNetwork.FeedForward(inputVals.data());
+
+    double maxDifference = 0.0;
+    for (unsigned i = 0; i < resultVals.size(); i++)
+        maxDifference = std::max(maxDifference, (double)std::abs(resultVals[i] - myNetwork.GetOutputs()[i]));
+
+    std::cout << "Model loaded in " << loadTime << " us (" << Activation::GetName(model.GetActivation()) << ", "
+              << (model.GetDataType() == BinaryDatasetFormat::Float32 ? "float" : "double") << ")" << std::endl;
+    ShowVectorVals("Outputs for ones:", resultVals);
+    std::cout << "Difference with the loaded Network: " << maxDifference << std::endl;
+
+    if (quantize)
+        ReportQuantization(myNetwork, dataFile);
+}
 
-    return 0;
+//Trains once over a mapped binary dataset, the network reads the samples straight from the file memory
+template <typename T>
+void TrainOnDataset(const BinaryDataset &dataset, unsigned batchSize, Activation::Type activation, unsigned numThreads, bool hogwild,
+                    const std::string &modelFile, Telemetry &telemetry)
+{
+    NetworkT<T> myNetwork(dataset.GetTopology(), activation);
+    const T *inputs = dataset.GetInputs<T>();
+    const T *targets = dataset.GetTargets<T>();
+    unsigned numSamples = dataset.GetNumSamples();
+
+    if (numThreads > 0)
+    {
+        typename ParallelTrainerT<T>::Mode mode = hogwild ? ParallelTrainerT<T>::Hogwild : ParallelTrainerT<T>::Synchronous;
+        ParallelTrainerT<T> trainer(myNetwork, numThreads, mode);
+        std::cout << "Training " << numSamples << " samples on " << trainer.GetNumThreads() << " threads ("
+                  << ParallelTrainerT<T>::GetModeName(mode) << ")" << std::endl;
+        trainer.TrainEpoch(inputs, targets, numSamples, batchSize);
+
+        //The threads only report the epoch error
+        telemetry.EndEpoch(trainer.GetEpochSteps(), trainer.GetEpochError(), trainer.GetEpochError());
+    }
+    else
+    {
+        uint64_t step = 0;
+        for (unsigned firstSample = 0; firstSample < numSamples; firstSample += batchSize)
+        {
+            SampleView<T> sample = dataset.GetSample<T>(firstSample);
+            if (batchSize > 1)
+                myNetwork.TrainBatch(sample.Inputs, sample.Targets, std::min(batchSize, numSamples - firstSample));
+            else
+            {
+                myNetwork.FeedForward(sample.Inputs);
+                myNetwork.BackPropagate(sample.Targets);
+            }
+
+            step++;
+            telemetry.Record(step, myNetwork.GetError(), myNetwork.GetRecentAverageError());
+        }
+
+        telemetry.EndEpoch(step, myNetwork.GetError(), myNetwork.GetRecentAverageError());
+    }
+
+    telemetry.Flush();
+    std::cout << numSamples << " samples trained" << std::endl;
+
+    CheckInferenceAllocations(myNetwork);
+    SaveModel(myNetwork, modelFile);
 }
 
-unsigned ShouldLeft(std::vector<unsigned> inputs)
+//Trains once over a text dataset streamed by a background reader, parsing overlaps with training
+template <typename T>
+bool TrainStreaming(const std::string &filename, unsigned batchSize, Activation::Type activation, const std::string &modelFile,
+                    Telemetry &telemetry)
 {
-    //if there is an obstacle forward and above, but no obstacle behind
-    if (inputs[3] == 1 && inputs[2] == 1 && inputs[1] == 0) return 1;
+    TextDatasetReaderT<T> reader;
+    if (!reader.Open(filename, batchSize))
+    {
+        std::cout << "Could not read " << filename << std::endl;
+        return false;
+    }
 
-    return 0;
+    NetworkT<T> myNetwork(reader.GetTopology(), activation);
+    unsigned numInputs = myNetwork.GetNumInputs();
+    unsigned numOutputs = myNetwork.GetNumOutputs();
+
+    unsigned numSamples = 0;
+    uint64_t step = 0;
+    while (const SampleBatch<T> *batch = reader.NextBatch())
+    {
+        if (batchSize > 1)
+        {
+            myNetwork.TrainBatch(batch->Inputs.data(), batch->Targets.data(), batch->NumSamples);
+            step++;
+            telemetry.Record(step, myNetwork.GetError(), myNetwork.GetRecentAverageError());
+        }
+        else
+        {
+            for (unsigned sampleIdx = 0; sampleIdx < batch->NumSamples; sampleIdx++)
+            {
+                myNetwork.FeedForward(&batch->Inputs[sampleIdx * numInputs]);
+                myNetwork.BackPropagate(&batch->Targets[sampleIdx * numOutputs]);
+                step++;
+                telemetry.Record(step, myNetwork.GetError(), myNetwork.GetRecentAverageError());
+            }
+        }
+        numSamples += batch->NumSamples;
+    }
+
+    telemetry.EndEpoch(step, myNetwork.GetError(), myNetwork.GetRecentAverageError());
+    telemetry.Flush();
+    std::cout << numSamples << " samples streamed" << std::endl;
+
+    CheckInferenceAllocations(myNetwork);
+    SaveModel(myNetwork, modelFile);
+    return true;
 }
 
-unsigned ShouldRight(std::vector<unsigned> inputs)
+//Holdout validation of the epoch training
+struct ValidationOptions
+{
+    //Part of the samples held out, 0 trains on all of them without validation
+    double Fraction = 0.0;
+    //Steps between evaluations, 0 evaluates once per epoch
+    unsigned Interval = 0;
+    //Evaluations without improvement before stopping, 0 never stops early
+    unsigned Patience = 0;
+    double MinDelta = 0.0;
+    //Model file rewritten on every new best validation error
+    std::string BestModelFile;
+    //Ends with the best weights instead of the last ones
+    bool RestoreBest = false;
+};
+
+//Reports a finished evaluation, true when the early stopping policy ends the training
+template <typename T>
+bool CheckValidation(ValidatorT<T> *validator, EarlyStopping &earlyStopping)
 {
-    //If there is no obstacle in front
-    if (inputs[3] == 0) return 1;
-    //If there is a obstacle in front, but you can jump it
-    else if (inputs[3] == 1 && inputs[2] == 0) return 1;
+    ValidationResult result;
+    if (!validator || !validator->GetResult(result))
+        return false;
 
-    return 0;
+    std::cout << "Validation error at step " << result.Step << ": " << result.Error << (result.Improved ? " (best)" : "") << std::endl;
+    return earlyStopping.Update(result.Error);
+}
+
+//Loads the dataset once and trains over it 'epochs' times, visiting the samples in a new random order every epoch.
+//A compacted dataset trains every epoch as a single batch of its unique samples weighted by their counts,
+//the same gradient step as a batch of every sample
+template <typename T>
+bool TrainEpochs(const std::string &filename, unsigned epochs, unsigned batchSize, Activation::Type activation,
+                 unsigned numThreads, bool hogwild, uint64_t seed, bool compact, const ValidationOptions &validation,
+                 const std::string &modelFile, Telemetry &telemetry)
+{
+    DatasetT<T> dataset;
+    if (!dataset.Load(filename))
+    {
+        std::cout << "Could not read " << filename << std::endl;
+        return false;
+    }
+
+    Random random(seed);
+    DatasetT<T> validationSet;
+    if (validation.Fraction > 0.0)
+    {
+        dataset.Split(validation.Fraction, random, validationSet);
+        std::cout << validationSet.GetNumSamples() << " samples held out for validation" << std::endl;
+    }
+
+    //The validation set stays as it is, only the training samples are compacted
+    unsigned numSamples = dataset.GetNumSamples();
+    if (compact)
+    {
+        dataset.Compact();
+        std::cout << numSamples << " samples compacted into " << dataset.GetNumSamples() << " unique weighted samples" << std::endl;
+    }
+
+    NetworkT<T> myNetwork(dataset.GetTopology(), activation);
+
+    typename ParallelTrainerT<T>::Mode mode = hogwild ? ParallelTrainerT<T>::Hogwild : ParallelTrainerT<T>::Synchronous;
+    std::unique_ptr<ParallelTrainerT<T> > trainer;
+    if (numThreads > 0)
+    {
+        trainer.reset(new ParallelTrainerT<T>(myNetwork, numThreads, mode));
+        std::cout << "Training on " << trainer->GetNumThreads() << " threads (" << ParallelTrainerT<T>::GetModeName(mode) << ")" << std::endl;
+    }
+
+    //The validation runs on its own threads over snapshots of the weights, the training never waits for it
+    std::unique_ptr<ValidatorT<T> > validator;
+    if (validationSet.GetNumSamples() > 0)
+    {
+        validator.reset(new ValidatorT<T>(myNetwork, validationSet.GetInputs(), validationSet.GetTargets(), validationSet.GetNumSamples()));
+        validator->SetBestModelFile(validation.BestModelFile);
+    }
+    EarlyStopping earlyStopping(validation.Patience, validation.MinDelta);
+
+    uint64_t step = 0;
+    uint64_t evaluatedStep = 0;
+    bool stop = false;
+    unsigned epoch = 1;
+    for (; epoch <= epochs && !stop; epoch++)
+    {
+        if (compact)
+        {
+            //One batch in load order, the order of a full batch does not change the step
+            myNetwork.TrainBatch(dataset.GetInputs(), dataset.GetTargets(), dataset.GetWeights(), dataset.GetNumSamples());
+            step++;
+            telemetry.Record(step, myNetwork.GetError(), myNetwork.GetRecentAverageError());
+            telemetry.EndEpoch(step, myNetwork.GetError(), myNetwork.GetRecentAverageError());
+
+            if (validator && (validation.Interval == 0 || step % validation.Interval == 0) && validator->Evaluate(myNetwork, step))
+                evaluatedStep = step;
+            stop = CheckValidation(validator.get(), earlyStopping);
+            continue;
+        }
+
+        if (trainer)
+        {
+            //The threads split the epoch in contiguous shards, so the whole epoch is gathered in the new order
+            dataset.Shuffle(random);
+            const SampleBatch<T> &samples = dataset.GatherBatch(0, numSamples);
+            trainer->TrainEpoch(samples.Inputs.data(), samples.Targets.data(), numSamples, batchSize);
+            step += trainer->GetEpochSteps();
+            //The threads only report the epoch error
+            telemetry.EndEpoch(step, trainer->GetEpochError(), trainer->GetEpochError());
+
+            if (validator && validator->Evaluate(myNetwork, step))
+                evaluatedStep = step;
+            stop = CheckValidation(validator.get(), earlyStopping);
+            continue;
+        }
+
+        dataset.Shuffle(random, batchSize);
+        for (unsigned first = 0; first < numSamples && !stop; first += batchSize)
+        {
+            if (batchSize > 1)
+            {
+                const SampleBatch<T> &batch = dataset.GatherBatch(first, batchSize);
+                myNetwork.TrainBatch(batch.Inputs.data(), batch.Targets.data(), batch.NumSamples);
+            }
+            else
+            {
+                //Single samples are read in place
+                unsigned sampleIdx = dataset.GetSampleIndex(first);
+                myNetwork.FeedForward(&dataset.GetInputs()[sampleIdx * dataset.GetNumInputs()]);
+                myNetwork.BackPropagate(&dataset.GetTargets()[sampleIdx * dataset.GetNumOutputs()]);
+            }
+
+            step++;
+            telemetry.Record(step, myNetwork.GetError(), myNetwork.GetRecentAverageError());
+
+            //Skipped while the previous evaluation is still running
+            if (validator && validation.Interval > 0 && step % validation.Interval == 0 && validator->Evaluate(myNetwork, step))
+                evaluatedStep = step;
+            stop = CheckValidation(validator.get(), earlyStopping);
+        }
+
+        telemetry.EndEpoch(step, myNetwork.GetError(), myNetwork.GetRecentAverageError());
+        if (validator && validation.Interval == 0 && validator->Evaluate(myNetwork, step))
+            evaluatedStep = step;
+    }
+
+    //Every summary is out before the final report
+    telemetry.Flush();
+
+    if (stop)
+        std::cout << "Early stop in epoch " << epoch - 1 << ": " << validation.Patience << " evaluations without improvement" << std::endl;
+    std::cout << numSamples << " samples trained " << epoch - 1 << " times" << std::endl;
+
+    if (validator)
+    {
+        //The last weights are evaluated too, they may be the best ones
+        validator->Wait();
+        CheckValidation(validator.get(), earlyStopping);
+        if (evaluatedStep != step)
+        {
+            validator->Evaluate(myNetwork, step);
+            validator->Wait();
+            CheckValidation(validator.get(), earlyStopping);
+        }
+
+        std::cout << "Best validation error: " << validator->GetBestError() << " at step " << validator->GetBestStep() << std::endl;
+        if (validation.RestoreBest && validator->GetBestWeights(myNetwork))
+            std::cout << "Restored the weights of step " << validator->GetBestStep() << std::endl;
+        validator.reset();
+    }
+
+    CheckInferenceAllocations(myNetwork);
+    SaveModel(myNetwork, modelFile);
+    return true;
 }
 
-int main()
+//Writes the text training file as a binary dataset
+bool ConvertDataset(const std::string &textFilename, const std::string &binaryFilename, bool singlePrecision)
 {
-    unsigned inputNeurons = 4;
-    unsigned hiddenNeurons = 4;
-    unsigned outputNeurons = 3;
+    TrainingData trainData(textFilename);
+
+    std::vector<unsigned> topology;
+    trainData.GetTopology(topology);
+
+    BinaryDatasetWriter writer;
+    if (!writer.Open(binaryFilename, topology, singlePrecision ? BinaryDatasetFormat::Float32 : BinaryDatasetFormat::Float64))
+    {
+        std::cout << "Could not create " << binaryFilename << std::endl;
+        return false;
+    }
+
+    std::vector<double> inputVals, targetVals;
+    while (!trainData.IsEof())
+    {
+        if (trainData.GetNextInputs(inputVals) != topology[0])
+            break;
+        if (trainData.GetTargetOutputs(targetVals) != topology.back())
+            break;
 
-    unsigned numberOfSamples = 2000;
-    std::cout << "topology: "<< inputNeurons << " " << hiddenNeurons << " " << outputNeurons << std::endl;
+        writer.Write(inputVals.data(), targetVals.data());
+    }
 
-    for (unsigned i = 0; i < numberOfSamples; i++)
+    unsigned numSamples = writer.GetNumSamples();
+    if (!writer.Close())
     {
-        //down, back, up, forward
-        std::vector<unsigned> inputs;
-        std::cout << "In: ";
-        //Generate random inputs (0 or 1) 
-        for (unsigned j = 0; j < inputNeurons; j++)
+        std::cout << "Could not write " << binaryFilename << std::endl;
+        return false;
+    }
+
+    std::cout << "Converted " << numSamples << " samples into " << binaryFilename << std::endl;
+    return true;
+}
+
+template <typename T>
+void Train(TrainingData &trainData, const std::vector<unsigned> &topology, unsigned batchSize, Activation::Type activation,
+           unsigned numThreads, bool hogwild, const std::string &modelFile, Telemetry &telemetry)
+{
+    NetworkT<T> myNetwork(topology, activation);
+
+    if (numThreads > 0)
+    {
+        TrainInParallel(trainData, myNetwork, topology, batchSize,
+                        numThreads, hogwild ? ParallelTrainerT<T>::Hogwild : ParallelTrainerT<T>::Synchronous, telemetry);
+    }
+    else if (batchSize > 1)
+        TrainInBatches(trainData, myNetwork, topology, batchSize, telemetry);
+    else
+        TrainPerSample(trainData, myNetwork, topology, telemetry);
+
+    CheckInferenceAllocations(myNetwork);
+    SaveModel(myNetwork, modelFile);
+}
+
+int main(int argc, char *argv[])
+{
+    //--batch n trains in mini-batches of n samples instead of one sample at a time
+    //--float trains a single precision network instead of a double precision one
+    //--activation name picks the transfer function (tanh, rational-tanh, table-tanh, sigmoid or relu)
+    //--threads n trains data parallel on n threads (0 for every core), with mini-batches of --batch samples per thread
+    //--hogwild makes those threads update the weights asynchronously without locks
+    //--data file trains from another file, either a text or a binary dataset
+    //--convert file writes the data file as a binary dataset (single precision with --float) and exits
+    //--stream parses a text data file on a background thread while training, in batches of --batch samples
+    //--save file writes the trained network as a model file
+    //--model file loads a model file, runs it and exits
+    //--quantize with --model also runs an int8 copy of the model over the data file and reports the difference
+    //--epochs n loads the data file in memory and trains over it n times, shuffled every epoch
+    //--seed n seeds the epoch shuffling
+    //--compact with --epochs merges the repeated samples into weighted unique ones and trains every epoch as one full batch of them
+    //(always one batch on one thread, so it does not combine with --batch or --threads)
+    //--log file writes the training error of every --log-rate steps (samples or batches) as CSV, --log-binary file as binary records
+    //--summary n prints the average error every n steps (and at the end of every epoch)
+    //--validation f holds out a fraction f (e.g. 0.1) of the --epochs samples and reports the error over them, once per epoch
+    //--validate-every n evaluates the validation samples every n steps instead, on background threads
+    //--patience n stops once n evaluations in a row do not improve the best validation error by more than --min-delta x
+    //--best file writes the weights of every new best validation error as a model file
+    //--restore-best ends with the weights of the best validation error (the ones --save writes)
+    std::string dataFile = "../data/trainingData.txt";
+    std::string convertFile;
+    std::string saveFile;
+    std::string modelFile;
+    bool quantize = false;
+    unsigned epochs = 0;
+    uint64_t seed = 0;
+    bool compact = false;
+    std::string logFile;
+    Telemetry::Format logFormat = Telemetry::Csv;
+    unsigned logRate = 100;
+    unsigned summaryInterval = 1000;
+    ValidationOptions validation;
+    unsigned batchSize = 1;
+    bool singlePrecision = false;
+    unsigned numThreads = 0;
+    bool parallel = false;
+    bool hogwild = false;
+    bool streaming = false;
+    Activation::Type activation = Activation::Tanh;
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::string(argv[i]) == "--batch" && i + 1 < argc)
+            batchSize = (unsigned)std::stoul(argv[++i]);
+        else if (std::string(argv[i]) == "--float")
+            singlePrecision = true;
+        else if (std::string(argv[i]) == "--threads" && i + 1 < argc)
         {
-            unsigned input = rand() % 2;
-            inputs.push_back(input);
-            std::cout << input << ".0 ";
+            numThreads = (unsigned)std::stoul(argv[++i]);
+            parallel = true;
         }
-        std::cout << std::endl;
+        else if (std::string(argv[i]) == "--hogwild")
+            hogwild = true;
+        else if (std::string(argv[i]) == "--data" && i + 1 < argc)
+            dataFile = argv[++i];
+        else if (std::string(argv[i]) == "--convert" && i + 1 < argc)
+            convertFile = argv[++i];
+        else if (std::string(argv[i]) == "--stream")
+            streaming = true;
+        else if (std::string(argv[i]) == "--save" && i + 1 < argc)
+            saveFile = argv[++i];
+        else if (std::string(argv[i]) == "--model" && i + 1 < argc)
+            modelFile = argv[++i];
+        else if (std::string(argv[i]) == "--quantize")
+            quantize = true;
+        else if (std::string(argv[i]) == "--epochs" && i + 1 < argc)
+            epochs = (unsigned)std::stoul(argv[++i]);
+        else if (std::string(argv[i]) == "--seed" && i + 1 < argc)
+            seed = std::stoull(argv[++i]);
+        else if (std::string(argv[i]) == "--compact")
+            compact = true;
+        else if ((std::string(argv[i]) == "--log" || std::string(argv[i]) == "--log-binary") && i + 1 < argc)
+        {
+            logFormat = std::string(argv[i]) == "--log" ? Telemetry::Csv : Telemetry::Binary;
+            logFile = argv[++i];
+        }
+        else if (std::string(argv[i]) == "--log-rate" && i + 1 < argc)
+            logRate = (unsigned)std::stoul(argv[++i]);
+        else if (std::string(argv[i]) == "--summary" && i + 1 < argc)
+            summaryInterval = (unsigned)std::stoul(argv[++i]);
+        else if (std::string(argv[i]) == "--validation" && i + 1 < argc)
+            validation.Fraction = std::stod(argv[++i]);
+        else if (std::string(argv[i]) == "--validate-every" && i + 1 < argc)
+            validation.Interval = (unsigned)std::stoul(argv[++i]);
+        else if (std::string(argv[i]) == "--patience" && i + 1 < argc)
+            validation.Patience = (unsigned)std::stoul(argv[++i]);
+        else if (std::string(argv[i]) == "--min-delta" && i + 1 < argc)
+            validation.MinDelta = std::stod(argv[++i]);
+        else if (std::string(argv[i]) == "--best" && i + 1 < argc)
+            validation.BestModelFile = argv[++i];
+        else if (std::string(argv[i]) == "--restore-best")
+            validation.RestoreBest = true;
+        else if (std::string(argv[i]) == "--activation" && i + 1 < argc)
+        {
+            if (!Activation::ParseName(argv[++i], activation))
+            {
+                std::cout << "Invalid activation " << argv[i] << std::endl;
+                return 1;
+            }
+        }
+    }
+
+    if (!convertFile.empty())
+        return ConvertDataset(dataFile, convertFile, singlePrecision) ? 0 : 1;
 
-        std::cout << "Out: ";
-        //Generate valid output samples
-        std::cout << ShouldUp(inputs) << ".0 ";
-        std::cout << ShouldLeft(inputs) << ".0 ";
-        std::cout << ShouldRight(inputs) << ".0" << std::endl;
+    if (!modelFile.empty())
+    {
+        std::chrono::steady_clock::time_point loadStart = std::chrono::steady_clock::now();
+        ModelFile model;
+        if (!model.Open(modelFile))
+        {
+            std::cout << "Invalid model file " << modelFile << std::endl;
+            return 1;
+        }
+
+        if (model.GetDataType() == BinaryDatasetFormat::Float32)
+            RunModel<float>(model, loadStart, quantize, dataFile);
+        else
+            RunModel<double>(model, loadStart, quantize, dataFile);
+        return 0;
     }
+
+    if (compact && (batchSize > 1 || parallel))
+    {
+        std::cout << "Invalid --compact with --batch or --threads, a compacted dataset trains as one full batch" << std::endl;
+        return 1;
+    }
+
+    if (parallel && numThreads == 0)
+        numThreads = ParallelTrainer::GetHardwareThreads();
+
+    Telemetry telemetry;
+    if (!telemetry.Open(logFile, logFormat, logRate, summaryInterval))
+    {
+        std::cout << "Could not create " << logFile << std::endl;
+        return 1;
+    }
+
+    if (epochs > 0)
+    {
+        //Binary datasets keep the precision stored in the file
+        BinaryDataset dataset;
+        bool singleData = dataset.Open(dataFile) ? dataset.GetDataType() == BinaryDatasetFormat::Float32 : singlePrecision;
+        dataset.Close();
+
+        bool trained = singleData ? TrainEpochs<float>(dataFile, epochs, batchSize, activation, numThreads, hogwild, seed, compact, validation, saveFile, telemetry) :
+                                    TrainEpochs<double>(dataFile, epochs, batchSize, activation, numThreads, hogwild, seed, compact, validation, saveFile, telemetry);
+        if (!trained)
+            return 1;
+    }
+    else if (BinaryDataset::IsBinaryDataset(dataFile))
+    {
+        //The precision is the one stored in the file
+        BinaryDataset dataset;
+        if (!dataset.Open(dataFile))
+        {
+            std::cout << "Invalid binary dataset " << dataFile << std::endl;
+            return 1;
+        }
+
+        if (dataset.GetDataType() == BinaryDatasetFormat::Float32)
+            TrainOnDataset<float>(dataset, batchSize, activation, numThreads, hogwild, saveFile, telemetry);
+        else
+            TrainOnDataset<double>(dataset, batchSize, activation, numThreads, hogwild, saveFile, telemetry);
+    }
+    else if (streaming)
+    {
+        bool trained = singlePrecision ? TrainStreaming<float>(dataFile, batchSize, activation, saveFile, telemetry) :
+                                         TrainStreaming<double>(dataFile, batchSize, activation, saveFile, telemetry);
+        if (!trained)
+            return 1;
+    }
+    else
+    {
+        TrainingData trainData(dataFile);
+
+        std::vector<unsigned> topology;
+        trainData.GetTopology(topology);
+
+        if (singlePrecision)
+            Train<float>(trainData, topology, batchSize, activation, numThreads, hogwild, saveFile, telemetry);
+        else
+            Train<double>(trainData, topology, batchSize, activation, numThreads, hogwild, saveFile, telemetry);
+    }
+
+    telemetry.Close();
+    std::cout << std::endl << "Done!";
+    
     int a;
     std::cin >> a;
 
     return 0;
-}
-*/
\ No newline at end of file
+}
\ No newline at end of file
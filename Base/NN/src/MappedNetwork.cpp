@@ -0,0 +1,64 @@
+
+#include "MappedNetwork.h"
+#include "Kernels.h"
+
+template <typename T>
+MappedNetworkT<T>::MappedNetworkT()
+{
+    mActivation = Activation::Tanh;
+}
+
+template <typename T>
+bool MappedNetworkT<T>::Attach(const ModelFile &model)
+{
+    if (!model.IsOpen() || !model.GetWeights<T>(1))
+        return false;
+
+    mTopology = model.GetTopology();
+    mActivation = model.GetActivation();
+
+    mWeights.assign(mTopology.size(), nullptr);
+    mOutputs.resize(mTopology.size());
+    for (unsigned layerIdx = 0; layerIdx < mTopology.size(); layerIdx++)
+    {
+        if (layerIdx > 0)
+            mWeights[layerIdx] = model.GetWeights<T>(layerIdx);
+
+        mOutputs[layerIdx].assign(mTopology[layerIdx] + 1, (T)0);
+        mOutputs[layerIdx].back() = (T)model.GetBiasOutput();
+    }
+
+    return true;
+}
+
+template <typename T>
+void MappedNetworkT<T>::FeedForward(const T *inputVals)
+{
+    for (unsigned i = 0; i < mTopology[0]; i++)
+        mOutputs[0][i] = inputVals[i];
+
+    //Same products and transfer function as Network::FeedForward
+    for (unsigned layerIdx = 1; layerIdx < mTopology.size(); layerIdx++)
+    {
+        unsigned numInputs = mTopology[layerIdx - 1] + 1;
+        const T *inputs = mOutputs[layerIdx - 1].data();
+        const T *weights = mWeights[layerIdx];
+        T *outputs = mOutputs[layerIdx].data();
+
+        for (unsigned neuronIdx = 0; neuronIdx < mTopology[layerIdx]; neuronIdx++)
+            outputs[neuronIdx] = Kernels::Dot(inputs, &weights[neuronIdx * numInputs], numInputs);
+
+        Activation::Apply(mActivation, outputs, mTopology[layerIdx]);
+    }
+}
+
+template <typename T>
+void MappedNetworkT<T>::GetResults(T *resultVals) const
+{
+    const std::vector<T> &outputs = mOutputs.back();
+    for (unsigned i = 0; i < mTopology.back(); i++)
+        resultVals[i] = outputs[i];
+}
+
+template class MappedNetworkT<double>;
+template class MappedNetworkT<float>;
@@ -0,0 +1,227 @@
+
+#include "ModelFile.h"
+#include <cstring>
+#include <fstream>
+
+using namespace ModelFileFormat;
+
+//Byte at a time table, built once on first use (thread safe static initialization)
+struct Crc32Table
+{
+    uint32_t Values[256];
+
+    Crc32Table()
+    {
+        for (uint32_t i = 0; i < 256; i++)
+        {
+            uint32_t value = i;
+            for (unsigned bit = 0; bit < 8; bit++)
+                value = (value & 1) ? (value >> 1) ^ 0xedb88320u : value >> 1;
+            Values[i] = value;
+        }
+    }
+};
+
+uint32_t ModelFileFormat::Crc32(const void *data, size_t size, uint32_t crc)
+{
+    static const Crc32Table table;
+
+    const unsigned char *bytes = (const unsigned char *)data;
+    crc = ~crc;
+    for (size_t i = 0; i < size; i++)
+        crc = table.Values[(crc ^ bytes[i]) & 0xff] ^ (crc >> 8);
+
+    return ~crc;
+}
+
+uint64_t ModelFileFormat::GetLayerOffsets(const std::vector<unsigned> &topology, DataType dataType, std::vector<uint64_t> &offsets)
+{
+    offsets.assign(topology.size(), 0);
+
+    uint64_t offset = sizeof(Header) + topology.size() * sizeof(uint32_t);
+    for (unsigned layerIdx = 1; layerIdx < topology.size(); layerIdx++)
+    {
+        offsets[layerIdx] = BinaryDatasetFormat::Align(offset);
+        offset = offsets[layerIdx] + (uint64_t)topology[layerIdx] * (topology[layerIdx - 1] + 1) * BinaryDatasetFormat::GetDataTypeSize(dataType);
+    }
+
+    return offset;
+}
+
+ModelFile::ModelFile()
+{
+    mActivation = Activation::Tanh;
+    mDataType = BinaryDatasetFormat::Float64;
+    mBiasOutput = -1;
+}
+
+bool ModelFile::Open(const std::string &filename, bool verifyChecksum)
+{
+    Close();
+
+    if (!mFile.Open(filename) || mFile.GetSize() < sizeof(Header))
+    {
+        Close();
+        return false;
+    }
+
+    const unsigned char *data = mFile.GetData();
+    const Header *header = (const Header *)data;
+    if (memcmp(header->Magic, Magic, sizeof(Magic)) != 0 || header->Version != Version ||
+        header->DataType > BinaryDatasetFormat::Float32 || header->Activation >= Activation::Count ||
+        header->NumLayers < 2 || header->FileSize != mFile.GetSize() ||
+        sizeof(Header) + (uint64_t)header->NumLayers * sizeof(uint32_t) > header->FileSize)
+    {
+        Close();
+        return false;
+    }
+
+    //The topology has to describe exactly the weights in the file
+    const uint32_t *topology = (const uint32_t *)(data + sizeof(Header));
+    mTopology.assign(topology, topology + header->NumLayers);
+    mDataType = (DataType)header->DataType;
+    if (GetLayerOffsets(mTopology, mDataType, mLayerOffsets) != header->FileSize)
+    {
+        Close();
+        return false;
+    }
+
+    if (verifyChecksum && Crc32(data + sizeof(Header), mFile.GetSize() - sizeof(Header)) != header->Checksum)
+    {
+        Close();
+        return false;
+    }
+
+    mActivation = (Activation::Type)header->Activation;
+    mBiasOutput = header->BiasOutput;
+    return true;
+}
+
+void ModelFile::Close()
+{
+    mFile.Close();
+    mTopology.clear();
+    mLayerOffsets.clear();
+}
+
+template <typename T>
+bool ModelFile::LoadWeights(NetworkT<T> &network) const
+{
+    std::vector<unsigned> topology;
+    network.GetTopology(topology);
+    if (!IsOpen() || topology != mTopology)
+        return false;
+
+    //The bias column is negated when the network bias neurons output the opposite value
+    bool negateBias = (double)network.GetBiasOutput() != (double)mBiasOutput;
+
+    std::vector<T> weights;
+    for (unsigned layerIdx = 1; layerIdx < mTopology.size(); layerIdx++)
+    {
+        unsigned numInputs = mTopology[layerIdx - 1] + 1;
+        unsigned numWeights = mTopology[layerIdx] * numInputs;
+        const unsigned char *block = mFile.GetData() + mLayerOffsets[layerIdx];
+
+        weights.resize(numWeights);
+        for (unsigned i = 0; i < numWeights; i++)
+            weights[i] = mDataType == BinaryDatasetFormat::Float32 ? (T)((const float *)block)[i] : (T)((const double *)block)[i];
+
+        if (negateBias)
+        {
+            for (unsigned i = numInputs - 1; i < numWeights; i += numInputs)
+                weights[i] = -weights[i];
+        }
+
+        network.SetLayerWeights(layerIdx, weights.data());
+    }
+
+    return true;
+}
+
+template <typename T>
+bool ModelFile::Save(const std::string &filename, const NetworkT<T> &network)
+{
+    std::vector<unsigned> topology;
+    network.GetTopology(topology);
+
+    std::vector<const void *> layerWeights(topology.size(), nullptr);
+    for (unsigned layerIdx = 1; layerIdx < topology.size(); layerIdx++)
+        layerWeights[layerIdx] = network.GetLayerWeights(layerIdx);
+
+    return Save(filename, topology, network.GetActivation(), (int)network.GetBiasOutput(),
+                BinaryDatasetFormat::DataTypeOf<T>::Value, layerWeights);
+}
+
+template <typename T>
+bool ModelFile::Save(const std::string &filename, const std::vector<unsigned> &topology, Activation::Type activation,
+                     int biasOutput, const std::vector<T> &connectionWeights)
+{
+    //Connection order to row-major blocks
+    std::vector<std::vector<T> > blocks(topology.size());
+    std::vector<const void *> layerWeights(topology.size(), nullptr);
+    unsigned connectionIdx = 0;
+    for (unsigned layerIdx = 1; layerIdx < topology.size(); layerIdx++)
+    {
+        unsigned numInputs = topology[layerIdx - 1] + 1;
+        unsigned numNeurons = topology[layerIdx];
+        if (connectionIdx + numInputs * numNeurons > connectionWeights.size())
+            return false;
+
+        blocks[layerIdx].resize(numNeurons * numInputs);
+        for (unsigned inputIdx = 0; inputIdx < numInputs; inputIdx++)
+        {
+            for (unsigned neuronIdx = 0; neuronIdx < numNeurons; neuronIdx++)
+                blocks[layerIdx][neuronIdx * numInputs + inputIdx] = connectionWeights[connectionIdx++];
+        }
+        layerWeights[layerIdx] = blocks[layerIdx].data();
+    }
+
+    return Save(filename, topology, activation, biasOutput, BinaryDatasetFormat::DataTypeOf<T>::Value, layerWeights);
+}
+
+bool ModelFile::Save(const std::string &filename, const std::vector<unsigned> &topology, Activation::Type activation,
+                     int biasOutput, DataType dataType, const std::vector<const void *> &layerWeights)
+{
+    if (topology.size() < 2)
+        return false;
+
+    //The whole file is built in memory, the checksum covers it before it is written
+    std::vector<uint64_t> offsets;
+    std::vector<unsigned char> buffer((size_t)GetLayerOffsets(topology, dataType, offsets), 0);
+
+    std::vector<uint32_t> sizes(topology.begin(), topology.end());
+    memcpy(&buffer[sizeof(Header)], sizes.data(), sizes.size() * sizeof(uint32_t));
+
+    for (unsigned layerIdx = 1; layerIdx < topology.size(); layerIdx++)
+    {
+        size_t blockSize = (size_t)topology[layerIdx] * (topology[layerIdx - 1] + 1) * BinaryDatasetFormat::GetDataTypeSize(dataType);
+        memcpy(&buffer[(size_t)offsets[layerIdx]], layerWeights[layerIdx], blockSize);
+    }
+
+    Header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.Magic, Magic, sizeof(Magic));
+    header.Version = Version;
+    header.DataType = dataType;
+    header.Activation = activation;
+    header.NumLayers = (uint32_t)topology.size();
+    header.BiasOutput = biasOutput;
+    header.FileSize = buffer.size();
+    header.Checksum = Crc32(&buffer[sizeof(Header)], buffer.size() - sizeof(Header));
+    memcpy(&buffer[0], &header, sizeof(header));
+
+    std::ofstream file(filename.c_str(), std::ios::binary | std::ios::trunc);
+    file.write((const char *)buffer.data(), buffer.size());
+    return file.good();
+}
+
+template bool ModelFile::LoadWeights(NetworkT<double> &network) const;
+template bool ModelFile::LoadWeights(NetworkT<float> &network) const;
+
+template bool ModelFile::Save(const std::string &filename, const NetworkT<double> &network);
+template bool ModelFile::Save(const std::string &filename, const NetworkT<float> &network);
+
+template bool ModelFile::Save(const std::string &filename, const std::vector<unsigned> &topology, Activation::Type activation,
+                              int biasOutput, const std::vector<double> &connectionWeights);
+template bool ModelFile::Save(const std::string &filename, const std::vector<unsigned> &topology, Activation::Type activation,
+                              int biasOutput, const std::vector<float> &connectionWeights);
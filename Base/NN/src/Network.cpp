@@ -1,75 +1,128 @@
 
 #include "Network.h"
+#include "Kernels.h"
+#include "Activation.h"
+#include <algorithm>
 #include <cassert>
+#include <cmath>
 
-//Check
-Network::Network(const std::vector<unsigned> &topology)
+template <typename T>
+NetworkT<T>::NetworkT(const std::vector<unsigned> &topology, Activation::Type activation)
 {
+    mActivation = activation;
+    mError = 0.0;
     mRecentAverageError = 1.0;
     mRecentAverageSmoothingFactor = 1.0;
 
     //Create layers
     unsigned numLayers = (unsigned)topology.size();
+    mLayers.resize(numLayers);
     for (unsigned layerIdx = 0; layerIdx < numLayers; layerIdx++)
     {
-        mLayers.push_back(Layer());
+        Layer<T> &layer = mLayers[layerIdx];
+        layer.NumNeurons = topology[layerIdx];
+        layer.NumInputs = layerIdx == 0 ? 0 : topology[layerIdx - 1] + 1;
 
-        //if the layer is the last one there are no outputs
-        //if not the number of outputs is the number of neurons of the next layer.
-        unsigned numOutputs; // = layerIdx == topology.size() - 1 ? 0 : topology[layerIdx + 1];
-        if (layerIdx == numLayers - 1)
-            numOutputs = 0;
-        else
-            numOutputs = topology[layerIdx + 1];
+        //One extra output for the bias neuron, forced to a constant value
+        layer.Outputs.assign(layer.NumNeurons + 1, 0.0);
+        layer.Outputs.back() = -1.0;
+        layer.Gradients.assign(layer.NumNeurons, 0.0);
+        layer.Weights.assign(layer.NumNeurons * layer.NumInputs, 0.0);
+        layer.DeltaWeights.assign(layer.NumNeurons * layer.NumInputs, 0.0);
+    }
 
-        //Fill the layer with neurons (<= we are addin an extra neuron with a constant value (Bias))
-        unsigned numNeurons = topology[layerIdx];
-        for (unsigned neuronIdx = 0; neuronIdx <= numNeurons; neuronIdx++)
+    //Set a random weight for each connection, visiting them in the same order as the
+    //old per neuron layout did (source neuron first), so a given seed builds the same network
+    for (unsigned layerIdx = 1; layerIdx < numLayers; layerIdx++)
+    {
+        Layer<T> &layer = mLayers[layerIdx];
+        for (unsigned inputIdx = 0; inputIdx < layer.NumInputs; inputIdx++)
         {
-            //Add the new neurons at the start of the array (LIFO)
-            mLayers.back().push_back(Neuron(numOutputs, neuronIdx));
+            for (unsigned neuronIdx = 0; neuronIdx < layer.NumNeurons; neuronIdx++)
+                layer.Weights[neuronIdx * layer.NumInputs + inputIdx] = RandomWeight();
         }
+    }
+}
+
+template <typename T>
+template <typename U>
+NetworkT<T>::NetworkT(const NetworkT<U> &other)
+{
+    mError = other.mError;
+    mRecentAverageError = other.mRecentAverageError;
+    mRecentAverageSmoothingFactor = other.mRecentAverageSmoothingFactor;
+    mLearningRate = (T)other.mLearningRate;
+    mMomentum = (T)other.mMomentum;
+    mActivation = other.mActivation;
 
-        //Force the bias node's output value to 1.0
-        mLayers.back().back().SetOutputValue(-1.0);
+    mLayers.resize(other.mLayers.size());
+    for (unsigned layerIdx = 0; layerIdx < mLayers.size(); layerIdx++)
+    {
+        const Layer<U> &source = other.mLayers[layerIdx];
+        Layer<T> &layer = mLayers[layerIdx];
+        layer.NumNeurons = source.NumNeurons;
+        layer.NumInputs = source.NumInputs;
+
+        layer.Weights.assign(source.Weights.begin(), source.Weights.end());
+        layer.DeltaWeights.assign(source.DeltaWeights.begin(), source.DeltaWeights.end());
+        layer.Outputs.assign(source.Outputs.begin(), source.Outputs.end());
+        layer.Gradients.assign(source.Gradients.begin(), source.Gradients.end());
     }
 }
 
-//Check
-void Network::FeedForward(const std::vector<double>& inputVals)
+template <typename T>
+void NetworkT<T>::FeedForward(const std::vector<T>& inputVals)
 {
-    assert(inputVals.size() == mLayers[0].size() - 1);
+    assert(inputVals.size() == mLayers[0].NumNeurons);
+    FeedForward(inputVals.data());
+}
 
+template <typename T>
+void NetworkT<T>::FeedForward(const T *inputVals)
+{
     //Set the output values of the first layer(input layer) as the input values they receive
     //Because the input layer does not modify this values at all.
-    for(unsigned i = 0; i < inputVals.size(); i++)
-        mLayers[0][i].SetOutputValue(inputVals[i]);
+    for (unsigned i = 0; i < mLayers[0].NumNeurons; i++)
+        mLayers[0].Outputs[i] = inputVals[i];
 
     //Forward propagate
-    //Go over each neuron of the network excluding the last neuron of each layer (the bias neuron)
+    //Each layer is a matrix-vector product of its weights and the previous layer's outputs (bias included)
     for (unsigned layerIdx = 1; layerIdx < mLayers.size(); layerIdx++)
     {
-        Layer &prevLayer = mLayers[layerIdx - 1];
-        for (unsigned neuronIdx = 0; neuronIdx < mLayers[layerIdx].size() - 1; neuronIdx++)
-            mLayers[layerIdx][neuronIdx].FeedForward(prevLayer);
+        const Layer<T> &prevLayer = mLayers[layerIdx - 1];
+        Layer<T> &layer = mLayers[layerIdx];
+
+        //F = Sum (neuron input value * neuron weight)
+        const T *inputs = prevLayer.Outputs.data();
+        for (unsigned neuronIdx = 0; neuronIdx < layer.NumNeurons; neuronIdx++)
+            layer.Outputs[neuronIdx] = Kernels::Dot(inputs, &layer.Weights[neuronIdx * layer.NumInputs], layer.NumInputs);
+
+        //The transfer function runs over the whole layer at once
+        Activation::Apply(mActivation, layer.Outputs.data(), layer.NumNeurons);
     }
 }
 
-//Check
-void Network::BackPropagate(const std::vector<double>& targetVals)
+template <typename T>
+void NetworkT<T>::BackPropagate(const std::vector<T>& targetVals)
+{
+    BackPropagate(targetVals.data());
+}
+
+template <typename T>
+void NetworkT<T>::BackPropagate(const T *targetVals)
 {
     //Calculate overall net error (Root mean square error(RMS) of output network errors)
-    Layer &outputLayer = mLayers.back();
+    Layer<T> &outputLayer = mLayers.back();
     mError = 0.0;
 
     //RMS = sqrt((sum((target value - actual value)^2)) / quantity of values - 1)
-    for (unsigned neuronIdx = 0; neuronIdx < outputLayer.size() - 1; neuronIdx++)
+    for (unsigned neuronIdx = 0; neuronIdx < outputLayer.NumNeurons; neuronIdx++)
     {
-        double delta = targetVals[neuronIdx] - outputLayer[neuronIdx].GetOutputValue();
+        T delta = targetVals[neuronIdx] - outputLayer.Outputs[neuronIdx];
         mError += delta * delta;
     }
     //Get average error squared (not including bias)
-    mError /= outputLayer.size() - 1;
+    mError /= outputLayer.NumNeurons;
     //Get RMS
     mError = sqrt(mError);
 
@@ -78,35 +131,294 @@ void Network::BackPropagate(const std::vector<double>& targetVals)
                           (mRecentAverageSmoothingFactor + 1.0);
 
     //Calculate output layer gradients
-    for (unsigned neuronIdx = 0; neuronIdx < outputLayer.size() - 1; neuronIdx++)
-        outputLayer[neuronIdx].CalculateOutputGradients(targetVals[neuronIdx]);
+    for (unsigned neuronIdx = 0; neuronIdx < outputLayer.NumNeurons; neuronIdx++)
+    {
+        T delta = targetVals[neuronIdx] - outputLayer.Outputs[neuronIdx];
+        outputLayer.Gradients[neuronIdx] = delta * Activation::Derivative(mActivation, outputLayer.Outputs[neuronIdx]);
+    }
 
     //Calculate hidden layers gradients (from back to front)
+    //Sum of the derivatives of the weights of the next layer: transposed product of its weights and gradients
     for (unsigned layerIdx = (unsigned)mLayers.size() - 2; layerIdx > 0; layerIdx--)
     {
-        Layer &hiddenLayer = mLayers[layerIdx];
-        Layer &nextLayer = mLayers[layerIdx + 1];
+        Layer<T> &hiddenLayer = mLayers[layerIdx];
+        const Layer<T> &nextLayer = mLayers[layerIdx + 1];
+
+        T *gradients = hiddenLayer.Gradients.data();
+        for (unsigned neuronIdx = 0; neuronIdx < hiddenLayer.NumNeurons; neuronIdx++)
+            gradients[neuronIdx] = 0.0;
 
-        for (unsigned neuronIdx = 0; neuronIdx < hiddenLayer.size(); neuronIdx++)
-            hiddenLayer[neuronIdx].CalculateHiddenGradients(nextLayer);
+        for (unsigned nextIdx = 0; nextIdx < nextLayer.NumNeurons; nextIdx++)
+            Kernels::Axpy(nextLayer.Gradients[nextIdx], &nextLayer.Weights[nextIdx * nextLayer.NumInputs], gradients, hiddenLayer.NumNeurons);
+
+        Activation::MultiplyDerivative(mActivation, hiddenLayer.Outputs.data(), gradients, hiddenLayer.NumNeurons);
     }
 
     //Update connection weights for all layers except the input layer (from back to front)
     for (unsigned layerIdx = (unsigned)mLayers.size() - 1; layerIdx > 0; layerIdx--)
     {
-        Layer &layer = mLayers[layerIdx];
-        Layer &prevLayer = mLayers[layerIdx -1];
+        Layer<T> &layer = mLayers[layerIdx];
+        const T *inputs = mLayers[layerIdx - 1].Outputs.data();
+
+        //The output value of the previous neurons magnified by the gradient and the learning rate
+        //And the momentum will determine what percentage of the previous delta weight is maintained
+        for (unsigned neuronIdx = 0; neuronIdx < layer.NumNeurons; neuronIdx++)
+        {
+            unsigned rowIdx = neuronIdx * layer.NumInputs;
+            Kernels::UpdateWeights(mLearningRate * layer.Gradients[neuronIdx], inputs, mMomentum,
+                                   &layer.DeltaWeights[rowIdx], &layer.Weights[rowIdx], layer.NumInputs);
+        }
+    }
+}
+
+template <typename T>
+void NetworkT<T>::GetResults(std::vector<T>& resultVals) const
+{
+    //Get the output values of the last layer (output layer) without the bias neuron
+    const Layer<T> &outputLayer = mLayers.back();
+    resultVals.assign(outputLayer.Outputs.begin(), outputLayer.Outputs.begin() + outputLayer.NumNeurons);
+}
+
+template <typename T>
+void NetworkT<T>::GetResults(T *resultVals) const
+{
+    const Layer<T> &outputLayer = mLayers.back();
+    std::copy(outputLayer.Outputs.begin(), outputLayer.Outputs.begin() + outputLayer.NumNeurons, resultVals);
+}
+
+template <typename T>
+void NetworkT<T>::ResizeBatch(unsigned batchSize)
+{
+    for (unsigned layerIdx = 0; layerIdx < mLayers.size(); layerIdx++)
+    {
+        Layer<T> &layer = mLayers[layerIdx];
+        unsigned stride = layer.NumNeurons + 1;
+        if (layer.BatchOutputs.size() == batchSize * stride)
+            continue;
+
+        //The last column of every row is the bias neuron
+        layer.BatchOutputs.assign(batchSize * stride, 0.0);
+        for (unsigned sampleIdx = 0; sampleIdx < batchSize; sampleIdx++)
+            layer.BatchOutputs[sampleIdx * stride + layer.NumNeurons] = layer.Outputs.back();
+
+        layer.BatchGradients.assign(batchSize * layer.NumNeurons, 0.0);
+        layer.WeightGradients.assign(layer.Weights.size(), 0.0);
+    }
+}
+
+template <typename T>
+void NetworkT<T>::TrainBatch(const std::vector<T> &inputs, const std::vector<T> &targets, unsigned batchSize)
+{
+    assert(inputs.size() == batchSize * mLayers[0].NumNeurons);
+    assert(targets.size() == batchSize * mLayers.back().NumNeurons);
+
+    TrainBatch(inputs.data(), targets.data(), batchSize);
+}
+
+template <typename T>
+void NetworkT<T>::TrainBatch(const T *inputs, const T *targets, unsigned batchSize)
+{
+    ComputeBatchGradients(inputs, targets, batchSize);
+    UpdateRecentAverageError();
+    ApplyWeightGradients(mLearningRate / (T)batchSize);
+}
+
+template <typename T>
+void NetworkT<T>::TrainBatch(const T *inputs, const T *targets, const T *weights, unsigned batchSize)
+{
+    double weightSum = 0.0;
+    for (unsigned sampleIdx = 0; sampleIdx < batchSize; sampleIdx++)
+        weightSum += weights[sampleIdx];
+    //A batch without weight has no gradient to average, leave the network alone
+    if (weightSum <= 0.0)
+        return;
+
+    ComputeBatchGradients(inputs, targets, batchSize, weights);
+    UpdateRecentAverageError();
+    ApplyWeightGradients((T)(mLearningRate / weightSum));
+}
+
+template <typename T>
+void NetworkT<T>::ComputeBatchGradients(const T *inputs, const T *targets, unsigned batchSize, const T *weights)
+{
+    ResizeBatch(batchSize);
+
+    //Copy the inputs into the input layer rows (leaving the bias column alone)
+    Layer<T> &inputLayer = mLayers[0];
+    for (unsigned sampleIdx = 0; sampleIdx < batchSize; sampleIdx++)
+    {
+        for (unsigned i = 0; i < inputLayer.NumNeurons; i++)
+            inputLayer.BatchOutputs[sampleIdx * (inputLayer.NumNeurons + 1) + i] = inputs[sampleIdx * inputLayer.NumNeurons + i];
+    }
+
+    //Forward propagate: outputs[batch x neurons] = inputs[batch x inputs] * weights[neurons x inputs]^T
+    for (unsigned layerIdx = 1; layerIdx < mLayers.size(); layerIdx++)
+    {
+        const Layer<T> &prevLayer = mLayers[layerIdx - 1];
+        Layer<T> &layer = mLayers[layerIdx];
+        unsigned stride = layer.NumNeurons + 1;
+
+        Kernels::GemmNT(batchSize, layer.NumNeurons, layer.NumInputs, prevLayer.BatchOutputs.data(), layer.NumInputs,
+                        layer.Weights.data(), layer.NumInputs, layer.BatchOutputs.data(), stride);
+
+        for (unsigned sampleIdx = 0; sampleIdx < batchSize; sampleIdx++)
+            Activation::Apply(mActivation, &layer.BatchOutputs[sampleIdx * stride], layer.NumNeurons);
+    }
+
+    //Output layer gradients and the batch average of the RMS error. A sample weight scales its gradients,
+    //the backward pass is linear in them so every weight gradient gets the sample weight too
+    Layer<T> &outputLayer = mLayers.back();
+    unsigned outputStride = outputLayer.NumNeurons + 1;
+    mError = 0.0;
+    double weightSum = 0.0;
+    for (unsigned sampleIdx = 0; sampleIdx < batchSize; sampleIdx++)
+    {
+        const T *outputs = &outputLayer.BatchOutputs[sampleIdx * outputStride];
+        const T *sampleTargets = &targets[sampleIdx * outputLayer.NumNeurons];
+        T *gradients = &outputLayer.BatchGradients[sampleIdx * outputLayer.NumNeurons];
+
+        double sampleError = 0.0;
+        for (unsigned neuronIdx = 0; neuronIdx < outputLayer.NumNeurons; neuronIdx++)
+        {
+            T delta = sampleTargets[neuronIdx] - outputs[neuronIdx];
+            sampleError += delta * delta;
+            gradients[neuronIdx] = delta * Activation::Derivative(mActivation, outputs[neuronIdx]);
+        }
+
+        if (weights)
+        {
+            T weight = weights[sampleIdx];
+            for (unsigned neuronIdx = 0; neuronIdx < outputLayer.NumNeurons; neuronIdx++)
+                gradients[neuronIdx] *= weight;
+            mError += weight * sqrt(sampleError / outputLayer.NumNeurons);
+            weightSum += weight;
+        }
+        else
+            mError += sqrt(sampleError / outputLayer.NumNeurons);
+    }
+    mError /= weights ? weightSum : batchSize;
+
+    //Hidden layers gradients: gradients[batch x neurons] = next gradients[batch x next neurons] * next weights[next neurons x neurons]
+    for (unsigned layerIdx = (unsigned)mLayers.size() - 2; layerIdx > 0; layerIdx--)
+    {
+        Layer<T> &hiddenLayer = mLayers[layerIdx];
+        const Layer<T> &nextLayer = mLayers[layerIdx + 1];
+
+        Kernels::GemmNN(batchSize, hiddenLayer.NumNeurons, nextLayer.NumNeurons, nextLayer.BatchGradients.data(), nextLayer.NumNeurons,
+                        nextLayer.Weights.data(), nextLayer.NumInputs, hiddenLayer.BatchGradients.data(), hiddenLayer.NumNeurons);
+
+        for (unsigned sampleIdx = 0; sampleIdx < batchSize; sampleIdx++)
+        {
+            Activation::MultiplyDerivative(mActivation, &hiddenLayer.BatchOutputs[sampleIdx * (hiddenLayer.NumNeurons + 1)],
+                                           &hiddenLayer.BatchGradients[sampleIdx * hiddenLayer.NumNeurons], hiddenLayer.NumNeurons);
+        }
+    }
+
+    //Accumulate the weight gradients (gradients^T * inputs)
+    for (unsigned layerIdx = (unsigned)mLayers.size() - 1; layerIdx > 0; layerIdx--)
+    {
+        Layer<T> &layer = mLayers[layerIdx];
+        const Layer<T> &prevLayer = mLayers[layerIdx - 1];
 
-        for (unsigned neuronIdx = 0; neuronIdx < layer.size() - 1; neuronIdx++)
-            layer[neuronIdx].UpdateInputWeights(prevLayer);
+        layer.WeightGradients.assign(layer.WeightGradients.size(), 0.0);
+        Kernels::GemmTN(layer.NumNeurons, layer.NumInputs, batchSize, layer.BatchGradients.data(), layer.NumNeurons,
+                        prevLayer.BatchOutputs.data(), layer.NumInputs, layer.WeightGradients.data(), layer.NumInputs);
     }
 }
 
-void Network::GetResults(std::vector<double>& resultVals) const
+template <typename T>
+void NetworkT<T>::ApplyWeightGradients(T scale)
 {
-    resultVals.clear();
+    //One momentum update per layer
+    for (unsigned layerIdx = (unsigned)mLayers.size() - 1; layerIdx > 0; layerIdx--)
+    {
+        Layer<T> &layer = mLayers[layerIdx];
+        for (unsigned neuronIdx = 0; neuronIdx < layer.NumNeurons; neuronIdx++)
+        {
+            unsigned rowIdx = neuronIdx * layer.NumInputs;
+            Kernels::UpdateWeights(scale, &layer.WeightGradients[rowIdx], mMomentum,
+                                   &layer.DeltaWeights[rowIdx], &layer.Weights[rowIdx], layer.NumInputs);
+        }
+    }
+}
 
-    //Get the output values of the last layer (output layer) and save them on the result vals vector
-    for (unsigned neuronIdx = 0; neuronIdx < mLayers.back().size() - 1; neuronIdx++)
-        resultVals.push_back(mLayers.back()[neuronIdx].GetOutputValue());
+template <typename T>
+void NetworkT<T>::UpdateRecentAverageError()
+{
+    //Recent average measurement
+    mRecentAverageError = (mRecentAverageError * mRecentAverageSmoothingFactor + mError) /
+                          (mRecentAverageSmoothingFactor + 1.0);
+}
+
+template <typename T>
+template <typename U>
+void NetworkT<T>::SetConnectionWeights(const std::vector<U> &w)
+{
+    unsigned connectionIdx = 0;
+    for (unsigned layerIdx = 1; layerIdx < mLayers.size(); layerIdx++)
+    {
+        Layer<T> &layer = mLayers[layerIdx];
+        for (unsigned inputIdx = 0; inputIdx < layer.NumInputs; inputIdx++)
+        {
+            for (unsigned neuronIdx = 0; neuronIdx < layer.NumNeurons; neuronIdx++)
+            {
+                layer.Weights[neuronIdx * layer.NumInputs + inputIdx] = (T)w[connectionIdx];
+                connectionIdx++;
+            }
+        }
+
+        //New connections start without momentum
+        layer.DeltaWeights.assign(layer.DeltaWeights.size(), 0.0);
+    }
+}
+
+template <typename T>
+template <typename U>
+void NetworkT<T>::GetConnectionWeights(std::vector<U> &w) const
+{
+    w.clear();
+
+    for (unsigned layerIdx = 1; layerIdx < mLayers.size(); layerIdx++)
+    {
+        const Layer<T> &layer = mLayers[layerIdx];
+        for (unsigned inputIdx = 0; inputIdx < layer.NumInputs; inputIdx++)
+        {
+            for (unsigned neuronIdx = 0; neuronIdx < layer.NumNeurons; neuronIdx++)
+                w.push_back((U)layer.Weights[neuronIdx * layer.NumInputs + inputIdx]);
+        }
+    }
 }
+
+template <typename T>
+void NetworkT<T>::GetTopology(std::vector<unsigned> &topology) const
+{
+    topology.clear();
+    for (unsigned layerIdx = 0; layerIdx < mLayers.size(); layerIdx++)
+        topology.push_back(mLayers[layerIdx].NumNeurons);
+}
+
+template <typename T>
+void NetworkT<T>::SetLayerWeights(unsigned layerIdx, const T *weights)
+{
+    Layer<T> &layer = mLayers[layerIdx];
+    layer.Weights.assign(weights, weights + layer.Weights.size());
+
+    //New connections start without momentum
+    layer.DeltaWeights.assign(layer.DeltaWeights.size(), 0.0);
+}
+
+template class NetworkT<double>;
+template class NetworkT<float>;
+
+template NetworkT<double>::NetworkT(const NetworkT<float> &other);
+template NetworkT<float>::NetworkT(const NetworkT<double> &other);
+
+template void NetworkT<double>::SetConnectionWeights(const std::vector<double> &w);
+template void NetworkT<double>::SetConnectionWeights(const std::vector<float> &w);
+template void NetworkT<float>::SetConnectionWeights(const std::vector<double> &w);
+template void NetworkT<float>::SetConnectionWeights(const std::vector<float> &w);
+
+template void NetworkT<double>::GetConnectionWeights(std::vector<double> &w) const;
+template void NetworkT<double>::GetConnectionWeights(std::vector<float> &w) const;
+template void NetworkT<float>::GetConnectionWeights(std::vector<double> &w) const;
+template void NetworkT<float>::GetConnectionWeights(std::vector<float> &w) const;
@@ -0,0 +1,240 @@
+
+#include "ParallelTrainer.h"
+#include "Kernels.h"
+#include <algorithm>
+#include <cassert>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+//Blocks until every thread of the epoch reaches it, reusable step after step
+class StepBarrier
+{
+public:
+    explicit StepBarrier(unsigned numThreads) : mNumThreads(numThreads), mWaiting(0), mGeneration(0) {}
+
+    void Wait()
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        unsigned generation = mGeneration;
+        if (++mWaiting == mNumThreads)
+        {
+            mWaiting = 0;
+            mGeneration++;
+            mCondition.notify_all();
+        }
+        else
+            mCondition.wait(lock, [&]() { return generation != mGeneration; });
+    }
+
+private:
+    std::mutex mMutex;
+    std::condition_variable mCondition;
+    unsigned mNumThreads;
+    unsigned mWaiting;
+    unsigned mGeneration;
+};
+
+template <typename T>
+ParallelTrainerT<T>::ParallelTrainerT(NetworkT<T> &network, unsigned numThreads, Mode mode) : mNetwork(network)
+{
+    mMode = mode;
+    mEpochError = 0.0;
+    mEpochSteps = 0;
+
+    if (numThreads == 0)
+        numThreads = GetHardwareThreads();
+
+    mWorkers.reserve(numThreads);
+    for (unsigned i = 0; i < numThreads; i++)
+        mWorkers.push_back(Worker(network));
+}
+
+template <typename T>
+void ParallelTrainerT<T>::TrainEpoch(const std::vector<T> &inputs, const std::vector<T> &targets, unsigned batchSize)
+{
+    unsigned numSamples = (unsigned)(inputs.size() / mNetwork.GetNumInputs());
+    assert(targets.size() == numSamples * mNetwork.GetNumOutputs());
+
+    TrainEpoch(inputs.data(), targets.data(), numSamples, batchSize);
+}
+
+template <typename T>
+void ParallelTrainerT<T>::TrainEpoch(const T *inputs, const T *targets, unsigned numSamples, unsigned batchSize)
+{
+    assert(batchSize > 0);
+
+    unsigned numThreads = (unsigned)mWorkers.size();
+    unsigned shardSize = numSamples / numThreads;
+    unsigned remainder = numSamples % numThreads;
+
+    //Every thread takes the same number of steps, the first shards get one sample more
+    unsigned numSteps = (shardSize + (remainder > 0 ? 1 : 0) + batchSize - 1) / batchSize;
+    StepBarrier barrier(numThreads);
+
+    for (unsigned workerIdx = 0; workerIdx < numThreads; workerIdx++)
+    {
+        LoadWeights(mWorkers[workerIdx]);
+        mWorkers[workerIdx].ErrorSum = 0.0;
+    }
+
+    std::vector<std::thread> threads;
+    unsigned firstSample = 0;
+    mEpochSteps = mMode == Synchronous ? numSteps : 0;
+    for (unsigned workerIdx = 0; workerIdx < numThreads; workerIdx++)
+    {
+        unsigned samples = shardSize + (workerIdx < remainder ? 1 : 0);
+        if (mMode == Hogwild)
+            mEpochSteps += (samples + batchSize - 1) / batchSize;
+
+        //The calling thread trains the first shard
+        if (workerIdx > 0)
+        {
+            threads.push_back(std::thread(&ParallelTrainerT<T>::TrainShard, this, workerIdx, inputs, targets,
+                                          firstSample, samples, batchSize, numSteps, &barrier));
+        }
+        firstSample += samples;
+    }
+
+    TrainShard(0, inputs, targets, 0, shardSize + (remainder > 0 ? 1 : 0), batchSize, numSteps, &barrier);
+    for (unsigned i = 0; i < threads.size(); i++)
+        threads[i].join();
+
+    double errorSum = 0.0;
+    for (unsigned workerIdx = 0; workerIdx < numThreads; workerIdx++)
+        errorSum += mWorkers[workerIdx].ErrorSum;
+    mEpochError = numSamples > 0 ? errorSum / numSamples : 0.0;
+
+    //Synchronous steps already track the recent average error, batch by batch
+    if (mMode == Hogwild && numSamples > 0)
+    {
+        mNetwork.mError = mEpochError;
+        mNetwork.UpdateRecentAverageError();
+    }
+}
+
+template <typename T>
+void ParallelTrainerT<T>::TrainShard(unsigned workerIdx, const T *inputs, const T *targets, unsigned firstSample, unsigned numSamples,
+                                     unsigned batchSize, unsigned numSteps, StepBarrier *barrier)
+{
+    Worker &worker = mWorkers[workerIdx];
+
+    if (mMode == Hogwild)
+    {
+        for (unsigned sampleIdx = 0; sampleIdx < numSamples; sampleIdx += batchSize)
+        {
+            //Reads the shared weights while other threads may be writing them
+            LoadWeights(worker);
+            ComputeGradients(worker, inputs, targets, firstSample + sampleIdx, std::min(batchSize, numSamples - sampleIdx));
+            ApplyHogwildStep(worker);
+        }
+        return;
+    }
+
+    for (unsigned step = 0; step < numSteps; step++)
+    {
+        unsigned sampleIdx = step * batchSize;
+        unsigned samples = sampleIdx < numSamples ? std::min(batchSize, numSamples - sampleIdx) : 0;
+        ComputeGradients(worker, inputs, targets, firstSample + sampleIdx, samples);
+
+        //Every gradient is ready, one thread reduces them and updates the network
+        barrier->Wait();
+        if (workerIdx == 0)
+            ApplySynchronousStep();
+
+        //The network has the new weights, every copy reloads them
+        barrier->Wait();
+        LoadWeights(worker);
+    }
+}
+
+template <typename T>
+void ParallelTrainerT<T>::ComputeGradients(Worker &worker, const T *inputs, const T *targets, unsigned firstSample, unsigned numSamples)
+{
+    worker.BatchSamples = numSamples;
+    if (numSamples == 0)
+        return;
+
+    worker.Network.ComputeBatchGradients(&inputs[firstSample * mNetwork.GetNumInputs()],
+                                         &targets[firstSample * mNetwork.GetNumOutputs()], numSamples);
+    worker.ErrorSum += worker.Network.mError * numSamples;
+}
+
+template <typename T>
+void ParallelTrainerT<T>::ApplySynchronousStep()
+{
+    unsigned totalSamples = 0;
+    double error = 0.0;
+    for (unsigned workerIdx = 0; workerIdx < mWorkers.size(); workerIdx++)
+    {
+        totalSamples += mWorkers[workerIdx].BatchSamples;
+        error += mWorkers[workerIdx].Network.mError * mWorkers[workerIdx].BatchSamples;
+    }
+
+    if (totalSamples == 0)
+        return;
+
+    //Sum the gradients always in thread order, the result does not depend on which thread finished first
+    for (unsigned layerIdx = 1; layerIdx < mNetwork.mLayers.size(); layerIdx++)
+    {
+        Layer<T> &layer = mNetwork.mLayers[layerIdx];
+        layer.WeightGradients.assign(layer.Weights.size(), (T)0);
+
+        for (unsigned workerIdx = 0; workerIdx < mWorkers.size(); workerIdx++)
+        {
+            const Worker &worker = mWorkers[workerIdx];
+            if (worker.BatchSamples > 0)
+                Kernels::Axpy((T)1, worker.Network.mLayers[layerIdx].WeightGradients.data(), layer.WeightGradients.data(), (unsigned)layer.Weights.size());
+        }
+    }
+
+    mNetwork.mError = error / totalSamples;
+    mNetwork.UpdateRecentAverageError();
+    mNetwork.ApplyWeightGradients(mNetwork.mLearningRate / (T)totalSamples);
+}
+
+template <typename T>
+void ParallelTrainerT<T>::ApplyHogwildStep(Worker &worker)
+{
+    if (worker.BatchSamples == 0)
+        return;
+
+    //The momentum stays private to the thread, the update goes into the shared weights
+    T scale = mNetwork.mLearningRate / (T)worker.BatchSamples;
+    for (unsigned layerIdx = 1; layerIdx < mNetwork.mLayers.size(); layerIdx++)
+    {
+        Layer<T> &layer = worker.Network.mLayers[layerIdx];
+        T *sharedWeights = mNetwork.mLayers[layerIdx].Weights.data();
+
+        for (unsigned neuronIdx = 0; neuronIdx < layer.NumNeurons; neuronIdx++)
+        {
+            unsigned rowIdx = neuronIdx * layer.NumInputs;
+            Kernels::UpdateWeights(scale, &layer.WeightGradients[rowIdx], mNetwork.mMomentum,
+                                   &layer.DeltaWeights[rowIdx], &sharedWeights[rowIdx], layer.NumInputs);
+        }
+    }
+}
+
+template <typename T>
+void ParallelTrainerT<T>::LoadWeights(Worker &worker)
+{
+    //Same sizes on both sides, no allocation
+    for (unsigned layerIdx = 1; layerIdx < mNetwork.mLayers.size(); layerIdx++)
+        worker.Network.mLayers[layerIdx].Weights = mNetwork.mLayers[layerIdx].Weights;
+}
+
+template <typename T>
+unsigned ParallelTrainerT<T>::GetHardwareThreads()
+{
+    unsigned numThreads = std::thread::hardware_concurrency();
+    return numThreads > 0 ? numThreads : 1;
+}
+
+template <typename T>
+const char *ParallelTrainerT<T>::GetModeName(Mode mode)
+{
+    return mode == Hogwild ? "hogwild" : "synchronous";
+}
+
+template class ParallelTrainerT<double>;
+template class ParallelTrainerT<float>;
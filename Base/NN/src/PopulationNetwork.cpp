@@ -0,0 +1,143 @@
+
+#include "PopulationNetwork.h"
+#include "Kernels.h"
+#include <cassert>
+
+template <typename T>
+PopulationNetworkT<T>::PopulationNetworkT(const std::vector<unsigned> &topology, unsigned numGenomes, Activation::Type activation)
+{
+    mActivation = activation;
+    mNumGenomes = numGenomes;
+
+    //Every row starts on a 64 bytes boundary relative to the first one
+    const unsigned lineValues = 64 / sizeof(T);
+    mStride = (numGenomes + lineValues - 1) / lineValues * lineValues;
+
+    mNumWeights = 0;
+    mLayers.resize(topology.size());
+    for (unsigned layerIdx = 0; layerIdx < topology.size(); layerIdx++)
+    {
+        PopulationLayer &layer = mLayers[layerIdx];
+        layer.NumNeurons = topology[layerIdx];
+        layer.NumInputs = layerIdx > 0 ? topology[layerIdx - 1] + 1 : 0;
+        layer.Weights.assign(layer.NumNeurons * layer.NumInputs * mStride, (T)0);
+        mNumWeights += layer.NumNeurons * layer.NumInputs;
+
+        //Same constant output for the bias neuron as the Network
+        layer.Outputs.assign((layer.NumNeurons + 1) * mStride, (T)0);
+        for (unsigned genome = 0; genome < mStride; genome++)
+            layer.Outputs[layer.NumNeurons * mStride + genome] = (T)-1;
+    }
+}
+
+template <typename T>
+template <typename U>
+void PopulationNetworkT<T>::SetGenomeWeights(unsigned genome, const std::vector<U> &w)
+{
+    assert(w.size() == mNumWeights);
+
+    SetGenomeWeights(genome, w.data());
+}
+
+template <typename T>
+template <typename U>
+void PopulationNetworkT<T>::SetGenomeWeights(unsigned genome, const U *w)
+{
+    assert(genome < mNumGenomes);
+
+    unsigned connectionIdx = 0;
+    for (unsigned layerIdx = 1; layerIdx < mLayers.size(); layerIdx++)
+    {
+        PopulationLayer &layer = mLayers[layerIdx];
+        for (unsigned inputIdx = 0; inputIdx < layer.NumInputs; inputIdx++)
+        {
+            for (unsigned neuronIdx = 0; neuronIdx < layer.NumNeurons; neuronIdx++)
+            {
+                layer.Weights[(neuronIdx * layer.NumInputs + inputIdx) * mStride + genome] = (T)w[connectionIdx];
+                connectionIdx++;
+            }
+        }
+    }
+}
+
+template <typename T>
+template <typename U>
+void PopulationNetworkT<T>::GetGenomeWeights(unsigned genome, std::vector<U> &w) const
+{
+    w.clear();
+
+    for (unsigned layerIdx = 1; layerIdx < mLayers.size(); layerIdx++)
+    {
+        const PopulationLayer &layer = mLayers[layerIdx];
+        for (unsigned inputIdx = 0; inputIdx < layer.NumInputs; inputIdx++)
+        {
+            for (unsigned neuronIdx = 0; neuronIdx < layer.NumNeurons; neuronIdx++)
+                w.push_back((U)layer.Weights[(neuronIdx * layer.NumInputs + inputIdx) * mStride + genome]);
+        }
+    }
+}
+
+template <typename T>
+void PopulationNetworkT<T>::SetInputs(const T *inputVals)
+{
+    PopulationLayer &inputLayer = mLayers[0];
+    for (unsigned i = 0; i < inputLayer.NumNeurons; i++)
+    {
+        T *row = &inputLayer.Outputs[i * mStride];
+        for (unsigned genome = 0; genome < mNumGenomes; genome++)
+            row[genome] = inputVals[i];
+    }
+}
+
+template <typename T>
+void PopulationNetworkT<T>::SetGenomeInputs(unsigned genome, const T *inputVals)
+{
+    PopulationLayer &inputLayer = mLayers[0];
+    for (unsigned i = 0; i < inputLayer.NumNeurons; i++)
+        inputLayer.Outputs[i * mStride + genome] = inputVals[i];
+}
+
+template <typename T>
+void PopulationNetworkT<T>::FeedForward()
+{
+    for (unsigned layerIdx = 1; layerIdx < mLayers.size(); layerIdx++)
+    {
+        const PopulationLayer &prevLayer = mLayers[layerIdx - 1];
+        PopulationLayer &layer = mLayers[layerIdx];
+
+        //Output row of a neuron = column wise dot product of the input rows (bias included) and its weight rows
+        for (unsigned neuronIdx = 0; neuronIdx < layer.NumNeurons; neuronIdx++)
+        {
+            Kernels::ColumnDot(prevLayer.Outputs.data(), &layer.Weights[neuronIdx * layer.NumInputs * mStride], mStride,
+                               layer.NumInputs, &layer.Outputs[neuronIdx * mStride], mNumGenomes);
+        }
+
+        //The rows are contiguous, the transfer function runs over the whole layer at once
+        Activation::Apply(mActivation, layer.Outputs.data(), layer.NumNeurons * mStride);
+    }
+}
+
+template <typename T>
+void PopulationNetworkT<T>::GetGenomeResults(unsigned genome, T *resultVals) const
+{
+    const PopulationLayer &outputLayer = mLayers.back();
+    for (unsigned i = 0; i < outputLayer.NumNeurons; i++)
+        resultVals[i] = outputLayer.Outputs[i * mStride + genome];
+}
+
+template class PopulationNetworkT<double>;
+template class PopulationNetworkT<float>;
+
+template void PopulationNetworkT<double>::SetGenomeWeights(unsigned genome, const std::vector<double> &w);
+template void PopulationNetworkT<double>::SetGenomeWeights(unsigned genome, const std::vector<float> &w);
+template void PopulationNetworkT<float>::SetGenomeWeights(unsigned genome, const std::vector<double> &w);
+template void PopulationNetworkT<float>::SetGenomeWeights(unsigned genome, const std::vector<float> &w);
+template void PopulationNetworkT<double>::SetGenomeWeights(unsigned genome, const double *w);
+template void PopulationNetworkT<double>::SetGenomeWeights(unsigned genome, const float *w);
+template void PopulationNetworkT<float>::SetGenomeWeights(unsigned genome, const double *w);
+template void PopulationNetworkT<float>::SetGenomeWeights(unsigned genome, const float *w);
+
+template void PopulationNetworkT<double>::GetGenomeWeights(unsigned genome, std::vector<double> &w) const;
+template void PopulationNetworkT<double>::GetGenomeWeights(unsigned genome, std::vector<float> &w) const;
+template void PopulationNetworkT<float>::GetGenomeWeights(unsigned genome, std::vector<double> &w) const;
+template void PopulationNetworkT<float>::GetGenomeWeights(unsigned genome, std::vector<float> &w) const;
@@ -0,0 +1,136 @@
+
+#include "QuantizedNetwork.h"
+#include "Kernels.h"
+#include <algorithm>
+#include <cmath>
+
+template <typename T>
+QuantizedNetwork::QuantizedNetwork(const NetworkT<T> &network)
+{
+    std::vector<unsigned> topology;
+    network.GetTopology(topology);
+    mActivation = network.GetActivation();
+
+    mLayers.resize(topology.size());
+    mOutputs.resize(topology.size());
+    unsigned maxStride = 0;
+    for (unsigned layerIdx = 0; layerIdx < topology.size(); layerIdx++)
+    {
+        QuantizedLayer &layer = mLayers[layerIdx];
+        layer.NumNeurons = topology[layerIdx];
+        layer.NumInputs = layerIdx == 0 ? 0 : topology[layerIdx - 1] + 1;
+        layer.Stride = (layer.NumInputs + 15) / 16 * 16;
+        layer.WeightScale = 0.0f;
+        maxStride = std::max(maxStride, layer.Stride);
+
+        mOutputs[layerIdx].assign(layer.NumNeurons + 1, 0.0f);
+        mOutputs[layerIdx].back() = (float)network.GetBiasOutput();
+
+        if (layerIdx == 0)
+            continue;
+
+        //Symmetric scale: the largest weight of the layer maps to 127
+        const T *weights = network.GetLayerWeights(layerIdx);
+        unsigned numWeights = layer.NumNeurons * layer.NumInputs;
+        double maxWeight = 0.0;
+        for (unsigned i = 0; i < numWeights; i++)
+            maxWeight = std::max(maxWeight, std::abs((double)weights[i]));
+
+        double scale = maxWeight > 0.0 ? maxWeight / 127.0 : 1.0;
+        layer.WeightScale = (float)scale;
+        layer.Weights.assign(layer.NumNeurons * layer.Stride, 0);
+        for (unsigned neuronIdx = 0; neuronIdx < layer.NumNeurons; neuronIdx++)
+        {
+            for (unsigned inputIdx = 0; inputIdx < layer.NumInputs; inputIdx++)
+            {
+                double value = std::floor(weights[neuronIdx * layer.NumInputs + inputIdx] / scale + 0.5);
+                layer.Weights[neuronIdx * layer.Stride + inputIdx] = (int8_t)std::max(-127.0, std::min(127.0, value));
+            }
+        }
+    }
+
+    mQuantizedInputs.assign(maxStride, 0);
+    mInputVals.assign(topology.front(), 0.0f);
+}
+
+void QuantizedNetwork::FeedForward(const float *inputVals)
+{
+    for (unsigned i = 0; i < mLayers[0].NumNeurons; i++)
+        mOutputs[0][i] = inputVals[i];
+
+    for (unsigned layerIdx = 1; layerIdx < mLayers.size(); layerIdx++)
+    {
+        const QuantizedLayer &layer = mLayers[layerIdx];
+        const float *inputs = mOutputs[layerIdx - 1].data();
+        float *outputs = mOutputs[layerIdx].data();
+
+        //Dynamic scale of the input vector, bias neuron included
+        float maxInput = 0.0f;
+        for (unsigned i = 0; i < layer.NumInputs; i++)
+            maxInput = std::max(maxInput, std::abs(inputs[i]));
+
+        float inputScale = maxInput > 0.0f ? maxInput / 127.0f : 1.0f;
+        float inverseScale = 1.0f / inputScale;
+        //The padding columns have zero weights, whatever is left there from a wider layer adds nothing
+        for (unsigned i = 0; i < layer.NumInputs; i++)
+            mQuantizedInputs[i] = (int8_t)std::floor(inputs[i] * inverseScale + 0.5f);
+
+        float outputScale = layer.WeightScale * inputScale;
+        for (unsigned neuronIdx = 0; neuronIdx < layer.NumNeurons; neuronIdx++)
+            outputs[neuronIdx] = Kernels::DotInt8(&layer.Weights[neuronIdx * layer.Stride], mQuantizedInputs.data(), layer.Stride) * outputScale;
+
+        Activation::Apply(mActivation, outputs, layer.NumNeurons);
+    }
+}
+
+void QuantizedNetwork::GetResults(float *resultVals) const
+{
+    const std::vector<float> &outputs = mOutputs.back();
+    for (unsigned i = 0; i < mLayers.back().NumNeurons; i++)
+        resultVals[i] = outputs[i];
+}
+
+size_t QuantizedNetwork::GetWeightsSize() const
+{
+    size_t size = 0;
+    for (unsigned layerIdx = 1; layerIdx < mLayers.size(); layerIdx++)
+        size += mLayers[layerIdx].Weights.size();
+
+    return size;
+}
+
+template <typename T>
+QuantizationError QuantizedNetwork::MeasureError(NetworkT<T> &network, const T *inputs, unsigned numSamples)
+{
+    QuantizationError error = { 0.0, 0.0, numSamples };
+    unsigned numInputs = GetNumInputs();
+    unsigned numOutputs = GetNumOutputs();
+
+    for (unsigned sampleIdx = 0; sampleIdx < numSamples; sampleIdx++)
+    {
+        const T *sample = &inputs[sampleIdx * numInputs];
+        for (unsigned i = 0; i < numInputs; i++)
+            mInputVals[i] = (float)sample[i];
+
+        FeedForward(mInputVals.data());
+        network.FeedForward(sample);
+
+        for (unsigned i = 0; i < numOutputs; i++)
+        {
+            double difference = std::abs((double)GetOutputs()[i] - (double)network.GetOutputs()[i]);
+            error.MaxError = std::max(error.MaxError, difference);
+            error.MeanError += difference;
+        }
+    }
+
+    if (numSamples > 0)
+        error.MeanError /= (double)numSamples * numOutputs;
+
+    return error;
+}
+
+template QuantizedNetwork::QuantizedNetwork(const NetworkT<double> &network);
+template QuantizedNetwork::QuantizedNetwork(const NetworkT<float> &network);
+
+template QuantizationError QuantizedNetwork::MeasureError(NetworkT<double> &network, const double *inputs, unsigned numSamples);
+template QuantizationError QuantizedNetwork::MeasureError(NetworkT<float> &network, const float *inputs, unsigned numSamples);
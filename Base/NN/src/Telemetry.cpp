@@ -0,0 +1,196 @@
+
+#include "Telemetry.h"
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+TelemetryRing::TelemetryRing(unsigned capacity) : mPushPosition(0), mDropped(0), mPopPosition(0)
+{
+    size_t size = 2;
+    while (size < capacity)
+        size *= 2;
+
+    mCells = std::vector<Cell>(size);
+    mMask = size - 1;
+    for (size_t i = 0; i < size; i++)
+        mCells[i].Sequence.store(i, std::memory_order_relaxed);
+}
+
+bool TelemetryRing::Push(const TelemetryRecord &record, bool wait)
+{
+    size_t position = mPushPosition.load(std::memory_order_relaxed);
+    while (true)
+    {
+        Cell &cell = mCells[position & mMask];
+        size_t sequence = cell.Sequence.load(std::memory_order_acquire);
+        intptr_t difference = (intptr_t)sequence - (intptr_t)position;
+
+        //The cell is free for this position, claim it
+        if (difference == 0)
+        {
+            if (mPushPosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+            {
+                cell.Record = record;
+                cell.Sequence.store(position + 1, std::memory_order_release);
+                return true;
+            }
+        }
+        //The writer has not read the cell a lap ago, the ring is full
+        else if (difference < 0 && wait)
+        {
+            std::this_thread::yield();
+            position = mPushPosition.load(std::memory_order_relaxed);
+        }
+        else if (difference < 0)
+        {
+            mDropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        //Another thread took the position
+        else
+            position = mPushPosition.load(std::memory_order_relaxed);
+    }
+}
+
+bool TelemetryRing::Pop(TelemetryRecord &record)
+{
+    Cell &cell = mCells[mPopPosition & mMask];
+    if (cell.Sequence.load(std::memory_order_acquire) != mPopPosition + 1)
+        return false;
+
+    record = cell.Record;
+    //Free again for the position one lap ahead
+    cell.Sequence.store(mPopPosition + mMask + 1, std::memory_order_release);
+    mPopPosition++;
+    return true;
+}
+
+Telemetry::Telemetry()
+{
+    mLog = nullptr;
+    mFormat = Csv;
+    mSampleRate = 1;
+    mSummaryInterval = 1;
+    mEpoch = 0;
+    mStop = false;
+    mPushed = 0;
+    mWritten = 0;
+}
+
+Telemetry::~Telemetry()
+{
+    Close();
+}
+
+bool Telemetry::Open(const std::string &filename, Format format, unsigned sampleRate, unsigned summaryInterval, unsigned capacity)
+{
+    Close();
+
+    mFormat = format;
+    mSampleRate = sampleRate > 0 ? sampleRate : 1;
+    mSummaryInterval = summaryInterval > 0 ? summaryInterval : 1;
+    mEpoch = 0;
+
+    if (!filename.empty())
+    {
+        mLog = std::fopen(filename.c_str(), format == Binary ? "wb" : "w");
+        if (!mLog)
+            return false;
+
+        if (format == Binary)
+        {
+            uint32_t header[4] = { 0, 1, sizeof(TelemetryRecord), 0 };
+            memcpy(header, "NNTL", 4);
+            std::fwrite(header, sizeof(header), 1, mLog);
+        }
+        else
+            std::fputs("step,epoch,error,average error\n", mLog);
+    }
+
+    mRing.reset(new TelemetryRing(capacity));
+    mStop = false;
+    mPushed = 0;
+    mWritten = 0;
+    mThread = std::thread(&Telemetry::WriteRecords, this);
+    return true;
+}
+
+void Telemetry::Close()
+{
+    if (mThread.joinable())
+    {
+        mStop = true;
+        mThread.join();
+    }
+
+    if (mLog)
+        std::fclose(mLog);
+
+    mLog = nullptr;
+    mRing.reset();
+}
+
+void Telemetry::Flush()
+{
+    while (mThread.joinable() && mWritten.load() != mPushed.load())
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    std::cout.flush();
+}
+
+void Telemetry::EndEpoch(uint64_t step, double error, double averageError)
+{
+    Push(step, error, averageError, TelemetryRecord::Epoch);
+    mEpoch++;
+}
+
+void Telemetry::Push(uint64_t step, double error, double averageError, TelemetryRecord::Type type)
+{
+    //Not open, or the log could not be created
+    if (!mRing)
+        return;
+
+    TelemetryRecord record = { step, error, averageError, mEpoch, (uint32_t)type };
+    if (mRing->Push(record, type != TelemetryRecord::Sampled))
+        mPushed++;
+}
+
+void Telemetry::WriteRecords()
+{
+    //Polls the ring, the training threads never have to wake the writer up
+    TelemetryRecord record;
+    while (true)
+    {
+        bool stop = mStop;
+        bool any = false;
+        while (mRing->Pop(record))
+        {
+            WriteRecord(record);
+            mWritten++;
+            any = true;
+        }
+
+        if (stop)
+            break;
+        if (!any)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    if (mRing->GetDropped() > 0)
+        std::cout << mRing->GetDropped() << " telemetry records dropped" << std::endl;
+}
+
+void Telemetry::WriteRecord(const TelemetryRecord &record)
+{
+    if (record.RecordType == TelemetryRecord::Sampled)
+    {
+        if (mFormat == Binary)
+            std::fwrite(&record, sizeof(record), 1, mLog);
+        else
+            std::fprintf(mLog, "%llu,%u,%.9g,%.9g\n", (unsigned long long)record.Step, record.EpochIdx, record.Error, record.AverageError);
+    }
+    else if (record.RecordType == TelemetryRecord::Summary)
+        std::cout << "Step " << record.Step << " network average error: " << record.AverageError << "\n";
+    else
+        std::cout << "Epoch " << record.EpochIdx + 1 << " (" << record.Step << " steps) network average error: " << record.AverageError << "\n";
+}
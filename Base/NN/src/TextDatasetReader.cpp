@@ -0,0 +1,357 @@
+
+#include "TextDatasetReader.h"
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+const char *ParseNumber(const char *begin, const char *end, double &value)
+{
+    //Every power of ten up to 10^22 is exact in a double
+    static const double powersOfTen[] =
+    {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    const char *p = begin;
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+'))
+    {
+        negative = *p == '-';
+        p++;
+    }
+
+    //Up to 19 significant digits fit in the mantissa, the rest only move the exponent
+    uint64_t mantissa = 0;
+    int significantDigits = 0;
+    int exponent = 0;
+    bool anyDigit = false;
+    for (; p < end && *p >= '0' && *p <= '9'; p++)
+    {
+        anyDigit = true;
+        if (significantDigits < 19)
+        {
+            mantissa = mantissa * 10 + (*p - '0');
+            if (mantissa > 0)
+                significantDigits++;
+        }
+        else
+            exponent++;
+    }
+
+    if (p < end && *p == '.')
+    {
+        for (p++; p < end && *p >= '0' && *p <= '9'; p++)
+        {
+            anyDigit = true;
+            if (significantDigits < 19)
+            {
+                mantissa = mantissa * 10 + (*p - '0');
+                if (mantissa > 0)
+                    significantDigits++;
+                exponent--;
+            }
+        }
+    }
+
+    if (!anyDigit)
+        return begin;
+
+    if (p < end && (*p == 'e' || *p == 'E'))
+    {
+        const char *q = p + 1;
+        bool negativeExponent = false;
+        if (q < end && (*q == '-' || *q == '+'))
+        {
+            negativeExponent = *q == '-';
+            q++;
+        }
+
+        //An 'e' without digits is not part of the number
+        if (q < end && *q >= '0' && *q <= '9')
+        {
+            int exponentValue = 0;
+            for (; q < end && *q >= '0' && *q <= '9'; q++)
+            {
+                if (exponentValue < 100000)
+                    exponentValue = exponentValue * 10 + (*q - '0');
+            }
+            exponent += negativeExponent ? -exponentValue : exponentValue;
+            p = q;
+        }
+    }
+
+    //Exact mantissa and exact power of ten: a single rounding, the correctly rounded result
+    if (significantDigits <= 15 && exponent >= -22 && exponent <= 22)
+    {
+        value = (double)mantissa;
+        value = exponent < 0 ? value / powersOfTen[-exponent] : value * powersOfTen[exponent];
+        if (negative)
+            value = -value;
+        return p;
+    }
+
+    char text[128];
+    size_t length = (size_t)(p - begin);
+    if (length >= sizeof(text))
+        return begin;
+
+    memcpy(text, begin, length);
+    text[length] = '\0';
+    value = strtod(text, nullptr);
+    return p;
+}
+
+template <typename T>
+TextDatasetReaderT<T>::TextDatasetReaderT()
+{
+    mFile = nullptr;
+    mBlockStart = 0;
+    mBlockEnd = 0;
+    mFileEnd = true;
+    mBatchSize = 1;
+    mCurrent = nullptr;
+    mStop = false;
+    mDone = true;
+}
+
+template <typename T>
+TextDatasetReaderT<T>::~TextDatasetReaderT()
+{
+    Close();
+}
+
+template <typename T>
+bool TextDatasetReaderT<T>::Open(const std::string &filename, unsigned batchSize, unsigned queueDepth)
+{
+    Close();
+
+    mFile = std::fopen(filename.c_str(), "rb");
+    if (!mFile)
+        return false;
+
+    mBlock.resize(1 << 20);
+    mBlockStart = 0;
+    mBlockEnd = 0;
+    mFileEnd = false;
+
+    //topology: n0 n1 ... nN
+    const char *begin, *end;
+    mTopology.clear();
+    if (ReadLine(begin, end) && end - begin >= 9 && strncmp(begin, "topology:", 9) == 0)
+    {
+        const char *p = begin + 9;
+        while (p < end)
+        {
+            while (p < end && (*p == ' ' || *p == '\t'))
+                p++;
+
+            double size;
+            const char *next = ParseNumber(p, end, size);
+            if (next == p)
+                break;
+
+            mTopology.push_back((unsigned)size);
+            p = next;
+        }
+    }
+
+    if (mTopology.size() < 2)
+    {
+        Close();
+        return false;
+    }
+
+    mBatchSize = batchSize > 0 ? batchSize : 1;
+    mBatches.resize(queueDepth + 1);
+    for (unsigned i = 0; i < mBatches.size(); i++)
+    {
+        mBatches[i].Inputs.resize(mBatchSize * mTopology.front());
+        mBatches[i].Targets.resize(mBatchSize * mTopology.back());
+        mBatches[i].NumSamples = 0;
+        mFree.push_back(&mBatches[i]);
+    }
+
+    mCurrent = nullptr;
+    mStop = false;
+    mDone = false;
+    mThread = std::thread(&TextDatasetReaderT<T>::ReadSamples, this);
+
+    return true;
+}
+
+template <typename T>
+void TextDatasetReaderT<T>::Close()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStop = true;
+    }
+    mCondition.notify_all();
+
+    if (mThread.joinable())
+        mThread.join();
+
+    if (mFile)
+        std::fclose(mFile);
+
+    mFile = nullptr;
+    mFilled.clear();
+    mFree.clear();
+    mCurrent = nullptr;
+    mDone = true;
+}
+
+template <typename T>
+const SampleBatch<T> *TextDatasetReaderT<T>::NextBatch()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+
+    //The previous batch has been used, give it back to the reader
+    if (mCurrent)
+    {
+        mFree.push_back(mCurrent);
+        mCurrent = nullptr;
+        mCondition.notify_all();
+    }
+
+    mCondition.wait(lock, [&]() { return !mFilled.empty() || mDone; });
+    if (mFilled.empty())
+        return nullptr;
+
+    mCurrent = mFilled.front();
+    mFilled.pop_front();
+    return mCurrent;
+}
+
+template <typename T>
+void TextDatasetReaderT<T>::ReadSamples()
+{
+    bool fileEnd = false;
+    while (!fileEnd)
+    {
+        SampleBatch<T> *batch;
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mCondition.wait(lock, [&]() { return mStop || !mFree.empty(); });
+            if (mStop)
+                break;
+
+            batch = mFree.front();
+            mFree.pop_front();
+        }
+
+        //Parsing runs without the lock, the training loop keeps going with the batches already queued
+        batch->NumSamples = 0;
+        while (batch->NumSamples < mBatchSize && ParseSample(*batch))
+            batch->NumSamples++;
+        fileEnd = batch->NumSamples < mBatchSize;
+
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            if (batch->NumSamples > 0)
+                mFilled.push_back(batch);
+            else
+                mFree.push_back(batch);
+        }
+        mCondition.notify_all();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mDone = true;
+    }
+    mCondition.notify_all();
+}
+
+template <typename T>
+bool TextDatasetReaderT<T>::ParseSample(SampleBatch<T> &batch)
+{
+    unsigned numInputs = mTopology.front();
+    unsigned numOutputs = mTopology.back();
+
+    //Same rule as TrainingData: the samples end at the first line with the wrong amount of values
+    if (ParseLine("In:", &batch.Inputs[batch.NumSamples * numInputs], numInputs) != numInputs)
+        return false;
+
+    return ParseLine("Out:", &batch.Targets[batch.NumSamples * numOutputs], numOutputs) == numOutputs;
+}
+
+template <typename T>
+unsigned TextDatasetReaderT<T>::ParseLine(const char *label, T *values, unsigned maxValues)
+{
+    const char *begin, *end;
+    if (!ReadLine(begin, end))
+        return 0;
+
+    const char *p = begin;
+    while (p < end && (*p == ' ' || *p == '\t'))
+        p++;
+
+    size_t labelLength = strlen(label);
+    if ((size_t)(end - p) < labelLength || strncmp(p, label, labelLength) != 0)
+        return 0;
+    p += labelLength;
+
+    unsigned count = 0;
+    while (true)
+    {
+        while (p < end && (*p == ' ' || *p == '\t'))
+            p++;
+
+        double value;
+        const char *next = ParseNumber(p, end, value);
+        if (next == p)
+            break;
+
+        //More values than neurons, the line does not belong to this topology
+        if (count == maxValues)
+            return maxValues + 1;
+
+        values[count++] = (T)value;
+        p = next;
+    }
+
+    return count;
+}
+
+template <typename T>
+bool TextDatasetReaderT<T>::ReadLine(const char *&begin, const char *&end)
+{
+    while (true)
+    {
+        const char *data = mBlock.data();
+        const char *newline = (const char *)memchr(data + mBlockStart, '\n', mBlockEnd - mBlockStart);
+        if (newline || (mFileEnd && mBlockStart < mBlockEnd))
+        {
+            begin = data + mBlockStart;
+            end = newline ? newline : data + mBlockEnd;
+            mBlockStart = newline ? (size_t)(newline - data) + 1 : mBlockEnd;
+
+            if (end > begin && end[-1] == '\r')
+                end--;
+            return true;
+        }
+
+        if (mFileEnd)
+            return false;
+
+        //Keep the partial line at the front and fill the rest of the block behind it
+        size_t remaining = mBlockEnd - mBlockStart;
+        memmove(mBlock.data(), mBlock.data() + mBlockStart, remaining);
+        mBlockStart = 0;
+        mBlockEnd = remaining;
+
+        //A single line longer than the block
+        if (mBlockEnd == mBlock.size())
+            mBlock.resize(mBlock.size() * 2);
+
+        size_t read = std::fread(mBlock.data() + mBlockEnd, 1, mBlock.size() - mBlockEnd, mFile);
+        mBlockEnd += read;
+        if (read == 0)
+            mFileEnd = true;
+    }
+}
+
+template class TextDatasetReaderT<double>;
+template class TextDatasetReaderT<float>;
@@ -0,0 +1,150 @@
+
+#include "ThreadPool.h"
+#include <algorithm>
+
+ThreadPool::ThreadPool(unsigned numThreads)
+{
+    mTask = nullptr;
+    mJob = 0;
+    mRemaining = 0;
+    mStop = false;
+
+    if (numThreads == 0)
+        numThreads = std::max(std::thread::hardware_concurrency(), 1u);
+
+    for (unsigned i = 0; i < numThreads; i++)
+    {
+        mRanges.push_back(std::unique_ptr<TaskRange>(new TaskRange()));
+        mRanges.back()->Next = 0;
+        mRanges.back()->End = 0;
+    }
+
+    //Range 0 belongs to the calling thread
+    for (unsigned i = 1; i < numThreads; i++)
+        mThreads.push_back(std::thread(&ThreadPool::WaitForJobs, this, i));
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStop = true;
+    }
+    mCondition.notify_all();
+
+    for (unsigned i = 0; i < mThreads.size(); i++)
+        mThreads[i].join();
+}
+
+void ThreadPool::Run(unsigned numTasks, const std::function<void(unsigned)> &task)
+{
+    //Nothing to share, no thread is woken up
+    if (numTasks <= 1 || mThreads.empty())
+    {
+        for (unsigned taskIdx = 0; taskIdx < numTasks; taskIdx++)
+            task(taskIdx);
+        return;
+    }
+
+    //The workers are idle, nobody reads the ranges
+    unsigned numThreads = GetNumThreads();
+    for (unsigned threadIdx = 0; threadIdx < numThreads; threadIdx++)
+    {
+        mRanges[threadIdx]->Next = (unsigned)((uint64_t)numTasks * threadIdx / numThreads);
+        mRanges[threadIdx]->End = (unsigned)((uint64_t)numTasks * (threadIdx + 1) / numThreads);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mTask = &task;
+        mRemaining = (unsigned)mThreads.size();
+        mJob++;
+    }
+    mCondition.notify_all();
+
+    RunTasks(0);
+
+    //A worker only leaves once there is nothing left to steal, so every task is done when the last one leaves
+    std::unique_lock<std::mutex> lock(mMutex);
+    mCondition.wait(lock, [&]() { return mRemaining == 0; });
+    mTask = nullptr;
+}
+
+void ThreadPool::WaitForJobs(unsigned threadIdx)
+{
+    uint64_t lastJob = 0;
+
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mCondition.wait(lock, [&]() { return mStop || mJob != lastJob; });
+            if (mStop)
+                return;
+
+            lastJob = mJob;
+        }
+
+        RunTasks(threadIdx);
+
+        bool last;
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            last = --mRemaining == 0;
+        }
+
+        if (last)
+            mCondition.notify_all();
+    }
+}
+
+void ThreadPool::RunTasks(unsigned threadIdx)
+{
+    //Set before the job was published, constant until every worker is back
+    const std::function<void(unsigned)> &task = *mTask;
+
+    unsigned taskIdx;
+    while (PopTask(threadIdx, taskIdx) || (StealTasks(threadIdx) && PopTask(threadIdx, taskIdx)))
+        task(taskIdx);
+}
+
+bool ThreadPool::PopTask(unsigned threadIdx, unsigned &taskIdx)
+{
+    TaskRange &range = *mRanges[threadIdx];
+    std::lock_guard<std::mutex> lock(range.Mutex);
+    if (range.Next >= range.End)
+        return false;
+
+    taskIdx = range.Next++;
+    return true;
+}
+
+bool ThreadPool::StealTasks(unsigned threadIdx)
+{
+    unsigned numThreads = GetNumThreads();
+
+    //Victims in order from the next thread on, so the thieves spread over different ranges
+    for (unsigned i = 1; i < numThreads; i++)
+    {
+        TaskRange &victim = *mRanges[(threadIdx + i) % numThreads];
+        unsigned first, end;
+        {
+            std::lock_guard<std::mutex> lock(victim.Mutex);
+            if (victim.Next >= victim.End)
+                continue;
+
+            //The upper half, the single task left if there is only one
+            first = victim.Next + (victim.End - victim.Next) / 2;
+            end = victim.End;
+            victim.End = first;
+        }
+
+        TaskRange &range = *mRanges[threadIdx];
+        std::lock_guard<std::mutex> lock(range.Mutex);
+        range.Next = first;
+        range.End = end;
+        return true;
+    }
+
+    return false;
+}
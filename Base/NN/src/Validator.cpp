@@ -0,0 +1,201 @@
+
+#include "Validator.h"
+#include "ModelFile.h"
+#include <algorithm>
+#include <cmath>
+
+template <typename T>
+ValidatorT<T>::ValidatorT(const NetworkT<T> &network, const T *inputs, const T *targets, unsigned numSamples, unsigned numThreads)
+    : mSnapshot(network), mBest(network)
+{
+    mInputs = inputs;
+    mTargets = targets;
+    mNumSamples = numSamples;
+    mBestError = 0.0;
+    mBestStep = 0;
+    mHasBest = false;
+    mJob = 0;
+    mRemaining = 0;
+    mStep = 0;
+    mBusy = false;
+    mStop = false;
+    mHasResult = false;
+
+    if (numThreads == 0)
+    {
+        unsigned hardwareThreads = std::thread::hardware_concurrency();
+        numThreads = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+    }
+
+    mWorkers.reserve(numThreads);
+    for (unsigned i = 0; i < numThreads; i++)
+        mWorkers.push_back(Worker(network));
+
+    for (unsigned i = 0; i < numThreads; i++)
+        mThreads.push_back(std::thread(&ValidatorT<T>::EvaluateShards, this, i));
+}
+
+template <typename T>
+ValidatorT<T>::~ValidatorT()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStop = true;
+    }
+    mCondition.notify_all();
+
+    for (unsigned i = 0; i < mThreads.size(); i++)
+        mThreads[i].join();
+}
+
+template <typename T>
+bool ValidatorT<T>::Evaluate(const NetworkT<T> &network, uint64_t step)
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (mBusy)
+            return false;
+    }
+
+    //The workers are idle, nobody reads the snapshot
+    CopyWeights(network, mSnapshot);
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mBusy = true;
+        mStep = step;
+        mRemaining = (unsigned)mWorkers.size();
+        mJob++;
+    }
+    mCondition.notify_all();
+    return true;
+}
+
+template <typename T>
+bool ValidatorT<T>::GetResult(ValidationResult &result)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (!mHasResult)
+        return false;
+
+    result = mResult;
+    mHasResult = false;
+    return true;
+}
+
+template <typename T>
+void ValidatorT<T>::Wait()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    mCondition.wait(lock, [&]() { return !mBusy; });
+}
+
+template <typename T>
+bool ValidatorT<T>::GetBestWeights(NetworkT<T> &network)
+{
+    Wait();
+    if (!mHasBest)
+        return false;
+
+    //Like SetLayerWeights, the momentum of the old weights does not apply to these
+    for (unsigned layerIdx = 1; layerIdx < mBest.mLayers.size(); layerIdx++)
+        network.SetLayerWeights(layerIdx, mBest.mLayers[layerIdx].Weights.data());
+    return true;
+}
+
+template <typename T>
+void ValidatorT<T>::EvaluateShards(unsigned workerIdx)
+{
+    Worker &worker = mWorkers[workerIdx];
+    uint64_t lastJob = 0;
+
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mCondition.wait(lock, [&]() { return mStop || mJob != lastJob; });
+            if (mStop)
+                return;
+
+            lastJob = mJob;
+        }
+
+        CopyWeights(mSnapshot, worker.Network);
+
+        unsigned numThreads = (unsigned)mWorkers.size();
+        unsigned firstSample = (unsigned)((uint64_t)mNumSamples * workerIdx / numThreads);
+        unsigned lastSample = (unsigned)((uint64_t)mNumSamples * (workerIdx + 1) / numThreads);
+        unsigned numInputs = worker.Network.GetNumInputs();
+        unsigned numOutputs = worker.Network.GetNumOutputs();
+
+        double errorSum = 0.0;
+        for (unsigned sampleIdx = firstSample; sampleIdx < lastSample; sampleIdx++)
+        {
+            worker.Network.FeedForward(&mInputs[(size_t)sampleIdx * numInputs]);
+
+            const T *outputs = worker.Network.GetOutputs();
+            const T *targets = &mTargets[(size_t)sampleIdx * numOutputs];
+            double sampleError = 0.0;
+            for (unsigned i = 0; i < numOutputs; i++)
+            {
+                double delta = (double)targets[i] - (double)outputs[i];
+                sampleError += delta * delta;
+            }
+            errorSum += std::sqrt(sampleError / numOutputs);
+        }
+        worker.ErrorSum = errorSum;
+
+        bool last;
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            last = --mRemaining == 0;
+        }
+
+        if (last)
+            FinishEvaluation();
+    }
+}
+
+template <typename T>
+void ValidatorT<T>::FinishEvaluation()
+{
+    //Always in worker order, the same sum whichever thread finished first
+    double errorSum = 0.0;
+    for (unsigned workerIdx = 0; workerIdx < mWorkers.size(); workerIdx++)
+        errorSum += mWorkers[workerIdx].ErrorSum;
+    double error = mNumSamples > 0 ? errorSum / mNumSamples : 0.0;
+
+    //Still busy: Evaluate can not replace the snapshot while it is copied and saved
+    bool improved = !mHasBest || error < mBestError;
+    if (improved)
+    {
+        CopyWeights(mSnapshot, mBest);
+        mBestError = error;
+        mBestStep = mStep;
+        mHasBest = true;
+
+        if (!mBestModelFile.empty())
+            ModelFile::Save(mBestModelFile, mBest);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mResult.Step = mStep;
+        mResult.Error = error;
+        mResult.Improved = improved;
+        mHasResult = true;
+        mBusy = false;
+    }
+    mCondition.notify_all();
+}
+
+template <typename T>
+void ValidatorT<T>::CopyWeights(const NetworkT<T> &source, NetworkT<T> &target)
+{
+    //Same sizes on both sides, no allocation
+    for (unsigned layerIdx = 1; layerIdx < source.mLayers.size(); layerIdx++)
+        target.mLayers[layerIdx].Weights = source.mLayers[layerIdx].Weights;
+}
+
+template class ValidatorT<double>;
+template class ValidatorT<float>;
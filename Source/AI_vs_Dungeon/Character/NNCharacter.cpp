@@ -192,30 +192,21 @@ void ANNCharacter::NeuralNetworkFeedForward()
 void ANNCharacter::NeuralNetworkBackPropagate()
 {
     //Save the inputs for later training (when character dies)
-    TArray<double> inputValues = NeuralNetworkComponent->GetInputValues();
-    mInputCache.Add(inputValues);
+    mInputCache.Add(NeuralNetworkComponent->GetInputValues());
 }
 
-TArray<bool> ANNCharacter::NeuralNetworkGetOutputValues()
+void ANNCharacter::NeuralNetworkGetOutputValues(TArray<bool> &result)
 {
-    TArray<double> outputValues;
-    NeuralNetworkComponent->GetResults(outputValues);
+    //Read the results in place, no copy of the output layer
+    const double *outputValues = NeuralNetworkComponent->GetResults();
+    const int32 numOutputs = NeuralNetworkComponent->GetNumOutputs();
 
-    NeuralNetworkComponent->PrintArray("Out: ", outputValues);
-
-    TArray<bool> result;
-    for (uint16 i = 0; i < outputValues.Num(); i++)
-    {
-        if (outputValues[i] > 0.5)
-            result.Add(true);
-        else
-            result.Add(false);
-    }
+    result.SetNumUninitialized(numOutputs, false);
+    for (int32 i = 0; i < numOutputs; i++)
+        result[i] = outputValues[i] > 0.5;
     
     if (mHasCameraFocus)
         UpdateGUI();
-
-    return result;
 }
 
 void ANNCharacter::UpdateGUI()
@@ -223,18 +214,13 @@ void ANNCharacter::UpdateGUI()
     UAI_vs_DungeonGameInstance *gameInstance = Cast<UAI_vs_DungeonGameInstance>(GetWorld()->GetGameInstance());
     if (gameInstance)
     {
-        TArray<double> outputValues;
-        NeuralNetworkComponent->GetOutputValues(outputValues);
+        NeuralNetworkComponent->GetOutputValues(mNeuronOutputValues);
 
-        TArray<bool> result;
-        for (uint16 i = 0; i < outputValues.Num(); i++)
-        {
-            if (outputValues[i] > 0.5)
-                result.Add(true);
-            else
-                result.Add(false);
-        }
-        gameInstance->SetNeuronOutputValues(result);
+        mNeuronActiveValues.SetNumUninitialized(mNeuronOutputValues.Num(), false);
+        for (int32 i = 0; i < mNeuronOutputValues.Num(); i++)
+            mNeuronActiveValues[i] = mNeuronOutputValues[i] > 0.5;
+
+        gameInstance->SetNeuronOutputValues(mNeuronActiveValues);
     }
 }
 
@@ -243,7 +229,7 @@ void ANNCharacter::NeuralNetworkGetConnectionWeights(TArray<double> &w)
     NeuralNetworkComponent->GetConnectionWeights(w);
 }
 
-void ANNCharacter::NeuralNetworkSetConnectionWeights(TArray<double> &w)
+void ANNCharacter::NeuralNetworkSetConnectionWeights(const TArray<double> &w)
 {
     NeuralNetworkComponent->SetConnectionWeights(w);
 }
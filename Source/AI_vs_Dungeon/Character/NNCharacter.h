@@ -51,6 +51,10 @@ private:
 
     TArray<TArray<double>> mInputCache;
 
+    //Scratch arrays reused by UpdateGUI on every decision
+    TArray<double> mNeuronOutputValues;
+    TArray<bool> mNeuronActiveValues;
+
     int32 mGenomeID;
     AGeneticAlgorithmController* mGAController;
 
@@ -90,10 +94,11 @@ public:
     void NeuralNetworkInitialize();
     void NeuralNetworkFeedForward();
     void NeuralNetworkBackPropagate();
-    TArray<bool> NeuralNetworkGetOutputValues();
+    //Writes the decisions (output > 0.5) into a caller owned array, reused between calls
+    void NeuralNetworkGetOutputValues(TArray<bool> &result);
     void NeuralNetworkSetInputValue(NNInputType type, bool collision);
     void NeuralNetworkGetConnectionWeights(TArray<double> &w);
-    void NeuralNetworkSetConnectionWeights(TArray<double> &w);
+    void NeuralNetworkSetConnectionWeights(const TArray<double> &w);
 
     void SetGeneticAlgorithmController(int32 id, AGeneticAlgorithmController* GAController, bool CameraFocus);
 };
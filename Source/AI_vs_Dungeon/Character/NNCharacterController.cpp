@@ -47,11 +47,11 @@ void ANNCharacterController::NeuralNetworkFeedForward()
 
 void ANNCharacterController::NeuralNetworkGetOutputValues()
 {
-    TArray<bool> outputValues = Character->NeuralNetworkGetOutputValues();
+    Character->NeuralNetworkGetOutputValues(mOutputValues);
 
-    BlackboardComponent->SetValueAsBool("ShouldJump", outputValues[0]);
-    BlackboardComponent->SetValueAsBool("ShouldMoveLeft", outputValues[1]);
-    BlackboardComponent->SetValueAsBool("ShouldMoveRight", outputValues[2]);
+    BlackboardComponent->SetValueAsBool("ShouldJump", mOutputValues[0]);
+    BlackboardComponent->SetValueAsBool("ShouldMoveLeft", mOutputValues[1]);
+    BlackboardComponent->SetValueAsBool("ShouldMoveRight", mOutputValues[2]);
 }
 
 void ANNCharacterController::NeuralNetworkBackPropagate()
@@ -49,4 +49,7 @@ public:
 private:
     ANNCharacter* Character;
 
+    //Decisions of the last feed forward, reused so a decision does not allocate
+    TArray<bool> mOutputValues;
+
 };
@@ -0,0 +1,373 @@
+
+#include "AI_vs_Dungeon.h"
+#include "NetworkKernels.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define KERNELS_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+//Gcc and clang only emit vector instructions for the functions tagged with the target,
+//msvc emits them anywhere so the tag is empty there (the dispatch keeps them from running on older cpus)
+#if defined(_MSC_VER)
+#define KERNELS_TARGET(x)
+#else
+#define KERNELS_TARGET(x) __attribute__((target(x)))
+#endif
+
+//AVX-512 intrinsics need at least Visual Studio 2017
+#if defined(KERNELS_X86) && (!defined(_MSC_VER) || _MSC_VER >= 1910)
+#define KERNELS_AVX512 1
+#endif
+
+namespace Kernels
+{
+    //Scalar fallback
+    double DotScalar(const double *a, const double *b, unsigned count)
+    {
+        double sum = 0.0;
+        for (unsigned i = 0; i < count; i++)
+            sum += a[i] * b[i];
+
+        return sum;
+    }
+
+    void AxpyScalar(double alpha, const double *x, double *y, unsigned count)
+    {
+        for (unsigned i = 0; i < count; i++)
+            y[i] += alpha * x[i];
+    }
+
+    void UpdateWeightsScalar(double scale, const double *inputs, double momentum, double *deltas, double *weights, unsigned count)
+    {
+        for (unsigned i = 0; i < count; i++)
+        {
+            double delta = scale * inputs[i] + momentum * deltas[i];
+            deltas[i] = delta;
+            weights[i] += delta;
+        }
+    }
+
+#if defined(KERNELS_X86)
+    //SSE2, 2 doubles per register
+    KERNELS_TARGET("sse2")
+    double DotSSE2(const double *a, const double *b, unsigned count)
+    {
+        __m128d sum0 = _mm_setzero_pd();
+        __m128d sum1 = _mm_setzero_pd();
+
+        unsigned i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            sum0 = _mm_add_pd(sum0, _mm_mul_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+            sum1 = _mm_add_pd(sum1, _mm_mul_pd(_mm_loadu_pd(a + i + 2), _mm_loadu_pd(b + i + 2)));
+        }
+        sum0 = _mm_add_pd(sum0, sum1);
+        sum0 = _mm_add_sd(sum0, _mm_unpackhi_pd(sum0, sum0));
+
+        double sum = _mm_cvtsd_f64(sum0);
+        for (; i < count; i++)
+            sum += a[i] * b[i];
+
+        return sum;
+    }
+
+    KERNELS_TARGET("sse2")
+    void AxpySSE2(double alpha, const double *x, double *y, unsigned count)
+    {
+        __m128d a = _mm_set1_pd(alpha);
+
+        unsigned i = 0;
+        for (; i + 2 <= count; i += 2)
+            _mm_storeu_pd(y + i, _mm_add_pd(_mm_loadu_pd(y + i), _mm_mul_pd(a, _mm_loadu_pd(x + i))));
+
+        for (; i < count; i++)
+            y[i] += alpha * x[i];
+    }
+
+    KERNELS_TARGET("sse2")
+    void UpdateWeightsSSE2(double scale, const double *inputs, double momentum, double *deltas, double *weights, unsigned count)
+    {
+        __m128d s = _mm_set1_pd(scale);
+        __m128d m = _mm_set1_pd(momentum);
+
+        unsigned i = 0;
+        for (; i + 2 <= count; i += 2)
+        {
+            __m128d delta = _mm_add_pd(_mm_mul_pd(s, _mm_loadu_pd(inputs + i)), _mm_mul_pd(m, _mm_loadu_pd(deltas + i)));
+            _mm_storeu_pd(deltas + i, delta);
+            _mm_storeu_pd(weights + i, _mm_add_pd(_mm_loadu_pd(weights + i), delta));
+        }
+
+        UpdateWeightsScalar(scale, inputs + i, momentum, deltas + i, weights + i, count - i);
+    }
+
+    //AVX2 + FMA, 4 doubles per register
+    KERNELS_TARGET("avx2,fma")
+    double DotAVX2(const double *a, const double *b, unsigned count)
+    {
+        __m256d sum0 = _mm256_setzero_pd();
+        __m256d sum1 = _mm256_setzero_pd();
+
+        unsigned i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            sum0 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i), sum0);
+            sum1 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i + 4), _mm256_loadu_pd(b + i + 4), sum1);
+        }
+        if (i + 4 <= count)
+        {
+            sum0 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i), sum0);
+            i += 4;
+        }
+        sum0 = _mm256_add_pd(sum0, sum1);
+
+        __m128d half = _mm_add_pd(_mm256_castpd256_pd128(sum0), _mm256_extractf128_pd(sum0, 1));
+        half = _mm_add_sd(half, _mm_unpackhi_pd(half, half));
+
+        double sum = _mm_cvtsd_f64(half);
+        for (; i < count; i++)
+            sum += a[i] * b[i];
+
+        return sum;
+    }
+
+    KERNELS_TARGET("avx2,fma")
+    void AxpyAVX2(double alpha, const double *x, double *y, unsigned count)
+    {
+        __m256d a = _mm256_set1_pd(alpha);
+
+        unsigned i = 0;
+        for (; i + 4 <= count; i += 4)
+            _mm256_storeu_pd(y + i, _mm256_fmadd_pd(a, _mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i)));
+
+        for (; i < count; i++)
+            y[i] += alpha * x[i];
+    }
+
+    KERNELS_TARGET("avx2,fma")
+    void UpdateWeightsAVX2(double scale, const double *inputs, double momentum, double *deltas, double *weights, unsigned count)
+    {
+        __m256d s = _mm256_set1_pd(scale);
+        __m256d m = _mm256_set1_pd(momentum);
+
+        unsigned i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            __m256d delta = _mm256_fmadd_pd(s, _mm256_loadu_pd(inputs + i), _mm256_mul_pd(m, _mm256_loadu_pd(deltas + i)));
+            _mm256_storeu_pd(deltas + i, delta);
+            _mm256_storeu_pd(weights + i, _mm256_add_pd(_mm256_loadu_pd(weights + i), delta));
+        }
+
+        UpdateWeightsScalar(scale, inputs + i, momentum, deltas + i, weights + i, count - i);
+    }
+#endif
+
+#if defined(KERNELS_AVX512)
+    //AVX-512, 8 doubles per register, the tails use masked loads instead of scalar loops
+    KERNELS_TARGET("avx512f")
+    double DotAVX512(const double *a, const double *b, unsigned count)
+    {
+        __m512d sum0 = _mm512_setzero_pd();
+        __m512d sum1 = _mm512_setzero_pd();
+
+        unsigned i = 0;
+        for (; i + 16 <= count; i += 16)
+        {
+            sum0 = _mm512_fmadd_pd(_mm512_loadu_pd(a + i), _mm512_loadu_pd(b + i), sum0);
+            sum1 = _mm512_fmadd_pd(_mm512_loadu_pd(a + i + 8), _mm512_loadu_pd(b + i + 8), sum1);
+        }
+        for (; i < count; i += 8)
+        {
+            __mmask8 mask = count - i >= 8 ? (__mmask8)0xFF : (__mmask8)((1u << (count - i)) - 1);
+            sum0 = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(mask, a + i), _mm512_maskz_loadu_pd(mask, b + i), sum0);
+        }
+
+        double lanes[8];
+        _mm512_storeu_pd(lanes, _mm512_add_pd(sum0, sum1));
+        return ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) + ((lanes[4] + lanes[5]) + (lanes[6] + lanes[7]));
+    }
+
+    KERNELS_TARGET("avx512f")
+    void AxpyAVX512(double alpha, const double *x, double *y, unsigned count)
+    {
+        __m512d a = _mm512_set1_pd(alpha);
+
+        for (unsigned i = 0; i < count; i += 8)
+        {
+            __mmask8 mask = count - i >= 8 ? (__mmask8)0xFF : (__mmask8)((1u << (count - i)) - 1);
+            __m512d result = _mm512_fmadd_pd(a, _mm512_maskz_loadu_pd(mask, x + i), _mm512_maskz_loadu_pd(mask, y + i));
+            _mm512_mask_storeu_pd(y + i, mask, result);
+        }
+    }
+
+    KERNELS_TARGET("avx512f")
+    void UpdateWeightsAVX512(double scale, const double *inputs, double momentum, double *deltas, double *weights, unsigned count)
+    {
+        __m512d s = _mm512_set1_pd(scale);
+        __m512d m = _mm512_set1_pd(momentum);
+
+        for (unsigned i = 0; i < count; i += 8)
+        {
+            __mmask8 mask = count - i >= 8 ? (__mmask8)0xFF : (__mmask8)((1u << (count - i)) - 1);
+            __m512d delta = _mm512_fmadd_pd(s, _mm512_maskz_loadu_pd(mask, inputs + i), _mm512_mul_pd(m, _mm512_maskz_loadu_pd(mask, deltas + i)));
+            _mm512_mask_storeu_pd(deltas + i, mask, delta);
+            _mm512_mask_storeu_pd(weights + i, mask, _mm512_add_pd(_mm512_maskz_loadu_pd(mask, weights + i), delta));
+        }
+    }
+#endif
+
+    struct KernelTable
+    {
+        InstructionSet Set;
+        double (*Dot)(const double *a, const double *b, unsigned count);
+        void (*Axpy)(double alpha, const double *x, double *y, unsigned count);
+        void (*UpdateWeights)(double scale, const double *inputs, double momentum, double *deltas, double *weights, unsigned count);
+    };
+
+    KernelTable CreateKernelTable(InstructionSet instructionSet)
+    {
+        KernelTable table = { Scalar, DotScalar, AxpyScalar, UpdateWeightsScalar };
+
+#if defined(KERNELS_X86)
+        if (instructionSet >= SSE2)
+        {
+            KernelTable sse2 = { SSE2, DotSSE2, AxpySSE2, UpdateWeightsSSE2 };
+            table = sse2;
+        }
+        if (instructionSet >= AVX2)
+        {
+            KernelTable avx2 = { AVX2, DotAVX2, AxpyAVX2, UpdateWeightsAVX2 };
+            table = avx2;
+        }
+#endif
+#if defined(KERNELS_AVX512)
+        if (instructionSet >= AVX512)
+        {
+            KernelTable avx512 = { AVX512, DotAVX512, AxpyAVX512, UpdateWeightsAVX512 };
+            table = avx512;
+        }
+#endif
+
+        return table;
+    }
+
+#if defined(KERNELS_X86)
+    void CpuId(int leaf, int subLeaf, unsigned regs[4])
+    {
+#if defined(_MSC_VER)
+        int info[4];
+        __cpuidex(info, leaf, subLeaf);
+        for (unsigned i = 0; i < 4; i++)
+            regs[i] = (unsigned)info[i];
+#else
+        __cpuid_count(leaf, subLeaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+    }
+
+    //Register state the operating system saves on context switches
+    unsigned long long GetEnabledStateMask()
+    {
+#if defined(_MSC_VER)
+        return _xgetbv(0);
+#else
+        unsigned eax, edx;
+        __asm__ __volatile__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+        return ((unsigned long long)edx << 32) | eax;
+#endif
+    }
+#endif
+
+    InstructionSet DetectInstructionSet()
+    {
+        InstructionSet instructionSet = Scalar;
+
+#if defined(KERNELS_X86)
+        unsigned regs[4];
+        CpuId(0, 0, regs);
+        unsigned maxLeaf = regs[0];
+
+        CpuId(1, 0, regs);
+        bool sse2 = (regs[3] & (1u << 26)) != 0;
+        bool fma = (regs[2] & (1u << 12)) != 0;
+        bool osxsave = (regs[2] & (1u << 27)) != 0;
+        if (!sse2)
+            return instructionSet;
+        instructionSet = SSE2;
+
+        if (!osxsave || maxLeaf < 7)
+            return instructionSet;
+
+        //XMM and YMM state for AVX, plus opmask and ZMM state for AVX-512
+        unsigned long long stateMask = GetEnabledStateMask();
+        bool ymmState = (stateMask & 0x6) == 0x6;
+        bool zmmState = (stateMask & 0xE6) == 0xE6;
+
+        CpuId(7, 0, regs);
+        bool avx2 = (regs[1] & (1u << 5)) != 0;
+        bool avx512f = (regs[1] & (1u << 16)) != 0;
+
+        if (avx2 && fma && ymmState)
+            instructionSet = AVX2;
+#if defined(KERNELS_AVX512)
+        if (instructionSet == AVX2 && avx512f && zmmState)
+            instructionSet = AVX512;
+#endif
+#endif
+
+        return instructionSet;
+    }
+
+    const InstructionSet gSupportedInstructionSet = DetectInstructionSet();
+    KernelTable gKernels = CreateKernelTable(gSupportedInstructionSet);
+
+    double Dot(const double *a, const double *b, unsigned count)
+    {
+        return gKernels.Dot(a, b, count);
+    }
+
+    void Axpy(double alpha, const double *x, double *y, unsigned count)
+    {
+        gKernels.Axpy(alpha, x, y, count);
+    }
+
+    void UpdateWeights(double scale, const double *inputs, double momentum, double *deltas, double *weights, unsigned count)
+    {
+        gKernels.UpdateWeights(scale, inputs, momentum, deltas, weights, count);
+    }
+
+    InstructionSet GetSupportedInstructionSet()
+    {
+        return gSupportedInstructionSet;
+    }
+
+    InstructionSet GetInstructionSet()
+    {
+        return gKernels.Set;
+    }
+
+    InstructionSet SetInstructionSet(InstructionSet instructionSet)
+    {
+        if (instructionSet > gSupportedInstructionSet)
+            instructionSet = gSupportedInstructionSet;
+
+        gKernels = CreateKernelTable(instructionSet);
+        return gKernels.Set;
+    }
+
+    const char *GetInstructionSetName(InstructionSet instructionSet)
+    {
+        switch (instructionSet)
+        {
+        case SSE2: return "SSE2";
+        case AVX2: return "AVX2";
+        case AVX512: return "AVX-512";
+        default: return "Scalar";
+        }
+    }
+}
@@ -0,0 +1,36 @@
+﻿//
+//  NetworkKernels.h
+//  AI vs Dungeon
+//
+
+#pragma once
+
+//Vector kernels used by the network inner loops.
+//The implementation is picked at startup from CPUID (AVX-512, AVX2, SSE2 or plain scalar code)
+namespace Kernels
+{
+    enum InstructionSet
+    {
+        Scalar = 0,
+        SSE2,
+        AVX2,
+        AVX512
+    };
+
+    //Sum(a[i] * b[i])
+    double Dot(const double *a, const double *b, unsigned count);
+
+    //y[i] += alpha * x[i]
+    void Axpy(double alpha, const double *x, double *y, unsigned count);
+
+    //Momentum weight update of one neuron:
+    //deltas[i] = scale * inputs[i] + momentum * deltas[i]; weights[i] += deltas[i]
+    void UpdateWeights(double scale, const double *inputs, double momentum, double *deltas, double *weights, unsigned count);
+
+    //Best instruction set supported by the cpu and the operating system
+    InstructionSet GetSupportedInstructionSet();
+    InstructionSet GetInstructionSet();
+    //Force the kernels to a given instruction set (clamped to the supported one), returns the one in use
+    InstructionSet SetInstructionSet(InstructionSet instructionSet);
+    const char *GetInstructionSetName(InstructionSet instructionSet);
+}
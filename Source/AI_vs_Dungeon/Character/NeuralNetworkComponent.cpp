@@ -2,6 +2,60 @@
 #include "AI_vs_Dungeon.h"
 #include "Runtime/Engine/Public/Engine.h"
 #include "NeuralNetworkComponent.h"
+#include "NetworkKernels.h"
+
+//Same file layout as Base/NN ModelFile.h: header, topology, then one row-major weight block per layer
+//starting on a 64 bytes boundary. Checksum is the CRC32 of everything after the header.
+namespace ModelFileFormat
+{
+    const char Magic[4] = { 'N', 'N', 'M', 'D' };
+    const uint32 Version = 1;
+    const uint32 Alignment = 64;
+    const uint32 Float64 = 0;
+    const uint32 Float32 = 1;
+    //Activation::Tanh
+    const uint32 Tanh = 0;
+    const int32 BiasOutput = 1;
+
+    struct Header
+    {
+        char Magic[4];
+        uint32 Version;
+        uint32 DataType;
+        uint32 Activation;
+        uint32 NumLayers;
+        int32 BiasOutput;
+        uint64 FileSize;
+        uint32 Checksum;
+        uint8 Reserved[28];
+    };
+    static_assert(sizeof(Header) == 64, "The model header is 64 bytes");
+
+    static uint32 Crc32(const uint8 *data, int64 size)
+    {
+        static uint32 table[256];
+        static bool tableReady = false;
+        if (!tableReady)
+        {
+            for (uint32 i = 0; i < 256; i++)
+            {
+                uint32 value = i;
+                for (int32 bit = 0; bit < 8; bit++)
+                    value = (value & 1) ? (value >> 1) ^ 0xedb88320u : value >> 1;
+                table[i] = value;
+            }
+            tableReady = true;
+        }
+
+        uint32 crc = ~0u;
+        for (int64 i = 0; i < size; i++)
+            crc = table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+
+        return ~crc;
+    }
+
+    static int64 Align(int64 offset) { return (offset + Alignment - 1) / Alignment * Alignment; }
+}
 
 // Sets default values for this component's properties
 UNeuralNetworkComponent::UNeuralNetworkComponent()
@@ -28,29 +82,31 @@ void UNeuralNetworkComponent::InitializeNetwork()
     if (mLayers.Num() <= 0)
     {
         //Create layers
-        uint16 numLayers = NetworkTopology.Num();
-        for (uint16 layerIdx = 0; layerIdx < numLayers; layerIdx++)
+        int32 numLayers = NetworkTopology.Num();
+        mLayers.SetNum(numLayers);
+        for (int32 layerIdx = 0; layerIdx < numLayers; layerIdx++)
         {
-            mLayers.Add(Layer());
-
-            //if the layer is the last one there are no outputs
-            //if not the number of outputs is the number of neurons of the next layer.
-            int32 numOutputs;
-            if (layerIdx == numLayers - 1)
-                numOutputs = 0;
-            else
-                numOutputs = NetworkTopology[layerIdx + 1];
-
-            //Fill the layer with neurons (<= we are addin an extra neuron with a constant value (Bias))
-            uint16 numNeurons = NetworkTopology[layerIdx];
-            for (uint16 neuronIdx = 0; neuronIdx <= numNeurons; neuronIdx++)
+            Layer &layer = mLayers[layerIdx];
+            layer.NumNeurons = NetworkTopology[layerIdx];
+            layer.NumInputs = layerIdx == 0 ? 0 : NetworkTopology[layerIdx - 1] + 1;
+
+            //One extra output for the bias neuron, forced to a constant value
+            layer.Outputs.Init(0.0, layer.NumNeurons + 1);
+            layer.Outputs.Last() = 1.0;
+            layer.Gradients.Init(0.0, layer.NumNeurons);
+            layer.Weights.Init(0.0, layer.NumNeurons * layer.NumInputs);
+            layer.DeltaWeights.Init(0.0, layer.NumNeurons * layer.NumInputs);
+        }
+
+        //Set a random weight for each connection (source neuron first, the order used by the genomes)
+        for (int32 layerIdx = 1; layerIdx < numLayers; layerIdx++)
+        {
+            Layer &layer = mLayers[layerIdx];
+            for (int32 inputIdx = 0; inputIdx < layer.NumInputs; inputIdx++)
             {
-                //Add the new neurons to the layer created before
-                mLayers.Last().Add(Neuron(numOutputs, neuronIdx));
+                for (int32 neuronIdx = 0; neuronIdx < layer.NumNeurons; neuronIdx++)
+                    layer.Weights[neuronIdx * layer.NumInputs + inputIdx] = RandomWeight();
             }
-
-            //Force the bias node's output value to 1.0
-            mLayers.Last().Last().SetOutputValue(1.0);
         }
 
         //Set default input values
@@ -67,20 +123,27 @@ void UNeuralNetworkComponent::TickComponent(float DeltaTime, ELevelTick TickType
 
 void UNeuralNetworkComponent::FeedForward(const TArray<double> &inputValues)
 {
-    check(inputValues.Num() == mLayers[0].Num() - 1);
+    check(inputValues.Num() == mLayers[0].NumNeurons);
 
     //Set the output values of the first layer(input layer) as the input values they receive
     //Because the input layer does not modify this values at all.
-    for (uint16 i = 0; i < inputValues.Num(); i++)
-        mLayers[0][i].SetOutputValue(inputValues[i]);
+    for (int32 i = 0; i < inputValues.Num(); i++)
+        mLayers[0].Outputs[i] = inputValues[i];
 
     //Forward propagate
-    //Go over each neuron of the network excluding the last neuron of each layer (the bias neuron)
-    for (uint16 layerIdx = 1; layerIdx < mLayers.Num(); layerIdx++)
+    //Each layer is a matrix-vector product of its weights and the previous layer's outputs (bias included)
+    for (int32 layerIdx = 1; layerIdx < mLayers.Num(); layerIdx++)
     {
-        Layer &prevLayer = mLayers[layerIdx - 1];
-        for (uint16 neuronIdx = 0; neuronIdx < mLayers[layerIdx].Num() - 1; neuronIdx++)
-            mLayers[layerIdx][neuronIdx].FeedForward(prevLayer);
+        const Layer &prevLayer = mLayers[layerIdx - 1];
+        Layer &layer = mLayers[layerIdx];
+
+        const double *inputs = prevLayer.Outputs.GetData();
+        for (int32 neuronIdx = 0; neuronIdx < layer.NumNeurons; neuronIdx++)
+        {
+            //F = Sum (neuron input value * neuron weight)
+            double sum = Kernels::Dot(inputs, &layer.Weights[neuronIdx * layer.NumInputs], layer.NumInputs);
+            layer.Outputs[neuronIdx] = TransferFunction(sum);
+        }
     }
 }
 
@@ -91,13 +154,13 @@ void UNeuralNetworkComponent::BackPropagate(const TArray<double> &targetValues)
     mError = 0.0;
 
     //RMS = sqrt((sum((target value - actual value)^2)) / quantity of values - 1)
-    for (uint16 neuronIdx = 0; neuronIdx < outputLayer.Num() - 1; neuronIdx++)
+    for (int32 neuronIdx = 0; neuronIdx < outputLayer.NumNeurons; neuronIdx++)
     {
-        double delta = targetValues[neuronIdx] - outputLayer[neuronIdx].GetOutputValue();
+        double delta = targetValues[neuronIdx] - outputLayer.Outputs[neuronIdx];
         mError += delta * delta;
     }
     //Get average error squared (not including bias)
-    mError /= outputLayer.Num() - 1;
+    mError /= outputLayer.NumNeurons;
     //Get RMS
     mError = sqrt(mError);
 
@@ -106,72 +169,83 @@ void UNeuralNetworkComponent::BackPropagate(const TArray<double> &targetValues)
         (mRecentAverageSmoothingFactor + 1.0);
 
     //Calculate output layer gradients
-    for (uint16 neuronIdx = 0; neuronIdx < outputLayer.Num() - 1; neuronIdx++)
-        outputLayer[neuronIdx].CalculateOutputGradients(targetValues[neuronIdx]);
+    for (int32 neuronIdx = 0; neuronIdx < outputLayer.NumNeurons; neuronIdx++)
+    {
+        double delta = targetValues[neuronIdx] - outputLayer.Outputs[neuronIdx];
+        outputLayer.Gradients[neuronIdx] = delta * TransferFunctionDerivative(outputLayer.Outputs[neuronIdx]);
+    }
 
     //Calculate hidden layers gradients (from back to front)
-    for (uint16 layerIdx = (uint16)mLayers.Num() - 2; layerIdx > 0; layerIdx--)
+    //Sum of the derivatives of the weights of the next layer: transposed product of its weights and gradients
+    for (int32 layerIdx = mLayers.Num() - 2; layerIdx > 0; layerIdx--)
     {
         Layer &hiddenLayer = mLayers[layerIdx];
-        Layer &nextLayer = mLayers[layerIdx + 1];
+        const Layer &nextLayer = mLayers[layerIdx + 1];
+
+        double *gradients = hiddenLayer.Gradients.GetData();
+        for (int32 neuronIdx = 0; neuronIdx < hiddenLayer.NumNeurons; neuronIdx++)
+            gradients[neuronIdx] = 0.0;
+
+        for (int32 nextIdx = 0; nextIdx < nextLayer.NumNeurons; nextIdx++)
+            Kernels::Axpy(nextLayer.Gradients[nextIdx], &nextLayer.Weights[nextIdx * nextLayer.NumInputs], gradients, hiddenLayer.NumNeurons);
 
-        for (uint16 neuronIdx = 0; neuronIdx < hiddenLayer.Num(); neuronIdx++)
-            hiddenLayer[neuronIdx].CalculateHiddenGradients(nextLayer);
+        for (int32 neuronIdx = 0; neuronIdx < hiddenLayer.NumNeurons; neuronIdx++)
+            gradients[neuronIdx] *= TransferFunctionDerivative(hiddenLayer.Outputs[neuronIdx]);
     }
 
     //Update connection weights for all layers except the input layer (from back to front)
-    for (uint16 layerIdx = (uint16)mLayers.Num() - 1; layerIdx > 0; layerIdx--)
+    for (int32 layerIdx = mLayers.Num() - 1; layerIdx > 0; layerIdx--)
     {
         Layer &layer = mLayers[layerIdx];
-        Layer &prevLayer = mLayers[layerIdx - 1];
+        const double *inputs = mLayers[layerIdx - 1].Outputs.GetData();
 
-        for (uint16 neuronIdx = 0; neuronIdx < layer.Num() - 1; neuronIdx++)
-            layer[neuronIdx].UpdateInputWeights(prevLayer);
+        //The output value of the previous neurons magnified by the gradient and the learning rate
+        //And the momentum will determine what percentage of the previous delta weight is maintained
+        for (int32 neuronIdx = 0; neuronIdx < layer.NumNeurons; neuronIdx++)
+        {
+            int32 rowIdx = neuronIdx * layer.NumInputs;
+            Kernels::UpdateWeights(mLearningRate * layer.Gradients[neuronIdx], inputs, mMomentum,
+                                   &layer.DeltaWeights[rowIdx], &layer.Weights[rowIdx], layer.NumInputs);
+        }
     }
 }
 
 void UNeuralNetworkComponent::GetResults(TArray<double> &resultValues) const
 {
-    resultValues.Empty();
+    resultValues.Reset();
 
-    //Get the output values of the last layer (output layer) and save them on the result vals vector
-    for (uint16 neuronIdx = 0; neuronIdx < mLayers.Last().Num() - 1; neuronIdx++)
-        resultValues.Add(mLayers.Last()[neuronIdx].GetOutputValue());
+    //Get the output values of the last layer (output layer) without the bias neuron
+    const Layer &outputLayer = mLayers.Last();
+    resultValues.Append(outputLayer.Outputs.GetData(), outputLayer.NumNeurons);
 }
 
 void UNeuralNetworkComponent::GetOutputValues(TArray<double>& w) const
 {
-    w.Empty();
+    w.Reset();
 
-    //From the fist layer to the last hidden layer (except output layer)
+    //Output values of every layer (except bias neurons)
     for (int32 layerIdx = 0; layerIdx < mLayers.Num(); layerIdx++)
-    {
-        const Layer &layer = mLayers[layerIdx];
-        //From the first neuron of the layer to the last (except bias one)
-        for (int32 neuronIdx = 0; neuronIdx < layer.Num() - 1; neuronIdx++)
-            w.Add(layer[neuronIdx].GetOutputValue());
-    }
+        w.Append(mLayers[layerIdx].Outputs.GetData(), mLayers[layerIdx].NumNeurons);
 }
 
 void UNeuralNetworkComponent::SetConnectionWeights(const TArray<double> &w)
 {
-    unsigned connectionIdx = 0;
-    //From the fist layer to the last hidden layer (except output layer)
-    for (int32 layerIdx = 0; layerIdx < mLayers.Num() - 1; layerIdx++)
+    int32 connectionIdx = 0;
+    //Connection order: layer, source neuron (bias included), target neuron
+    for (int32 layerIdx = 1; layerIdx < mLayers.Num(); layerIdx++)
     {
         Layer &layer = mLayers[layerIdx];
-        //From the first neuron of the layer to the last
-        for (int32 neuronIdx = 0; neuronIdx < layer.Num(); neuronIdx++)
+        for (int32 inputIdx = 0; inputIdx < layer.NumInputs; inputIdx++)
         {
-            TArray<Connection> newConnections;
-            int32 numConnections = (int32)layer[neuronIdx].GetOutputWeights().Num();
-            for (int32 weigthIdx = 0; weigthIdx < numConnections; weigthIdx++)
+            for (int32 neuronIdx = 0; neuronIdx < layer.NumNeurons; neuronIdx++)
             {
-                newConnections.Add(Connection(w[connectionIdx]));
+                layer.Weights[neuronIdx * layer.NumInputs + inputIdx] = w[connectionIdx];
                 connectionIdx++;
             }
-            layer[neuronIdx].SetOutputWeights(newConnections);
         }
+
+        //New connections start without momentum
+        layer.DeltaWeights.Init(0.0, layer.DeltaWeights.Num());
     }
 }
 
@@ -179,16 +253,14 @@ void UNeuralNetworkComponent::GetConnectionWeights(TArray<double> &w)
 {
     w.Empty();
 
-    //From the fist layer to the last hidden layer (except output layer)
-    for (int32 layerIdx = 0; layerIdx < mLayers.Num() - 1; layerIdx++)
+    //Connection order: layer, source neuron (bias included), target neuron
+    for (int32 layerIdx = 1; layerIdx < mLayers.Num(); layerIdx++)
     {
-        Layer &layer = mLayers[layerIdx];
-        //From the first neuron of the layer to the last
-        for (int32 neuronIdx = 0; neuronIdx < layer.Num(); neuronIdx++)
+        const Layer &layer = mLayers[layerIdx];
+        for (int32 inputIdx = 0; inputIdx < layer.NumInputs; inputIdx++)
         {
-            TArray<Connection> weights = layer[neuronIdx].GetOutputWeights();
-            for (int32 weigthIdx = 0; weigthIdx < weights.Num(); weigthIdx++)
-                w.Add(weights[weigthIdx].Weight);
+            for (int32 neuronIdx = 0; neuronIdx < layer.NumNeurons; neuronIdx++)
+                w.Add(layer.Weights[neuronIdx * layer.NumInputs + inputIdx]);
         }
     }
 }
@@ -197,122 +269,152 @@ void UNeuralNetworkComponent::GetConnectionWeightsNoBIAS(TArray<double> &w)
 {
     w.Empty();
 
-    //From the fist layer to the last hidden layer (except output layer)
-    for (int32 layerIdx = 0; layerIdx < mLayers.Num() - 1; layerIdx++)
+    //Same order as GetConnectionWeights but skipping the bias neuron of each layer (last input)
+    for (int32 layerIdx = 1; layerIdx < mLayers.Num(); layerIdx++)
     {
-        Layer &layer = mLayers[layerIdx];
-        //From the first neuron of the layer to the last (except BIAS)
-        for (int32 neuronIdx = 0; neuronIdx < layer.Num() - 1; neuronIdx++)
+        const Layer &layer = mLayers[layerIdx];
+        for (int32 inputIdx = 0; inputIdx < layer.NumInputs - 1; inputIdx++)
         {
-            TArray<Connection> weights = layer[neuronIdx].GetOutputWeights();
-            for (int32 weigthIdx = 0; weigthIdx < weights.Num(); weigthIdx++)
-                w.Add(weights[weigthIdx].Weight);
+            for (int32 neuronIdx = 0; neuronIdx < layer.NumNeurons; neuronIdx++)
+                w.Add(layer.Weights[neuronIdx * layer.NumInputs + inputIdx]);
         }
     }
 }
 
-void UNeuralNetworkComponent::SetInputValue(uint16 index, double value)
-{
-    if (index < mInputValues.Num())
-        mInputValues[index] = value;
-}
-
-TArray<double> UNeuralNetworkComponent::GetTargetValues(const TArray<double> &inputValues) const
+bool UNeuralNetworkComponent::SaveModel(const FString &filename) const
 {
-    TArray<double> targetValues;
-    //targetValues.Add(ShouldUp(inputValues));
-    //targetValues.Add(ShouldLeft(inputValues));
-    //targetValues.Add(ShouldRight(inputValues));
+    using namespace ModelFileFormat;
 
-    return targetValues;
-}
+    //Offsets of the weight blocks, then the whole file is built in memory
+    TArray<int64> offsets;
+    offsets.Init(0, mLayers.Num());
+    int64 offset = sizeof(Header) + mLayers.Num() * sizeof(uint32);
+    for (int32 layerIdx = 1; layerIdx < mLayers.Num(); layerIdx++)
+    {
+        offsets[layerIdx] = Align(offset);
+        offset = offsets[layerIdx] + mLayers[layerIdx].Weights.Num() * sizeof(double);
+    }
 
-void UNeuralNetworkComponent::PrintArray(FString text, TArray<double> a)
-{
-    FString arrayText;
-    for (uint16 i = 0; i < a.Num(); i++)
-        arrayText.Append(FString::Printf(TEXT(" %f,"), a[i]));
+    TArray<uint8> buffer;
+    buffer.Init(0, offset);
 
-    text.Append(arrayText);
-    //GEngine->AddOnScreenDebugMessage(-1, 4.f, FColor::Red, FString::Printf(TEXT("Average Error: %f"), GetRecentAverageError()));
-    UE_LOG(LogTemp, Warning, TEXT("%s"), *text);
+    uint32 *topology = (uint32 *)&buffer[sizeof(Header)];
+    for (int32 layerIdx = 0; layerIdx < mLayers.Num(); layerIdx++)
+        topology[layerIdx] = mLayers[layerIdx].NumNeurons;
+
+    for (int32 layerIdx = 1; layerIdx < mLayers.Num(); layerIdx++)
+        FMemory::Memcpy(&buffer[offsets[layerIdx]], mLayers[layerIdx].Weights.GetData(), mLayers[layerIdx].Weights.Num() * sizeof(double));
+
+    Header header;
+    FMemory::Memzero(&header, sizeof(header));
+    FMemory::Memcpy(header.Magic, Magic, sizeof(Magic));
+    header.Version = Version;
+    header.DataType = Float64;
+    header.Activation = Tanh;
+    header.NumLayers = mLayers.Num();
+    header.BiasOutput = BiasOutput;
+    header.FileSize = buffer.Num();
+    header.Checksum = Crc32(&buffer[sizeof(Header)], buffer.Num() - sizeof(Header));
+    FMemory::Memcpy(buffer.GetData(), &header, sizeof(header));
+
+    return FFileHelper::SaveArrayToFile(buffer, *filename);
 }
 
-Neuron::Neuron(const uint16 numOutputs, const uint16 idx)
+bool UNeuralNetworkComponent::LoadModel(const FString &filename)
 {
-    //Save the neuron index inside the layer for doing previous FeedForward.
-    mIdx = idx;
+    using namespace ModelFileFormat;
+
+    TArray<uint8> buffer;
+    if (!FFileHelper::LoadFileToArray(buffer, *filename) || buffer.Num() < (int32)sizeof(Header))
+        return false;
+
+    Header header;
+    FMemory::Memcpy(&header, buffer.GetData(), sizeof(header));
+    if (FMemory::Memcmp(header.Magic, Magic, sizeof(Magic)) != 0 || header.Version != Version ||
+        header.DataType > Float32 || header.Activation != Tanh || header.NumLayers != (uint32)mLayers.Num() ||
+        header.FileSize != (uint64)buffer.Num() ||
+        sizeof(Header) + (uint64)header.NumLayers * sizeof(uint32) > (uint64)buffer.Num() ||
+        Crc32(&buffer[sizeof(Header)], buffer.Num() - sizeof(Header)) != header.Checksum)
+    {
+        return false;
+    }
 
-    for (uint16 connection = 0; connection < numOutputs; connection++)
+    //Only the topology this component was built with
+    const uint32 *topology = (const uint32 *)&buffer[sizeof(Header)];
+    int64 offset = sizeof(Header) + mLayers.Num() * sizeof(uint32);
+    int64 valueSize = header.DataType == Float32 ? sizeof(float) : sizeof(double);
+    for (int32 layerIdx = 0; layerIdx < mLayers.Num(); layerIdx++)
     {
-        //Create a connection for each output neuron and set a random weight
-        mOutputWeights.Add(Connection(RandomWeight()));
+        if (topology[layerIdx] != (uint32)mLayers[layerIdx].NumNeurons)
+            return false;
+
+        if (layerIdx > 0)
+            offset = Align(offset) + mLayers[layerIdx].Weights.Num() * valueSize;
     }
-}
 
-void Neuron::FeedForward(const Layer &prevLayer)
-{
-    double sum = 0.0;
+    if (offset != buffer.Num())
+        return false;
 
-    //Sum the previous layer's outputs (which are our inputs)
-    //Include the bias neuron from the previous layer
-    for (uint16 neuronIdx = 0; neuronIdx < prevLayer.Num(); neuronIdx++)
+    //w * -1 == -w * +1: the bias column changes sign when the file was trained with the other bias output
+    bool negateBias = header.BiasOutput != BiasOutput;
+    offset = sizeof(Header) + mLayers.Num() * sizeof(uint32);
+    for (int32 layerIdx = 1; layerIdx < mLayers.Num(); layerIdx++)
     {
-        //F = Sum (neuron input value * neuron weight)
-        sum += prevLayer[neuronIdx].GetOutputValue() *
-            prevLayer[neuronIdx].mOutputWeights[mIdx].Weight;
+        Layer &layer = mLayers[layerIdx];
+        offset = Align(offset);
+        for (int32 i = 0; i < layer.Weights.Num(); i++)
+        {
+            const uint8 *value = &buffer[offset + i * valueSize];
+            layer.Weights[i] = header.DataType == Float32 ? *(const float *)value : *(const double *)value;
+        }
+        offset += layer.Weights.Num() * valueSize;
+
+        if (negateBias)
+        {
+            for (int32 i = layer.NumInputs - 1; i < layer.Weights.Num(); i += layer.NumInputs)
+                layer.Weights[i] = -layer.Weights[i];
+        }
+
+        //New connections start without momentum
+        layer.DeltaWeights.Init(0.0, layer.DeltaWeights.Num());
     }
 
-    mOutputVal = Neuron::TransferFunction(sum);
+    return true;
 }
 
-void Neuron::CalculateOutputGradients(const double targetValue)
+void UNeuralNetworkComponent::SetInputValue(uint16 index, double value)
 {
-    double delta = targetValue - mOutputVal;
-    mGradient = delta * Neuron::TransferFunctionDerivative(mOutputVal);
+    if (index < mInputValues.Num())
+        mInputValues[index] = value;
 }
 
-void Neuron::CalculateHiddenGradients(const Layer &nextLayer)
+TArray<double> UNeuralNetworkComponent::GetTargetValues(const TArray<double> &inputValues) const
 {
-    double dow = SumDOW(nextLayer);
-    mGradient = dow * Neuron::TransferFunctionDerivative(mOutputVal);
+    TArray<double> targetValues;
+    //targetValues.Add(ShouldUp(inputValues));
+    //targetValues.Add(ShouldLeft(inputValues));
+    //targetValues.Add(ShouldRight(inputValues));
+
+    return targetValues;
 }
 
-void Neuron::UpdateInputWeights(Layer &prevLayer)
+void UNeuralNetworkComponent::PrintArray(FString text, const TArray<double> &a)
 {
-    //Update the connection weights between this neuron and the previous layer
-    for (uint16 neuronIdx = 0; neuronIdx < prevLayer.Num(); neuronIdx++)
-    {
-        Neuron &neuron = prevLayer[neuronIdx];
-        double oldDeltaWeight = neuron.mOutputWeights[mIdx].DeltaWeight;
-
-        //The output value of the previous neurons magnified by the gradient and the learning rate
-        //And the momentum will determine what percentage of the previous delta weight is maintained
-        double newDeltaWeight = mLearningRate * neuron.GetOutputValue() * mGradient +
-            mMomentum * oldDeltaWeight;
+    FString arrayText;
+    for (uint16 i = 0; i < a.Num(); i++)
+        arrayText.Append(FString::Printf(TEXT(" %f,"), a[i]));
 
-        neuron.mOutputWeights[mIdx].DeltaWeight = newDeltaWeight;
-        neuron.mOutputWeights[mIdx].Weight += newDeltaWeight;
-    }
+    text.Append(arrayText);
+    //GEngine->AddOnScreenDebugMessage(-1, 4.f, FColor::Red, FString::Printf(TEXT("Average Error: %f"), GetRecentAverageError()));
+    UE_LOG(LogTemp, Warning, TEXT("%s"), *text);
 }
 
-double Neuron::TransferFunction(const double x)
+double UNeuralNetworkComponent::TransferFunction(const double x)
 {
     return tanh(x);
 }
 
-double Neuron::TransferFunctionDerivative(const double x)
+double UNeuralNetworkComponent::TransferFunctionDerivative(const double x)
 {
     return 1.0 - x * x;
-}
-
-double Neuron::SumDOW(const Layer &nextLayer) const
-{
-    double sum = 0.0;
-
-    //Sum our contribution of the errors at the nodes we feed
-    for (uint16 neuronIdx = 0; neuronIdx < nextLayer.Num() - 1; neuronIdx++)
-        sum += mOutputWeights[neuronIdx].Weight * nextLayer[neuronIdx].mGradient;
-
-    return sum;
 }
\ No newline at end of file
@@ -9,11 +9,9 @@
 #pragma once
 
 #include "Components/ActorComponent.h"
+#include "XoshiroRandom.h"
 #include "NeuralNetworkComponent.generated.h"
 
-class Neuron;
-typedef TArray<Neuron> Layer;
-
 UENUM(BlueprintType)
 enum NNInputType
 {
@@ -21,47 +19,23 @@ enum NNInputType
     ForwardCollision
 };
 
-struct Connection
+//Fully connected layer stored as contiguous blocks (no per neuron allocations)
+//Weights are row-major: row j holds the weights from every neuron of the previous layer
+//into neuron j, with the previous layer's bias neuron as the last column.
+struct Layer
 {
-    double Weight;
-    double DeltaWeight;
-
-    Connection(double w) { Weight = w; DeltaWeight = 0.0; }
-};
-
-class Neuron
-{
-public:
-    Neuron(const uint16 numOutputs, const uint16 idx);
-    ~Neuron() {}
-
-    void FeedForward(const Layer &prevLayer);
-
-    inline void SetOutputValue(const double value) { mOutputVal = value; }
-    inline double GetOutputValue() const { return mOutputVal; }
-    inline TArray<Connection> GetOutputWeights() { return mOutputWeights; }
-    inline void SetOutputWeights(TArray<Connection> weights) { mOutputWeights = weights; }
-
-    void CalculateOutputGradients(const double targetValue);
-    void CalculateHiddenGradients(const Layer &nextLayer);
-    void UpdateInputWeights(Layer &prevLayer);
-
-private:
-    static double TransferFunction(const double x);
-    static double TransferFunctionDerivative(const double x);
-    static double RandomWeight() { return rand() / double(RAND_MAX); }
-
-    double SumDOW(const Layer &nextLayer) const;
-
-    uint16 mIdx;
-    double mGradient;
-    double mOutputVal;
-    TArray<Connection> mOutputWeights;
-
-    //Overall network learning rate [0.0...1.0]
-    double mLearningRate = 0.15;
-    //Multiplier of last weight change [0.0...n]
-    double mMomentum = 0.5;
+    int32 NumNeurons = 0;
+    //Neurons of the previous layer including its bias neuron (row length)
+    int32 NumInputs = 0;
+
+    //[NumNeurons x NumInputs]
+    TArray<double> Weights;
+    TArray<double> DeltaWeights;
+
+    //[NumNeurons + 1] the last value is the output of the bias neuron
+    TArray<double> Outputs;
+    //[NumNeurons]
+    TArray<double> Gradients;
 };
 
 UCLASS( ClassGroup=(Custom), meta=(BlueprintSpawnableComponent) )
@@ -84,29 +58,45 @@ public:
     void FeedForward() { FeedForward(mInputValues); };
     void FeedForward(const TArray<double> &inputValues);
     void BackPropagate(const TArray<double> &targetValues);
+    //Both keep the array allocation, a caller reusing the same array does not allocate once warm
     void GetResults(TArray<double> &resultValues) const;
     void GetOutputValues(TArray<double> &w) const;
 
+    //View of the output layer values, valid until the next FeedForward
+    inline const double *GetResults() const { return mLayers.Last().Outputs.GetData(); }
+    inline int32 GetNumOutputs() const { return mLayers.Last().NumNeurons; }
+
     inline double GetRecentAverageError() const { return mRecentAverageError; }
 
     void SetConnectionWeights(const TArray<double> &w);
     void GetConnectionWeights(TArray<double> &w);
     void GetConnectionWeightsNoBIAS(TArray<double> &w);
 
+    //Model files in the format of Base/NN ModelFile.h (double weights, tanh, bias neurons at +1).
+    //Loading needs the same topology, models saved by the standalone Network (bias at -1) are converted
+    bool SaveModel(const FString &filename) const;
+    bool LoadModel(const FString &filename);
+
     //down, back, up, forward
     void SetInputValue(uint16 index, double value);
-    inline TArray<double> GetInputValues() { return mInputValues; };
+    inline const TArray<double> &GetInputValues() const { return mInputValues; };
 
     TArray<double> GetTargetValues(const TArray<double> &inputValues) const;
 
-    void PrintArray(FString text, TArray<double> a);
+    void PrintArray(FString text, const TArray<double> &a);
     void PrintInputValues() { PrintArray("In: ", mInputValues); }
 
 private:
+    static double TransferFunction(const double x);
+    static double TransferFunctionDerivative(const double x);
+    //From the run generator, seeded by the genetic algorithm (see FXoshiroRandom::SetRunSeed)
+    static double RandomWeight() { return FXoshiroRandom::GetRunRandom().NextDouble(); }
+
     //The actual topology of the neural network ([0] num inputs in layer, [1..n] num hidden neurons in layer, [n+1] num outputs in layer)
     UPROPERTY(EditDefaultsOnly, Category = "Network Configuration")
     TArray<uint16> NetworkTopology;
 
+    //mLayers[layer index], mLayers[0] is the input layer and has no weights
     TArray<Layer> mLayers;
 
     //down, back, up, forward
@@ -115,4 +105,9 @@ private:
     double mError;
     double mRecentAverageError;
     double mRecentAverageSmoothingFactor;
+
+    //Overall network learning rate [0.0...1.0]
+    double mLearningRate = 0.15;
+    //Multiplier of last weight change [0.0...n]
+    double mMomentum = 0.5;
 };
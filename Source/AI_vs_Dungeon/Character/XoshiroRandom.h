@@ -0,0 +1,92 @@
+﻿//
+//  XoshiroRandom.h
+//  AI vs Dungeon
+//
+
+#pragma once
+
+//xoshiro256** pseudo random generator, the same numbers as Base/NN Random.h for the same seed.
+//Its whole state is 4 values, the genetic algorithm checkpoints store it as it is.
+//GetRunRandom is the generator of the code without one of its own (the initial network weights),
+//only for the game thread.
+struct FXoshiroRandom
+{
+    explicit FXoshiroRandom(uint64 seed = 0) { Seed(seed); }
+
+    //The state is expanded from the seed with splitmix64, any seed (0 included) is valid
+    inline void Seed(uint64 seed)
+    {
+        for (int32 i = 0; i < 4; i++)
+        {
+            seed += 0x9e3779b97f4a7c15ull;
+            uint64 z = seed;
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+            State[i] = z ^ (z >> 31);
+        }
+    }
+
+    inline uint64 Next()
+    {
+        uint64 result = RotateLeft(State[1] * 5, 7) * 9;
+        uint64 t = State[1] << 17;
+
+        State[2] ^= State[0];
+        State[3] ^= State[1];
+        State[1] ^= State[2];
+        State[0] ^= State[3];
+        State[2] ^= t;
+        State[3] = RotateLeft(State[3], 45);
+
+        return result;
+    }
+
+    //[0.0...1.0)
+    inline double NextDouble() { return (Next() >> 11) * (1.0 / 9007199254740992.0); }
+    //[0...count)
+    inline uint32 NextUnsigned(uint32 count) { return (uint32)(((Next() >> 32) * count) >> 32); }
+
+    //values[count] uniform in [min...max), the same numbers as count calls to NextDouble
+    template <typename T>
+    inline void FillUniform(T *values, int32 count, T min, T max)
+    {
+        double scale = (double)max - (double)min;
+        for (int32 i = 0; i < count; i++)
+            values[i] = (T)(min + NextDouble() * scale);
+    }
+
+    //Same as calling Next() 2^128 times: the numbers after a Jump never overlap with the ones before
+    inline void Jump()
+    {
+        static const uint64 jump[4] = { 0x180ec6d33cfd0abaull, 0xd5a61266f0c9392cull, 0xa9582618e03fc9aaull, 0x39abdc4529b1661cull };
+
+        uint64 state[4] = { 0, 0, 0, 0 };
+        for (int32 i = 0; i < 4; i++)
+        {
+            for (int32 bit = 0; bit < 64; bit++)
+            {
+                if (jump[i] & (1ull << bit))
+                {
+                    for (int32 j = 0; j < 4; j++)
+                        state[j] ^= State[j];
+                }
+                Next();
+            }
+        }
+
+        FMemory::Memcpy(State, state, sizeof(State));
+    }
+
+    //Restarts the run generator from a seed
+    static void SetRunSeed(uint64 seed) { GetRunRandom().Seed(seed); }
+    static FXoshiroRandom &GetRunRandom()
+    {
+        static FXoshiroRandom random;
+        return random;
+    }
+
+    uint64 State[4];
+
+private:
+    static inline uint64 RotateLeft(uint64 x, int32 k) { return (x << k) | (x >> (64 - k)); }
+};
@@ -3,60 +3,126 @@
 #include "AI_vs_Dungeon.h"
 #include "Game/AI_vs_DungeonGameInstance.h"
 #include "GeneticAlgorithmComponent.h"
+#include "Async/Async.h"
+#include <algorithm>
 
-float RandFloat()
+//Same file layout as Base/GANN Checkpoint.h (version 3): header, the chromosomes of every genome
+//and then their fitness. Checksum is the CRC32 of everything after the header.
+//RandomState is the whole xoshiro256** state, the files of older versions are rejected
+namespace CheckpointFormat
 {
-    return rand() / float(RAND_MAX);
-}
+    const char Magic[4] = { 'G', 'A', 'C', 'P' };
+    const uint32 Version = 3;
+    //BinaryDatasetFormat::Float64 and Selector::Roulette, the only genes and selection of this component
+    const uint32 Float64 = 0;
+    const uint32 Roulette = 0;
+    //Base/GANN's default, unused by the roulette wheel
+    const uint32 TournamentSize = 2;
+
+    struct Header
+    {
+        char Magic[4];
+        uint32 Version;
+        uint32 DataType;
+        uint32 Generation;
+        uint32 NumGenomes;
+        uint32 ChromosomeLength;
+        uint32 Population;
+        uint32 ElitismSelection;
+        uint32 FittestGenome;
+        uint32 SelectionMethod;
+        uint32 TournamentSize;
+        uint32 Checksum;
+        double CrossoverRate;
+        double MutationRate;
+        double MaxPerturbation;
+        double BestFitnessScore;
+        double TotalFitnessScore;
+        //State of the random generator of the genetic operators
+        uint64 RandomState[4];
+        uint64 FileSize;
+    };
+    static_assert(sizeof(Header) == 128, "The checkpoint header is 128 bytes");
+
+    struct Crc32Table
+    {
+        uint32 Values[256];
 
-float RandFloatClamped()
-{
-    return (rand() / float(RAND_MAX)) * 2.0f - 1.0f;
-}
+        Crc32Table()
+        {
+            for (uint32 i = 0; i < 256; i++)
+            {
+                uint32 value = i;
+                for (int32 bit = 0; bit < 8; bit++)
+                    value = (value & 1) ? (value >> 1) ^ 0xedb88320u : value >> 1;
+                Values[i] = value;
+            }
+        }
+    };
 
-int RandInt(int min, int max)
-{
-    return (rand() % (max - min)) + min;
+    //Runs in the thread pool, the table is built once by whichever thread comes first
+    static uint32 Crc32(const uint8 *data, int64 size)
+    {
+        static const Crc32Table table;
+
+        uint32 crc = ~0u;
+        for (int64 i = 0; i < size; i++)
+            crc = table.Values[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+
+        return ~crc;
+    }
 }
 
 UGeneticAlgorithmComponent::UGeneticAlgorithmComponent() {}
 
 void UGeneticAlgorithmComponent::Epoch()
 {
-    int32 newChilds = 0;
-    TArray<SGenome> childGenomes;
+    //The elite and pairs of children up to the population size (one extra child when the pairs do not fit)
+    int32 elitismQuantity = (int32)(mPopulation * mElitismSelection);
+    int32 numGenomes = elitismQuantity + (mPopulation > elitismQuantity ? (mPopulation - elitismQuantity + 1) / 2 * 2 : 0);
+    mNextGenomes.SetNum(numGenomes, false);
+
+    //The fitness is set from outside by UpdateGenomeFitness, add it up once for every parent of this generation
+    mCumulativeFitness.SetNum(mGenomes.Num(), false);
+    double totalFitness = 0.0;
+    for (int32 i = 0; i < mGenomes.Num(); i++)
+    {
+        totalFitness += mGenomes[i].Fitness;
+        mCumulativeFitness[i] = totalFitness;
+    }
+    mTotalFitnessScore = totalFitness;
 
     //Elitism selection (select the best genomes for the next generation)
-    int32 elitismQuantity = (int32)(mPopulation * mElitismSelection);
-    ElitismSelection(elitismQuantity, childGenomes);
+    ElitismSelection(elitismQuantity, mNextGenomes);
 
-    while (childGenomes.Num() < mPopulation)
+    for (int32 child = elitismQuantity; child < numGenomes; child += 2)
     {
-        //Select two parents
-        SGenome mom = RouleteWheelSelection();
-        SGenome dad = RouleteWheelSelection();
+        //Select two parents, read in place from the current generation
+        const SGenome &mom = RouleteWheelSelection();
+        const SGenome &dad = RouleteWheelSelection();
 
-        //Crossover the parents chromosome data
-        SGenome child1, child2;
+        //Crossover the parents chromosome data into the genomes of the next generation
+        SGenome &child1 = mNextGenomes[child];
+        SGenome &child2 = mNextGenomes[child + 1];
         Crossover(mom.Bits, dad.Bits, child1.Bits, child2.Bits);
 
         //Operate a mutation chance
         Mutate(child1.Bits);
         Mutate(child2.Bits);
 
-        //Add the new childs to the new population
-        childGenomes.Add(child1);
-        childGenomes.Add(child2);
-
-        newChilds += 2;
+        child1.Fitness = 0.0;
+        child2.Fitness = 0.0;
     }
-    //Change the old population with the new one
-    mGenomes = childGenomes;
+    //Change the old population with the new one, the old genomes hold the next generation
+    Swap(mGenomes, mNextGenomes);
 
     //Increment the generation counter
     mGeneration++;
     UE_LOG(LogTemp, Warning, TEXT("New Generation: %d"), mGeneration);
 
+    if (mCheckpointInterval > 0 && mGeneration % mCheckpointInterval == 0)
+        SaveCheckpoint(FPaths::GameSavedDir() / mCheckpointFile);
+
     UAI_vs_DungeonGameInstance *gameInstance = Cast<UAI_vs_DungeonGameInstance>(GetWorld()->GetGameInstance());
     if (gameInstance)
         gameInstance->SetGenerations(mGeneration);
@@ -64,29 +130,24 @@ void UGeneticAlgorithmComponent::Epoch()
 
 void UGeneticAlgorithmComponent::SetBestGenomes(int32 genomeIdx)
 {
-    int32 newChilds = 0;
-    TArray<SGenome> childGenomes;
-    
-    SGenome bestGenome = mGenomes[genomeIdx];
-    while (childGenomes.Num() < mPopulation)
-    {
-        childGenomes.Add(bestGenome);
-        newChilds++;
-    }
+    mNextGenomes.SetNum(mPopulation, false);
+    for (int32 i = 0; i < mPopulation; i++)
+        mNextGenomes[i] = mGenomes[genomeIdx];
 
     //Change the old population with the new one
-    mGenomes = childGenomes;
+    Swap(mGenomes, mNextGenomes);
 }
 
 void UGeneticAlgorithmComponent::Mutate(TArray<double> &chromosome)
 {
-    //Traverse the weight vector and mutate each weight dependent on the mutation rate
+    //The mutation chance of every weight drawn at once, then only the mutated ones draw their perturbation
+    mMutationDraws.SetNum(chromosome.Num(), false);
+    mRandom.FillUniform(mMutationDraws.GetData(), chromosome.Num(), 0.0f, 1.0f);
     for (int32 i = 0; i < chromosome.Num(); i++)
     {
         //do we perturb this chromosome?
-        if (RandFloat() < mMutationRate)
+        if (mMutationDraws[i] < mMutationRate)
         {
-            float a = RandFloatClamped();
             //add or subtract a small value to the weight
             chromosome[i] += (RandFloatClamped() * mMaxPerturbation);
         }
@@ -95,8 +156,9 @@ void UGeneticAlgorithmComponent::Mutate(TArray<double> &chromosome)
 
 void UGeneticAlgorithmComponent::Crossover(const TArray<double> &mom, const TArray<double> &dad, TArray<double> &child1, TArray<double> &child2)
 {
-    child1.Empty();
-    child2.Empty();
+    //Reset keeps the memory of the chromosomes
+    child1.Reset();
+    child2.Reset();
 
     if ((RandFloat() > mCrossoverRate) || (mom == dad) || mCrossoverRate <= 0.0f)
     {
@@ -124,50 +186,64 @@ void UGeneticAlgorithmComponent::Crossover(const TArray<double> &mom, const TArr
 SGenome& UGeneticAlgorithmComponent::RouleteWheelSelection()
 {
     double slice = RandFloat() * mTotalFitnessScore;
-    double total = 0;
-    int32 selectedGenome = 0;
 
-    for (int32 i = 0; i < mPopulation; i++)
+    //First genome whose running sum is past the slice (the first one when none is)
+    int32 low = 0;
+    int32 high = mCumulativeFitness.Num();
+    while (low < high)
     {
-        total += mGenomes[i].Fitness;
-
-        if (total > slice)
-        {
-            selectedGenome = i;
-            break;
-        }
+        int32 middle = low + (high - low) / 2;
+        if (mCumulativeFitness[middle] > slice)
+            high = middle;
+        else
+            low = middle + 1;
     }
 
+    int32 selectedGenome = low < mCumulativeFitness.Num() ? low : 0;
     return mGenomes[selectedGenome];
 }
 
 void UGeneticAlgorithmComponent::ElitismSelection(int32 amount, TArray <SGenome> &genomes)
 {
-    int32 selectedGenome = 0;
+    int32 numGenomes = mGenomes.Num();
+    if (amount <= 0 || numGenomes == 0)
+        return;
+
+    //Fittest first, the lower index wins the ties
+    auto fitter = [this](int32 a, int32 b) { return mGenomes[a].Fitness > mGenomes[b].Fitness || (mGenomes[a].Fitness == mGenomes[b].Fitness && a < b); };
 
-    for (int32 j = 0; j < amount; j++)
+    mEliteOrder.SetNum(numGenomes, false);
+    int32 *order = mEliteOrder.GetData();
+    for (int32 i = 0; i < numGenomes; i++)
+        order[i] = i;
+
+    //Only a window of the fittest genomes is sorted, it grows when genomes with the same fitness as one
+    //already selected (clones of it) leave the elite short
+    int32 count = 0;
+    int32 sorted = 0;
+    while (count < amount && sorted < numGenomes)
     {
-        double bestFit = 0.0;
-        bool valid = true;
-        for (int32 i = 0; i < mGenomes.Num(); i++)
+        int32 window = FMath::Min(numGenomes, FMath::Max(amount, sorted * 2));
+        if (window < numGenomes)
+            std::nth_element(order + sorted, order + window, order + numGenomes, fitter);
+        std::sort(order + sorted, order + window, fitter);
+
+        for (int32 i = sorted; i < window && count < amount; i++)
         {
-            if (mGenomes[i].Fitness > bestFit)
-            {
-                for (int32 k = 0; k < genomes.Num(); k++)
-                {
-                    if (genomes[k].Fitness == mGenomes[i].Fitness)
-                        valid = false; break;
-                }
-
-                if (valid)
-                {
-                    bestFit = mGenomes[i].Fitness;
-                    selectedGenome = i;
-                }
-            }
+            if (i == 0 || mGenomes[order[i]].Fitness != mGenomes[order[i - 1]].Fitness)
+                genomes[count++] = mGenomes[order[i]];
         }
-        genomes.Add(mGenomes[selectedGenome]);
+        sorted = window;
     }
+
+    //Not enough different fitness values: the fittest clones, then the elite again
+    for (int32 i = 1; i < numGenomes && count < amount; i++)
+    {
+        if (mGenomes[order[i]].Fitness == mGenomes[order[i - 1]].Fitness)
+            genomes[count++] = mGenomes[order[i]];
+    }
+    for (int32 i = count; i < amount; i++)
+        genomes[i] = genomes[i - count];
 }
 
 /*
@@ -203,6 +279,12 @@ void UGeneticAlgorithmComponent::UpdateWeights(SGenome &genome)
 
 void UGeneticAlgorithmComponent::Initialize()
 {
+    //The networks of the characters draw from the run generator, the genetic operators from a stream after it
+    uint64 seed = mSeed != 0 ? (uint64)mSeed : FPlatformTime::Cycles64();
+    FXoshiroRandom::SetRunSeed(seed);
+    mRandom.Seed(seed);
+    mRandom.Jump();
+
     UAI_vs_DungeonGameInstance *gameInstance = Cast<UAI_vs_DungeonGameInstance>(GetWorld()->GetGameInstance());
     if (gameInstance && gameInstance->GetInitialConfigValues())
     {
@@ -212,6 +294,113 @@ void UGeneticAlgorithmComponent::Initialize()
         mMaxPerturbation = (float)gameInstance->GetMaxPerturbation() * 0.01f;
         mElitismSelection = (float)gameInstance->GetElitismRate() * 0.01f;
     }
+
+    if (mResumeFromCheckpoint && LoadCheckpoint(FPaths::GameSavedDir() / mCheckpointFile))
+    {
+        UE_LOG(LogTemp, Warning, TEXT("Resumed from generation: %d"), mGeneration);
+        if (gameInstance)
+            gameInstance->SetGenerations(mGeneration);
+    }
+}
+
+void UGeneticAlgorithmComponent::SaveCheckpoint(const FString &filename) const
+{
+    using namespace CheckpointFormat;
+
+    if (mGenomes.Num() == 0)
+        return;
+
+    //The copy is made here, the checksum and the file write run in the thread pool
+    int32 numGenomes = mGenomes.Num();
+    int64 genomeSize = mChromosomeLenght * sizeof(double) + sizeof(double);
+    TArray<uint8> buffer;
+    buffer.Init(0, sizeof(Header) + numGenomes * genomeSize);
+
+    double *bits = (double *)&buffer[sizeof(Header)];
+    double *fitness = bits + numGenomes * mChromosomeLenght;
+    for (int32 i = 0; i < numGenomes; i++)
+    {
+        FMemory::Memcpy(&bits[i * mChromosomeLenght], mGenomes[i].Bits.GetData(), mChromosomeLenght * sizeof(double));
+        fitness[i] = mGenomes[i].Fitness;
+    }
+
+    Header header;
+    FMemory::Memzero(&header, sizeof(header));
+    FMemory::Memcpy(header.Magic, Magic, sizeof(Magic));
+    header.Version = Version;
+    header.DataType = Float64;
+    header.Generation = mGeneration;
+    header.NumGenomes = numGenomes;
+    header.ChromosomeLength = mChromosomeLenght;
+    header.Population = mPopulation;
+    header.ElitismSelection = (uint32)(mPopulation * mElitismSelection);
+    header.FittestGenome = mFittestGenome;
+    header.SelectionMethod = Roulette;
+    header.TournamentSize = TournamentSize;
+    header.CrossoverRate = mCrossoverRate;
+    header.MutationRate = mMutationRate;
+    header.MaxPerturbation = mMaxPerturbation;
+    header.BestFitnessScore = mBestFitnessScore;
+    header.TotalFitnessScore = mTotalFitnessScore;
+    FMemory::Memcpy(header.RandomState, mRandom.State, sizeof(header.RandomState));
+    header.FileSize = buffer.Num();
+    FMemory::Memcpy(buffer.GetData(), &header, sizeof(header));
+
+    Async<void>(EAsyncExecution::ThreadPool, [buffer, filename]() mutable
+    {
+        uint32 checksum = Crc32(&buffer[sizeof(Header)], buffer.Num() - sizeof(Header));
+        FMemory::Memcpy(&buffer[STRUCT_OFFSET(Header, Checksum)], &checksum, sizeof(checksum));
+        FFileHelper::SaveArrayToFile(buffer, *filename);
+    });
+}
+
+bool UGeneticAlgorithmComponent::LoadCheckpoint(const FString &filename)
+{
+    using namespace CheckpointFormat;
+
+    TArray<uint8> buffer;
+    if (!FFileHelper::LoadFileToArray(buffer, *filename) || buffer.Num() < (int32)sizeof(Header))
+        return false;
+
+    //Only double genes and roulette wheel selection, the run of a Base/GANN checkpoint with another selection
+    //would not continue the same way here
+    Header header;
+    FMemory::Memcpy(&header, buffer.GetData(), sizeof(header));
+    int64 genomeSize = header.ChromosomeLength * sizeof(double) + sizeof(double);
+    if (FMemory::Memcmp(header.Magic, Magic, sizeof(Magic)) != 0 || header.Version != Version ||
+        header.DataType != Float64 || header.SelectionMethod != Roulette || header.NumGenomes == 0 ||
+        header.FileSize != (uint64)buffer.Num() || sizeof(Header) + header.NumGenomes * genomeSize != header.FileSize ||
+        Crc32(&buffer[sizeof(Header)], buffer.Num() - sizeof(Header)) != header.Checksum)
+    {
+        return false;
+    }
+
+    const double *bits = (const double *)&buffer[sizeof(Header)];
+    const double *fitness = bits + header.NumGenomes * header.ChromosomeLength;
+
+    TArray<SGenome> genomes;
+    genomes.SetNum(header.NumGenomes);
+    for (uint32 i = 0; i < header.NumGenomes; i++)
+    {
+        SGenome &genome = genomes[i];
+        genome.Bits.SetNumUninitialized(header.ChromosomeLength);
+        FMemory::Memcpy(genome.Bits.GetData(), &bits[i * header.ChromosomeLength], header.ChromosomeLength * sizeof(double));
+        genome.Fitness = fitness[i];
+    }
+
+    mGenomes = MoveTemp(genomes);
+    mChromosomeLenght = header.ChromosomeLength;
+    mGeneration = header.Generation;
+    mPopulation = header.Population;
+    mElitismSelection = header.Population > 0 ? (float)header.ElitismSelection / header.Population : mElitismSelection;
+    mFittestGenome = header.FittestGenome;
+    mCrossoverRate = (float)header.CrossoverRate;
+    mMutationRate = (float)header.MutationRate;
+    mMaxPerturbation = (float)header.MaxPerturbation;
+    mBestFitnessScore = header.BestFitnessScore;
+    mTotalFitnessScore = header.TotalFitnessScore;
+    FMemory::Memcpy(mRandom.State, header.RandomState, sizeof(mRandom.State));
+    return true;
 }
 
 void UGeneticAlgorithmComponent::UpdateGenomeFitness(int32 id, float fitness)
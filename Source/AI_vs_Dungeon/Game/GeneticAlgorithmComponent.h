@@ -8,6 +8,7 @@
 
 #include "Components/ActorComponent.h"
 #include "Character/NNCharacter.h"
+#include "Character/XoshiroRandom.h"
 #include "GeneticAlgorithmComponent.generated.h"
 
 #pragma once
@@ -39,9 +40,19 @@ public:
 
     inline int32 GetMaxPopulationSize() { return mPopulation; }
     inline int32 GetPopulationSize() { return mGenomes.Num(); }
-    inline SGenome GetGenome(int32 index) { return mGenomes[index]; }
+    inline const SGenome &GetGenome(int32 index) const { return mGenomes[index]; }
+
+    //Same checkpoint file as Base/GANN Checkpoint.h (double genes and roulette wheel selection only).
+    //SaveCheckpoint copies the population and writes the file from the thread pool
+    void SaveCheckpoint(const FString &filename) const;
+    //Continues the run of the checkpoint: genomes, generation, parameters and random stream
+    bool LoadCheckpoint(const FString &filename);
 
 private:
+    inline float RandFloat() { return (float)mRandom.NextDouble(); }
+    inline float RandFloatClamped() { return RandFloat() * 2.0f - 1.0f; }
+    inline int32 RandInt(int32 min, int32 max) { return (int32)mRandom.NextUnsigned(max - min) + min; }
+
     SGenome& RouleteWheelSelection();
     void ElitismSelection(int32 amount, TArray <SGenome> &genomes);
 
@@ -50,6 +61,14 @@ private:
 
     //The population of genomes
     TArray<SGenome> mGenomes;
+    //The generation before the current one, Epoch overwrites it with the next generation and swaps both arrays:
+    //the genomes and their chromosome arrays are reused generation after generation
+    TArray<SGenome> mNextGenomes;
+    //Running sum of the fitness of the current generation, built once per Epoch: the roulette wheel
+    //selection finds each parent with a binary search instead of adding up the population again
+    TArray<double> mCumulativeFitness;
+    //Genome indices partially sorted by fitness for the elitism selection, reused every Epoch
+    TArray<int32> mEliteOrder;
 
     //Size of the population
     UPROPERTY(EditAnywhere, Category = "Configuration")
@@ -78,4 +97,25 @@ private:
     double mBestFitnessScore = 0.0;
     double mTotalFitnessScore = 0.0;
     int32 mGeneration = 0;
+
+    //Generations between checkpoints, 0 writes none
+    UPROPERTY(EditAnywhere, Category = "Checkpoint")
+    int32 mCheckpointInterval = 0;
+
+    //File in the Saved folder of the project
+    UPROPERTY(EditAnywhere, Category = "Checkpoint")
+    FString mCheckpointFile = TEXT("GeneticAlgorithm.ckpt");
+
+    //Initialize continues the run of the checkpoint file when there is one
+    UPROPERTY(EditAnywhere, Category = "Checkpoint")
+    bool mResumeFromCheckpoint = false;
+
+    //Seed of the run (the initial networks and the genetic operators), 0 picks a new one every run
+    UPROPERTY(EditAnywhere, Category = "Configuration")
+    int32 mSeed = 0;
+
+    //Random numbers of the genetic operators, its state is part of the checkpoints
+    FXoshiroRandom mRandom;
+    //Uniform numbers of the mutation chances of one chromosome
+    TArray<float> mMutationDraws;
 };
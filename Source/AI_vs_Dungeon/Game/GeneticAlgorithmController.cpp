@@ -62,7 +62,7 @@ void AGeneticAlgorithmController::SpawnEntity(bool CameraFocus)
 
             //Create a new entity with the a genome of the new generation
             GenomeID = mGenomeIndex;
-            SGenome genome = mGAComponent->GetGenome(mGenomeIndex);
+            const SGenome &genome = mGAComponent->GetGenome(mGenomeIndex);
 
             //Update the NN weights with the new ones obtained from crossover and mutation
             entity->NeuralNetworkSetConnectionWeights(genome.Bits);